@@ -0,0 +1,73 @@
+#include "./AdaptivePacer.h"
+
+#include <algorithm>
+
+#include "./Utils.h"
+
+namespace Robot {
+
+AdaptivePacer::AdaptivePacer(const PacingOptions& options) {
+  Reset(options);
+}
+
+void AdaptivePacer::Reset() {
+  Reset(options);
+}
+
+void AdaptivePacer::Reset(const PacingOptions& newOptions) {
+  options = newOptions;
+  options.minRate = std::max(1.0, options.minRate);
+  options.maxRate = std::max(options.minRate, options.maxRate);
+  options.decrease = std::clamp(options.decrease, 0.05, 1.0);
+  options.probeEvery = std::max(1, options.probeEvery);
+  rate = std::clamp(options.initialRate, options.minRate, options.maxRate);
+  baseline = 0.0;
+  lastRoundTrip = 0.0;
+  nextSlot = std::chrono::steady_clock::time_point();
+  sinceProbe = 0;
+  events = 0;
+  probes = 0;
+  backoffs = 0;
+}
+
+bool AdaptivePacer::Wait() {
+  const auto now = std::chrono::steady_clock::now();
+  if (nextSlot > now) {
+    delayUntil(nextSlot);
+  } else {
+    nextSlot = now;
+  }
+  nextSlot += std::chrono::nanoseconds(static_cast<int64_t>(1e9 / rate));
+  events++;
+  if (++sinceProbe >= options.probeEvery) {
+    sinceProbe = 0;
+    return true;
+  }
+  return false;
+}
+
+void AdaptivePacer::Record(std::chrono::nanoseconds roundTrip) {
+  const double seconds = std::chrono::duration<double>(roundTrip).count();
+  probes++;
+  lastRoundTrip = seconds;
+  // 与更新前的基线比较，避免持续拥塞时基线被拉高而掩盖拥塞
+  const bool congested = baseline > 0.0 && seconds > baseline * options.tolerance + options.slackMs / 1000.0;
+  if (baseline <= 0.0 || seconds < baseline) {
+    baseline = seconds;
+  } else {
+    baseline += (seconds - baseline) / 32;
+  }
+
+  if (congested) {
+    rate = std::max(options.minRate, rate * options.decrease);
+    backoffs++;
+  } else {
+    rate = std::min(options.maxRate, rate + options.increase);
+  }
+}
+
+PacingStats AdaptivePacer::GetStats() const {
+  return {rate, lastRoundTrip * 1000.0, baseline * 1000.0, events, probes, backoffs};
+}
+
+}  // namespace Robot
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+namespace Robot {
+
+struct PacingOptions {
+  double initialRate = 1000.0;  // 初始速率（事件/秒），与原先每个事件后固定等待1ms相当
+  double minRate = 50.0;
+  double maxRate = 1000.0;      // 默认不超过初始速率；往返延迟只反映X服务器的负载，不反映目标程序是否跟得上，
+                                // 确认目标能承受更高速率后再调高
+  double increase = 100.0;      // 未拥塞时每次测量后增加的速率（事件/秒）
+  double decrease = 0.5;        // 拥塞时速率乘以该系数
+  int probeEvery = 16;          // 每发送多少个事件测量一次往返延迟
+  double tolerance = 2.0;       // 往返延迟超过基线的tolerance倍加slackMs时视为拥塞
+  double slackMs = 0.5;
+};
+
+struct PacingStats {
+  double rate;                // 当前选定的速率（事件/秒）
+  double lastRoundTripMs;     // 最近一次测得的往返延迟
+  double baselineRoundTripMs; // 空闲时的往返延迟估计
+  uint64_t events;            // 已放行的事件数
+  uint64_t probes;            // 测量次数
+  uint64_t backoffs;          // 因拥塞降速的次数
+};
+
+// AIMD自适应限速
+// 事件发送得比目标程序（或X服务器）处理得快时，请求在服务器端排队，往返延迟随之上升，再快就会丢键。
+// 调用方定期测量一次往返延迟（如XSync）交给Record()：延迟接近空闲基线时速率线性增加，
+// 明显高于基线时速率成倍下降，从而在不手工调整延迟的情况下收敛到目标能可靠处理的最高速率。
+// 基线取观察到的最小往返延迟，并缓慢向新测量值靠拢以适应环境变化。
+// 实例本身不是线程安全的。
+class AdaptivePacer {
+ public:
+  explicit AdaptivePacer(const PacingOptions& options = PacingOptions());
+
+  // 在发送每个事件之前调用，等待到下一个发送时刻；返回true表示此时应测量一次往返延迟并调用Record()
+  // 空闲后不会积攒额度，不会因此突发发送
+  bool Wait();
+
+  void Record(std::chrono::nanoseconds roundTrip);
+
+  // 恢复初始速率并清空统计
+  void Reset();
+  void Reset(const PacingOptions& options);
+
+  PacingStats GetStats() const;
+
+ private:
+  PacingOptions options;
+  double rate;
+  double baseline = 0.0;       // 秒，0表示尚未测量
+  double lastRoundTrip = 0.0;  // 秒
+  std::chrono::steady_clock::time_point nextSlot;
+  int sinceProbe = 0;
+  uint64_t events = 0;
+  uint64_t probes = 0;
+  uint64_t backoffs = 0;
+};
+
+}  // namespace Robot
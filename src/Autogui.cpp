@@ -3,11 +3,17 @@
 //
 
 #include "Autogui.h"
+#include "DamageCapture.h"
+#include "FrameDiff.h"
+#include "Simd.h"
+#include "TemplateCache.h"
 #include <algorithm>
 #include <chrono>
+#include <climits>
 #include <cmath>
 #include <iomanip>
 #include <iostream>
+#include <memory>
 #include <random>
 #include <thread>
 #include <cstring>
@@ -27,48 +33,12 @@ void delayMs(const int ms) {
 // 将秒转换为毫秒
 int secondsToMs(double seconds) { return static_cast<int>(seconds * 1000); }
 
-// 获取当前鼠标位置（内部使用）
-Robot::Point getCurrentPosition() { return Robot::Mouse::GetPosition(); }
-
 } // namespace
 
 #if defined(__linux__)
-#include <X11/Xlib.h>
-#include <X11/extensions/Xrandr.h>
-#include <algorithm>
 
-// 获取所有屏幕信息
-std::vector<ScreenInfo> getAllScreens() {
-    std::vector<ScreenInfo> screens;
-    Display* display = XOpenDisplay(nullptr);
-    if (!display) return screens;
-
-    XRRScreenResources* resources = XRRGetScreenResources(display, DefaultRootWindow(display));
-    if (resources) {
-        for (int i = 0; i < resources->noutput; i++) {
-            XRROutputInfo* output = XRRGetOutputInfo(display, resources, resources->outputs[i]);
-            if (output && output->connection == RR_Connected && output->crtc) {
-                XRRCrtcInfo* crtc = XRRGetCrtcInfo(display, resources, output->crtc);
-                if (crtc) {
-                    ScreenInfo info;
-                    info.id = i;
-                    info.x = crtc->x;
-                    info.y = crtc->y;
-                    info.width = crtc->width;
-                    info.height = crtc->height;
-                    info.isPrimary = (output->name && strcmp(output->name, "primary") == 0);
-                    // 或者使用 XRRGetOutputPrimary 来判断
-                    screens.push_back(info);
-                    XRRFreeCrtcInfo(crtc);
-                }
-                XRRFreeOutputInfo(output);
-            }
-        }
-        XRRFreeScreenResources(resources);
-    }
-    XCloseDisplay(display);
-    return screens;
-}
+// 获取所有屏幕信息（默认会话缓存，屏幕配置变化时自动刷新）
+std::vector<ScreenInfo> getAllScreens() { return defaultSession().getAllScreens(); }
 
 // 获取当前鼠标所在的屏幕
 ScreenInfo getCurrentScreen() {
@@ -165,46 +135,15 @@ void moveToOnCurrentScreen(int x, int y, double duration) {
 #endif
 
 
-// 实现主要API函数
-void moveTo(int x, int y, double duration) {
-  Robot::Point target{x, y};
-
-  if (duration > 0.0) {
-    Robot::Mouse::MoveSmooth(target);
-  } else {
-    Robot::Mouse::Move(target);
-  }
-}
+// 实现主要API函数，均委托给默认会话
+void moveTo(int x, int y, double duration) { defaultSession().moveTo(x, y, duration); }
 
 void moveRel(int xOffset, int yOffset, double duration) {
-  Robot::Point current = getCurrentPosition();
-  Robot::Point target{current.x + xOffset, current.y + yOffset};
-
-  moveTo(target.x, target.y, duration);
+  defaultSession().moveRel(xOffset, yOffset, duration);
 }
 
 void click(int x, int y, Button button, int clicks, double interval) {
-  // 如果提供了坐标，先移动到该位置
-  if (x >= 0 && y >= 0) {
-    moveTo(x, y);
-    delayMs(10);
-  }
-
-  Robot::MouseButton robotButton = toRobotButton(button);
-
-  for (int i = 0; i < clicks; i++) {
-    if (clicks == 2 && i == 0) {
-      // 双击
-      Robot::Mouse::DoubleClick(robotButton);
-    } else {
-      Robot::Mouse::Click(robotButton);
-    }
-
-    // 如果不是最后一次点击，并且设置了间隔，则等待
-    if (i < clicks - 1 && interval > 0) {
-      sleep(interval);
-    }
-  }
+  defaultSession().click(x, y, button, clicks, interval);
 }
 
 void leftDouble(int x, int y) { click(x, y, Button::LEFT, 2); }
@@ -213,186 +152,86 @@ void rightSingle(int x, int y) { click(x, y, Button::RIGHT, 1); }
 
 void middleClick(int x, int y) { click(x, y, Button::MIDDLE, 1); }
 
-void mouseDown(Button button, int x, int y) {
-  // 如果提供了坐标，先移动到该位置
-  if (x >= 0 && y >= 0) {
-    moveTo(x, y);
-    delayMs(10);
-  }
-
-  Robot::Mouse::ToggleButton(true, toRobotButton(button));
-}
-
-void mouseUp(Button button, int x, int y) {
-  // 如果提供了坐标，先移动到该位置
-  if (x >= 0 && y >= 0) {
-    moveTo(x, y);
-    delayMs(10);
-  }
+void mouseDown(Button button, int x, int y) { defaultSession().mouseDown(button, x, y); }
 
-  Robot::Mouse::ToggleButton(false, toRobotButton(button));
-}
+void mouseUp(Button button, int x, int y) { defaultSession().mouseUp(button, x, y); }
 
 void drag(const int x1, const int y1, const int x2, const int y2,
           const double duration, const Button button) {
-  // 参数验证
-  if (!isValidCoord(x1, y1)) {
-    throw AutoGUIException("Invalid start coordinates: (" + std::to_string(x1) +
-                           ", " + std::to_string(y1) + ")");
-  }
-  if (!isValidCoord(x2, y2)) {
-    throw AutoGUIException("Invalid end coordinates: (" + std::to_string(x2) +
-                           ", " + std::to_string(y2) + ")");
-  }
-  if (duration < 0) {
-    throw AutoGUIException("Duration cannot be negative");
-  }
-  Robot::MouseButton robotButton = toRobotButton(button);
-  // 移动到起始位置
-  Robot::Point start{x1, y1};
-  Robot::Mouse::Move(start);
-  delayMs(10); // 短暂延迟确保移动完成
-  // 按下鼠标按钮
-  Robot::Mouse::ToggleButton(true, robotButton);
-  delayMs(10); // 短暂延迟确保按钮按下
-  // 拖动到目标位置
-  Robot::Point end{x2, y2};
-  if (duration > 0.0) {
-    // 使用平滑拖动
-    Robot::Mouse::DragSmooth(end);
-  } else {
-    // 立即拖动
-    Robot::Mouse::Drag(end);
-  }
-  // 释放鼠标按钮
-  Robot::Mouse::ToggleButton(false, robotButton);
+  defaultSession().drag(x1, y1, x2, y2, duration, button);
 }
 
 void dragTo(const int x, const int y, const double duration,
             const Button button) {
-  // 获取当前位置
-  Robot::Point current = getCurrentPosition();
-  // 如果当前位置就是目标位置，则只做点击操作
-  if (current.x == x && current.y == y) {
-    click(x, y, button);
-    return;
-  }
-  // 调用 drag 函数
-  drag(current.x, current.y, x, y, duration, button);
+  defaultSession().dragTo(x, y, duration, button);
 }
 
 void dragRel(const int xOffset, const int yOffset, const double duration,
              const Button button) {
-  // 获取当前位置
-  const Robot::Point current = getCurrentPosition();
-  // 计算目标位置
-  const int targetX = current.x + xOffset;
-  const int targetY = current.y + yOffset;
-  // 如果偏移量为0，则只做点击操作
-  if (xOffset == 0 && yOffset == 0) {
-    click(current.x, current.y, button);
-    return;
-  }
-  // 调用 drag 函数
-  drag(current.x, current.y, targetX, targetY, duration, button);
+  defaultSession().dragRel(xOffset, yOffset, duration, button);
 }
 
-Robot::Point position() { return getCurrentPosition(); }
+Robot::Point position() { return defaultSession().position(); }
 
 void scroll(int clicks, int x) {
   // 注意：正数向上滚动，负数向下滚动
   // 与AutoGUI一致
-  Robot::Mouse::ScrollBy(clicks, x);
+  defaultSession().scroll(clicks, x);
 }
 
-void type(const std::string &text, double interval) {
-  if (interval > 0.0) {
-    // 有间隔的输入
-    for (char c : text) {
-      Robot::Keyboard::Click(c);
-      if (interval > 0) {
-        sleep(interval);
-      }
-    }
-  } else {
-    // 无间隔快速输入
-    Robot::Keyboard::Type(text);
-  }
-}
+void type(const std::string &text, double interval) { defaultSession().type(text, interval); }
 
-void press(const std::string &key) {
-  std::string lowerKey = toLower(key);
+void press(const std::string &key) { defaultSession().press(key); }
 
-  if (lowerKey.length() == 1) {
-    // 单个字符键
-    Robot::Keyboard::Click(lowerKey[0]);
-  } else if (isSpecialKey(lowerKey)) {
-    // 特殊键
-    Robot::Keyboard::SpecialKey specialKey = stringToSpecialKey(lowerKey);
-    Robot::Keyboard::Click(specialKey);
-  } else {
-    throw AutoGUIException("Unknown key: " + key);
-  }
-}
+void keyDown(const std::string &key) { defaultSession().keyDown(key); }
 
-void keyDown(const std::string &key) {
-  std::string lowerKey = toLower(key);
+void keyUp(const std::string &key) { defaultSession().keyUp(key); }
 
-  if (lowerKey.length() == 1) {
-    // 单个字符键
-    Robot::Keyboard::Press(lowerKey[0]);
-  } else if (isSpecialKey(lowerKey)) {
-    // 特殊键
-    Robot::Keyboard::SpecialKey specialKey = stringToSpecialKey(lowerKey);
-    Robot::Keyboard::Press(specialKey);
-  } else {
-    throw AutoGUIException("Unknown key: " + key);
-  }
+void hotkey(const std::initializer_list<std::string> &keys) {
+  defaultSession().hotkey(std::vector<std::string>(keys));
 }
 
-void keyUp(const std::string &key) {
-  std::string lowerKey = toLower(key);
+void hotkey(const std::vector<std::string> &keys) { defaultSession().hotkey(keys); }
 
-  if (lowerKey.length() == 1) {
-    // 单个字符键
-    Robot::Keyboard::Release(lowerKey[0]);
-  } else if (isSpecialKey(lowerKey)) {
-    // 特殊键
-    Robot::Keyboard::SpecialKey specialKey = stringToSpecialKey(lowerKey);
-    Robot::Keyboard::Release(specialKey);
-  } else {
-    throw AutoGUIException("Unknown key: " + key);
+// 默认会话构造失败（无法连接显示器）时返回NO_DISPLAY，下次调用会重试
+namespace {
+Session *tryDefaultSession() noexcept {
+  try {
+    return &defaultSession();
+  } catch (...) {
+    return nullptr;
   }
 }
+} // namespace
 
-void hotkey(const std::initializer_list<std::string> &keys) {
-  // 按下所有键
-  for (const auto &key : keys) {
-    keyDown(key);
-  }
+InputStatus tryDrag(int x1, int y1, int x2, int y2, double duration, Button button) noexcept {
+  Session *session = tryDefaultSession();
+  return session != nullptr ? session->tryDrag(x1, y1, x2, y2, duration, button) : InputStatus::NO_DISPLAY;
+}
 
-  delayMs(50);
+InputStatus tryMoveTo(int x, int y, double duration) noexcept {
+  Session *session = tryDefaultSession();
+  return session != nullptr ? session->tryMoveTo(x, y, duration) : InputStatus::NO_DISPLAY;
+}
 
-  // 释放所有键（按相反顺序）
-  const std::string *end = keys.end();
-  const std::string *begin = keys.begin();
-  for (const std::string *it = end - 1; it >= begin; --it) {
-    keyUp(*it);
-  }
+InputStatus tryClick(int x, int y, Button button, int clicks, double interval) noexcept {
+  Session *session = tryDefaultSession();
+  return session != nullptr ? session->tryClick(x, y, button, clicks, interval) : InputStatus::NO_DISPLAY;
 }
 
-void hotkey(const std::vector<std::string> &keys) {
-  // 按下所有键
-  for (const auto &key : keys) {
-    keyDown(key);
-  }
+InputStatus tryPress(const std::string &key) noexcept {
+  Session *session = tryDefaultSession();
+  return session != nullptr ? session->tryPress(key) : InputStatus::NO_DISPLAY;
+}
 
-  delayMs(50);
+InputStatus tryKeyDown(const std::string &key) noexcept {
+  Session *session = tryDefaultSession();
+  return session != nullptr ? session->tryKeyDown(key) : InputStatus::NO_DISPLAY;
+}
 
-  // 释放所有键（按相反顺序）
-  for (auto it = keys.rbegin(); it != keys.rend(); ++it) {
-    keyUp(*it);
-  }
+InputStatus tryKeyUp(const std::string &key) noexcept {
+  Session *session = tryDefaultSession();
+  return session != nullptr ? session->tryKeyUp(key) : InputStatus::NO_DISPLAY;
 }
 
 void sleep(double seconds) {
@@ -407,9 +246,6 @@ void sleep(double seconds) {
 #elif defined(__APPLE__)
 #include <CoreGraphics/CoreGraphics.h>
 
-#elif defined(__linux__)
-#include <X11/Xlib.h>
-#include <X11/extensions/Xrandr.h>
 #endif
 
 // 平台特定函数实现
@@ -429,70 +265,746 @@ Robot::Point size() {
   return {width, height};
 
 #elif defined(__linux__)
-  Display *display = XOpenDisplay(nullptr);
-  if (!display) return {1920, 1080};
+  return defaultSession().size();
+
+#else
+  // 其他平台
+  return {1920, 1080}; // 默认值
+#endif
+}
 
-  int width = 0, height = 0;
+// 截图实现
+Robot::ScreenCapture &screenCapture() {
+  static Robot::ScreenCapture capture;
+  return capture;
+}
 
-  // 使用 XRRGetScreenResources (兼容 XRandR 1.2+，比 Current 版本兼容性更好)
-  XRRScreenResources *resources = XRRGetScreenResources(display, DefaultRootWindow(display));
-  if (resources) {
-    RROutput target_output = None;
+Robot::ImageView screenshot(int x, int y, int width, int height) {
+  Robot::ScreenCapture &capture = screenCapture();
+  const Robot::Rect bounds = capture.RootBounds();
+  if (width < 0) {
+    width = bounds.width - x;
+  }
+  if (height < 0) {
+    height = bounds.height - y;
+  }
+  return capture.Capture({x, y, width, height});
+}
 
-    // 条件编译：只在 XRandR 1.3+ 时使用 Primary Output 功能
-#if defined(RANDR_MAJOR) && defined(RANDR_MINOR)
-#if RANDR_MAJOR > 1 || (RANDR_MAJOR == 1 && RANDR_MINOR >= 3)
-    target_output = XRRGetOutputPrimary(display, DefaultRootWindow(display));
-#endif
-#endif
+Robot::ImageView screenshotScreen(int screenId) {
+  ScreenInfo target{};
+  if (screenId == -1) {
+    target = getCurrentScreen();
+  } else {
+    auto screens = getAllScreens();
+    auto it = std::find_if(screens.begin(), screens.end(),
+                           [screenId](const ScreenInfo &s) { return s.id == screenId; });
+    if (it == screens.end()) {
+      throw AutoGUIException("Unknown screen id: " + std::to_string(screenId));
+    }
+    target = *it;
+  }
+  return screenCapture().Capture({target.x, target.y, target.width, target.height});
+}
 
-    // 如果没有获取到主显示器（或版本太低），使用第一个已连接的显示器
-    if (target_output == None) {
-      for (int i = 0; i < resources->noutput; i++) {
-        XRROutputInfo *info = XRRGetOutputInfo(display, resources, resources->outputs[i]);
-        if (info) {
-          if (info->connection == 0) {
-            target_output = resources->outputs[i];
-            XRRFreeOutputInfo(info);
-            break;
-          }
-          XRRFreeOutputInfo(info);
-        }
+// 像素查询实现
+namespace {
+
+struct PixelCache {
+  Robot::ImageView view;
+  Robot::Rect region{0, 0, 0, 0};
+  uint64_t generation = 0;
+  std::chrono::steady_clock::time_point capturedAt;
+  std::chrono::duration<double> maxAge{0.0};
+  bool valid = false;
+};
+
+PixelCache &pixelCache() {
+  static PixelCache cache;
+  return cache;
+}
+
+// 缓存是否仍可用：未过期、未被其他截图覆盖、且覆盖了所需区域
+bool pixelCacheCovers(const Robot::Rect &needed) {
+  const PixelCache &cache = pixelCache();
+  if (!cache.valid || cache.maxAge.count() <= 0.0 ||
+      cache.generation != screenCapture().Generation() ||
+      std::chrono::steady_clock::now() - cache.capturedAt > cache.maxAge) {
+    return false;
+  }
+  return needed.x >= cache.region.x && needed.y >= cache.region.y &&
+         needed.x + needed.width <= cache.region.x + cache.region.width &&
+         needed.y + needed.height <= cache.region.y + cache.region.height;
+}
+
+// 刷新缓存：启用缓存时截取整个屏幕供后续查询复用，否则只截取所需区域
+void refreshPixelCache(const Robot::Rect &needed) {
+  PixelCache &cache = pixelCache();
+  Robot::ScreenCapture &capture = screenCapture();
+  cache.region = cache.maxAge.count() > 0.0 ? capture.RootBounds() : needed;
+  cache.view = capture.Capture(cache.region);
+  cache.generation = capture.Generation();
+  cache.capturedAt = std::chrono::steady_clock::now();
+  cache.valid = !cache.view.Empty();
+}
+
+} // namespace
+
+void setPixelCacheMaxAge(double seconds) {
+  pixelCache().maxAge = std::chrono::duration<double>(seconds > 0.0 ? seconds : 0.0);
+}
+
+void invalidatePixelCache() {
+  pixelCache().valid = false;
+}
+
+void pixels(const Robot::Point *points, size_t count, Robot::Color *out) {
+  if (count == 0) {
+    return;
+  }
+
+  // 所有坐标的外接矩形
+  int x1 = points[0].x, y1 = points[0].y, x2 = points[0].x, y2 = points[0].y;
+  for (size_t i = 1; i < count; i++) {
+    x1 = std::min(x1, points[i].x);
+    y1 = std::min(y1, points[i].y);
+    x2 = std::max(x2, points[i].x);
+    y2 = std::max(y2, points[i].y);
+  }
+  const Robot::Rect bounds = screenCapture().RootBounds();
+  if (x1 < 0 || y1 < 0 || x2 >= bounds.width || y2 >= bounds.height) {
+    throw AutoGUIException("Pixel coordinates out of screen");
+  }
+  const Robot::Rect needed{x1, y1, x2 - x1 + 1, y2 - y1 + 1};
+
+  if (!pixelCacheCovers(needed)) {
+    refreshPixelCache(needed);
+  }
+  const PixelCache &cache = pixelCache();
+  if (!cache.valid) {
+    throw AutoGUIException("Failed to capture screen");
+  }
+  for (size_t i = 0; i < count; i++) {
+    out[i] = cache.view.ColorAt(points[i].x - cache.region.x, points[i].y - cache.region.y);
+  }
+}
+
+std::vector<Robot::Color> pixels(const std::vector<Robot::Point> &points) {
+  std::vector<Robot::Color> result(points.size());
+  pixels(points.data(), points.size(), result.data());
+  return result;
+}
+
+Robot::Color pixel(int x, int y) {
+  const Robot::Point point{x, y};
+  Robot::Color color{};
+  pixels(&point, 1, &color);
+  return color;
+}
+
+bool pixelMatchesColor(int x, int y, Robot::Color expected, int tolerance) {
+  const Robot::Color actual = pixel(x, y);
+  return std::abs(actual.r - expected.r) <= tolerance &&
+         std::abs(actual.g - expected.g) <= tolerance &&
+         std::abs(actual.b - expected.b) <= tolerance;
+}
+
+// 图像定位实现
+namespace {
+
+struct LocateSettings {
+  std::vector<double> scales{1.0};
+};
+
+LocateSettings &locateSettings() {
+  static LocateSettings settings;
+  return settings;
+}
+
+// 图像定位与等待函数优先使用XDamage增量帧：画面未变化时帧号不变，匹配器可直接复用上次的灰度与积分图金字塔
+// 服务器不支持XDamage时返回nullptr，退回到每次截图
+Robot::DamageCapture *sharedDamageCapture() {
+  static std::unique_ptr<Robot::DamageCapture> capture = []() -> std::unique_ptr<Robot::DamageCapture> {
+    try {
+      return std::make_unique<Robot::DamageCapture>();
+    } catch (const std::runtime_error &) {
+      return nullptr;
+    }
+  }();
+  return capture.get();
+}
+
+struct LocateFrame {
+  Robot::ImageView view;
+  Robot::Point origin;   // view左上角的屏幕坐标
+  uint64_t frameId = 0;  // 0表示无法判断画面是否变化
+};
+
+// refresh为false时直接使用持久帧的当前内容（调用方刚刚Update过）
+LocateFrame captureForLocate(Robot::Rect region, bool refresh = true) {
+  LocateFrame frame;
+  if (Robot::DamageCapture *damage = sharedDamageCapture()) {
+    if (refresh) {
+      damage->Update();
+    }
+    const Robot::ImageView full = damage->Frame();
+    if (region.width <= 0 || region.height <= 0) {
+      region = {0, 0, full.width, full.height};
+    }
+    const int x1 = std::max(region.x, 0);
+    const int y1 = std::max(region.y, 0);
+    const int x2 = std::min(region.x + region.width, full.width);
+    const int y2 = std::min(region.y + region.height, full.height);
+    if (x2 <= x1 || y2 <= y1) {
+      return frame;
+    }
+    // 持久帧上的子视图，不产生拷贝
+    frame.view = full;
+    frame.view.data = full.Pixel(x1, y1);
+    frame.view.width = x2 - x1;
+    frame.view.height = y2 - y1;
+    frame.origin = {x1, y1};
+    frame.frameId = damage->FrameNumber();
+    return frame;
+  }
+
+  Robot::ScreenCapture &capture = screenCapture();
+  if (region.width <= 0 || region.height <= 0) {
+    region = capture.RootBounds();
+  }
+  frame.view = capture.Capture(region);
+  // Capture会把区域裁剪到屏幕内，视图左上角对应裁剪后的坐标
+  frame.origin = {std::max(region.x, 0), std::max(region.y, 0)};
+  return frame;
+}
+
+} // namespace
+
+Robot::TemplateMatcher &templateMatcher() {
+  static Robot::TemplateMatcher matcher;
+  return matcher;
+}
+
+Robot::TemplateCache &templateCache() {
+  static Robot::TemplateCache cache;
+  return cache;
+}
+
+void setLocateScales(const std::vector<double> &scales) {
+  if (scales.empty() || std::any_of(scales.begin(), scales.end(), [](double s) { return s <= 0.0; })) {
+    throw AutoGUIException("Locate scales must be non-empty and positive");
+  }
+  locateSettings().scales = scales;
+}
+
+void preload(const std::vector<std::string> &imagePaths) {
+  try {
+    templateCache().Preload(imagePaths, locateSettings().scales);
+    // locateAllOnScreen只使用原始比例
+    if (locateSettings().scales != std::vector<double>{1.0}) {
+      templateCache().Preload(imagePaths);
+    }
+  } catch (const std::runtime_error &e) {
+    throw AutoGUIException(e.what());
+  }
+}
+
+namespace {
+
+std::shared_ptr<const Robot::TemplatePyramid> cachedNeedle(const Robot::Image &needle,
+                                                           const std::vector<double> &scales) {
+  if (needle.Empty()) {
+    throw AutoGUIException("Needle image is empty");
+  }
+  return templateCache().Get(needle, scales);
+}
+
+std::shared_ptr<const Robot::TemplatePyramid> cachedNeedle(const std::string &imagePath,
+                                                           const std::vector<double> &scales) {
+  try {
+    return templateCache().Get(imagePath, scales);
+  } catch (const std::runtime_error &e) {
+    throw AutoGUIException(e.what());
+  }
+}
+
+std::optional<Robot::Rect> locateTemplate(const Robot::TemplatePyramid &templ, double confidence,
+                                          Robot::Rect region, bool refresh = true) {
+  const LocateFrame frame = captureForLocate(region, refresh);
+  if (frame.view.Empty()) {
+    return std::nullopt;
+  }
+
+  Robot::TemplateMatcher &matcher = templateMatcher();
+  Robot::SearchPyramid &haystack = matcher.PreparePyramid(frame.view, frame.frameId);
+  auto match = matcher.FindBest(haystack, templ, {Robot::MatchMethod::NCC, confidence});
+  if (!match) {
+    return std::nullopt;
+  }
+  Robot::Rect rect = match->rect;
+  rect.x += frame.origin.x;
+  rect.y += frame.origin.y;
+  return rect;
+}
+
+std::vector<Robot::Rect> locateAllTemplate(const Robot::TemplatePyramid &pyramid, double confidence,
+                                           Robot::Rect region,
+                                           const std::function<void(const Robot::Rect &)> &onMatch) {
+  std::vector<Robot::Rect> rects;
+  const LocateFrame frame = captureForLocate(region);
+  if (frame.view.Empty() || pyramid.Empty()) {
+    return rects;
+  }
+
+  Robot::TemplateMatcher &matcher = templateMatcher();
+  const Robot::SearchImage &haystack = matcher.PreparePyramid(frame.view, frame.frameId).Level(0);
+  const Robot::Template &templ = pyramid.Scales().front().levels.front();
+  auto toScreen = [&frame](const Robot::Rect &rect) {
+    return Robot::Rect{rect.x + frame.origin.x, rect.y + frame.origin.y, rect.width, rect.height};
+  };
+
+  Robot::MatchCallback streamed;
+  if (onMatch) {
+    streamed = [&](const Robot::MatchResult &match) { onMatch(toScreen(match.rect)); };
+  }
+  const auto matches = matcher.FindAll(haystack, templ, {Robot::MatchMethod::NCC, confidence}, streamed);
+  rects.reserve(matches.size());
+  for (const auto &match : matches) {
+    rects.push_back(toScreen(match.rect));
+  }
+  return rects;
+}
+
+} // namespace
+
+std::optional<Robot::Rect> locateOnScreen(const Robot::Image &needle, double confidence, Robot::Rect region) {
+  return locateTemplate(*cachedNeedle(needle, locateSettings().scales), confidence, region);
+}
+
+std::optional<Robot::Rect> locateOnScreen(const std::string &imagePath, double confidence, Robot::Rect region) {
+  return locateTemplate(*cachedNeedle(imagePath, locateSettings().scales), confidence, region);
+}
+
+std::vector<Robot::Rect> locateAllOnScreen(const Robot::Image &needle, double confidence, Robot::Rect region,
+                                           const std::function<void(const Robot::Rect &)> &onMatch) {
+  return locateAllTemplate(*cachedNeedle(needle, {1.0}), confidence, region, onMatch);
+}
+
+std::vector<Robot::Rect> locateAllOnScreen(const std::string &imagePath, double confidence, Robot::Rect region,
+                                           const std::function<void(const Robot::Rect &)> &onMatch) {
+  return locateAllTemplate(*cachedNeedle(imagePath, {1.0}), confidence, region, onMatch);
+}
+
+std::vector<std::optional<Robot::Rect>> locateManyOnScreen(const std::vector<Robot::Image> &needles,
+                                                           double confidence, Robot::Rect region) {
+  std::vector<std::optional<Robot::Rect>> rects(needles.size());
+  if (needles.empty()) {
+    return rects;
+  }
+
+  // 持有shared_ptr，搜索期间即使缓存淘汰了这些条目也不受影响
+  std::vector<std::shared_ptr<const Robot::TemplatePyramid>> templates;
+  std::vector<const Robot::TemplatePyramid *> pointers;
+  templates.reserve(needles.size());
+  pointers.reserve(needles.size());
+  for (const auto &needle : needles) {
+    templates.push_back(cachedNeedle(needle, locateSettings().scales));
+    pointers.push_back(templates.back().get());
+  }
+
+  const LocateFrame frame = captureForLocate(region);
+  if (frame.view.Empty()) {
+    return rects;
+  }
+  Robot::TemplateMatcher &matcher = templateMatcher();
+  Robot::SearchPyramid &haystack = matcher.PreparePyramid(frame.view, frame.frameId);
+  const auto matches = matcher.FindBestMany(haystack, pointers, {Robot::MatchMethod::NCC, confidence});
+  for (size_t i = 0; i < matches.size(); i++) {
+    if (matches[i]) {
+      Robot::Rect rect = matches[i]->rect;
+      rect.x += frame.origin.x;
+      rect.y += frame.origin.y;
+      rects[i] = rect;
+    }
+  }
+  return rects;
+}
+
+std::optional<Robot::Point> locateCenterOnScreen(const Robot::Image &needle, double confidence,
+                                                 Robot::Rect region) {
+  auto rect = locateOnScreen(needle, confidence, region);
+  if (!rect) {
+    return std::nullopt;
+  }
+  return Robot::Point{rect->x + rect->width / 2, rect->y + rect->height / 2};
+}
+
+// 事件驱动等待实现
+namespace {
+
+using WaitClock = std::chrono::steady_clock;
+
+// 没有XDamage时的轮询间隔
+constexpr auto kWaitPollInterval = std::chrono::milliseconds(50);
+
+WaitClock::time_point waitDeadline(double timeoutSeconds) {
+  return WaitClock::now() + std::chrono::duration_cast<WaitClock::duration>(
+                                std::chrono::duration<double>(timeoutSeconds > 0.0 ? timeoutSeconds : 0.0));
+}
+
+// 宽或高为0表示整个虚拟桌面，结果裁剪到桌面范围内
+Robot::Rect resolveRegion(Robot::Rect region) {
+  const Robot::Rect bounds = screenCapture().RootBounds();
+  if (region.width <= 0 || region.height <= 0) {
+    return bounds;
+  }
+  return region.Intersect(bounds);
+}
+
+// 阻塞到有与roi相交的损坏区域（持久帧已刷新），返回相交部分的外接矩形；超时返回std::nullopt
+// 没有XDamage时休眠一个轮询间隔后返回整个roi
+std::optional<Robot::Rect> waitForDirty(const Robot::Rect &roi, WaitClock::time_point deadline) {
+  Robot::DamageCapture *damage = sharedDamageCapture();
+  while (true) {
+    const auto now = WaitClock::now();
+    if (now >= deadline) {
+      return std::nullopt;
+    }
+    const auto remaining = std::chrono::ceil<std::chrono::milliseconds>(deadline - now);
+    if (damage == nullptr) {
+      std::this_thread::sleep_for(std::min(remaining, kWaitPollInterval));
+      return roi;
+    }
+    if (!damage->WaitForDamage(remaining)) {
+      return std::nullopt;
+    }
+    damage->Update();
+
+    int x1 = INT_MAX, y1 = INT_MAX, x2 = INT_MIN, y2 = INT_MIN;
+    for (const Robot::Rect &rect : damage->DirtyRects()) {
+      const Robot::Rect overlap = rect.Intersect(roi);
+      if (overlap.Empty()) {
+        continue;
       }
+      x1 = std::min(x1, overlap.x);
+      y1 = std::min(y1, overlap.y);
+      x2 = std::max(x2, overlap.x + overlap.width);
+      y2 = std::max(y2, overlap.y + overlap.height);
+    }
+    if (x2 > x1 && y2 > y1) {
+      return Robot::Rect{x1, y1, x2 - x1, y2 - y1};
+    }
+  }
+}
+
+std::optional<Robot::Rect> waitForTemplate(const Robot::TemplatePyramid &templ, double timeoutSeconds,
+                                           double confidence, Robot::Rect region) {
+  const auto deadline = waitDeadline(timeoutSeconds);
+  const Robot::Rect roi = resolveRegion(region);
+  if (roi.Empty()) {
+    throw AutoGUIException("Wait region is outside the screen");
+  }
+  if (auto found = locateTemplate(templ, confidence, roi)) {
+    return found;
+  }
+
+  // 所有缩放比例中最大的模板尺寸
+  int maxWidth = 0;
+  int maxHeight = 0;
+  for (const auto &entry : templ.Scales()) {
+    maxWidth = std::max(maxWidth, entry.levels.front().Width());
+    maxHeight = std::max(maxHeight, entry.levels.front().Height());
+  }
+
+  while (auto dirty = waitForDirty(roi, deadline)) {
+    // 上一次检查没有匹配，新出现的匹配必然与变化区域重叠：只搜索变化区域向外扩展一个模板尺寸的范围
+    const Robot::Rect search = Robot::Rect{dirty->x - (maxWidth - 1), dirty->y - (maxHeight - 1),
+                                           dirty->width + 2 * (maxWidth - 1),
+                                           dirty->height + 2 * (maxHeight - 1)}
+                                   .Intersect(roi);
+    if (auto found = locateTemplate(templ, confidence, search, false)) {
+      return found;
+    }
+  }
+  return std::nullopt;
+}
+
+} // namespace
+
+std::optional<Robot::Rect> waitForImage(const Robot::Image &needle, double timeoutSeconds, double confidence,
+                                        Robot::Rect region) {
+  return waitForTemplate(*cachedNeedle(needle, locateSettings().scales), timeoutSeconds, confidence, region);
+}
+
+std::optional<Robot::Rect> waitForImage(const std::string &imagePath, double timeoutSeconds, double confidence,
+                                        Robot::Rect region) {
+  return waitForTemplate(*cachedNeedle(imagePath, locateSettings().scales), timeoutSeconds, confidence, region);
+}
+
+bool waitForPixel(int x, int y, Robot::Color expected, double timeoutSeconds, int tolerance) {
+  const auto deadline = waitDeadline(timeoutSeconds);
+  const Robot::Rect roi{x, y, 1, 1};
+  if (!screenCapture().RootBounds().Contains({x, y})) {
+    throw AutoGUIException("Pixel coordinates out of screen");
+  }
+
+  auto matches = [&](bool refresh) {
+    const LocateFrame frame = captureForLocate(roi, refresh);
+    if (frame.view.Empty()) {
+      throw AutoGUIException("Failed to capture screen");
     }
+    const Robot::Color actual = frame.view.ColorAt(0, 0);
+    return std::abs(actual.r - expected.r) <= tolerance && std::abs(actual.g - expected.g) <= tolerance &&
+           std::abs(actual.b - expected.b) <= tolerance;
+  };
 
-    // 获取选中显示器的分辨率
-    if (target_output != None) {
-      XRROutputInfo *output_info = XRRGetOutputInfo(display, resources, target_output);
-      if (output_info && output_info->crtc) {
-        XRRCrtcInfo *crtc_info = XRRGetCrtcInfo(display, resources, output_info->crtc);
-        if (crtc_info) {
-          width = static_cast<int>(crtc_info->width);
-          height = static_cast<int>(crtc_info->height);
-          XRRFreeCrtcInfo(crtc_info);
+  if (matches(true)) {
+    return true;
+  }
+  while (waitForDirty(roi, deadline)) {
+    if (matches(false)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool waitForRegionChange(Robot::Rect region, double timeoutSeconds) {
+  const auto deadline = waitDeadline(timeoutSeconds);
+  const Robot::Rect roi = resolveRegion(region);
+  if (roi.Empty()) {
+    throw AutoGUIException("Wait region is outside the screen");
+  }
+
+  const LocateFrame initial = captureForLocate(roi);
+  if (initial.view.Empty()) {
+    throw AutoGUIException("Failed to capture screen");
+  }
+  const Robot::Image snapshot = Robot::Image::FromView(initial.view);
+  const Robot::ImageView before = snapshot.View();
+
+  while (auto dirty = waitForDirty(roi, deadline)) {
+    // 损坏通知不代表像素真的变化（例如重绘相同内容），只比较变化区域内的像素
+    const LocateFrame frame = captureForLocate(*dirty, false);
+    if (frame.view.Empty()) {
+      continue;
+    }
+    // A通道未定义（SHM与XGetImage两条截图路径填充不同），只比较B/G/R，找到第一个变化像素即返回
+    const int offsetX = frame.origin.x - roi.x;
+    const int offsetY = frame.origin.y - roi.y;
+    for (int row = 0; row < frame.view.height; row++) {
+      const uint8_t *after = frame.view.Row(row);
+      const uint8_t *previous = before.Pixel(offsetX, offsetY + row);
+      for (int x = 0; x < frame.view.width; x += 32) {
+        const int pixels = std::min(32, frame.view.width - x);
+        if (Robot::Simd::ChangedMask(previous + x * 4, after + x * 4, pixels, 0) != 0) {
+          return true;
         }
-        XRRFreeOutputInfo(output_info);
       }
     }
-    XRRFreeScreenResources(resources);
   }
+  return false;
+}
 
-  XCloseDisplay(display);
-  return (width > 0 && height > 0) ? Robot::Point{width, height} : Robot::Point{1920, 1080};
+bool waitUntilStable(Robot::Rect region, double quietSeconds, double timeoutSeconds, int tolerance) {
+  const auto deadline = waitDeadline(timeoutSeconds);
+  const auto quietPeriod =
+      std::chrono::duration_cast<WaitClock::duration>(std::chrono::duration<double>(std::max(quietSeconds, 0.0)));
+  const Robot::Rect roi = resolveRegion(region);
+  if (roi.Empty()) {
+    throw AutoGUIException("Wait region is outside the screen");
+  }
 
-#else
-  // 其他平台
-  return {1920, 1080}; // 默认值
-#endif
+  const LocateFrame initial = captureForLocate(roi);
+  if (initial.view.Empty()) {
+    throw AutoGUIException("Failed to capture screen");
+  }
+  Robot::Image snapshot = Robot::Image::FromView(initial.view);
+  // 每次调用各用一个实例，并发的调用不共享单元格缓冲区
+  Robot::FrameDiff frameDiff;
+  const uint8_t channelTolerance = static_cast<uint8_t>(std::clamp(tolerance, 0, 255));
+
+  auto lastChange = WaitClock::now();
+  while (true) {
+    const auto quietUntil = lastChange + quietPeriod;
+    const auto dirty = waitForDirty(roi, std::min(quietUntil, deadline));
+    if (!dirty) {
+      // 等待到期：安静期先到则画面已稳定，否则是总超时
+      return quietUntil <= deadline;
+    }
+
+    // 只比较变化区域；确有像素变化时更新快照并重新计时
+    const LocateFrame frame = captureForLocate(*dirty, false);
+    if (frame.view.Empty()) {
+      continue;
+    }
+    const int offsetX = frame.origin.x - roi.x;
+    const int offsetY = frame.origin.y - roi.y;
+    Robot::ImageView before = snapshot.View();
+    before.data = before.Pixel(offsetX, offsetY);
+    before.width = frame.view.width;
+    before.height = frame.view.height;
+    if (!frameDiff.Compare(before, frame.view, channelTolerance).Changed()) {
+      continue;
+    }
+    lastChange = WaitClock::now();
+    const size_t rowBytes = static_cast<size_t>(frame.view.width) * 4;
+    for (int row = 0; row < frame.view.height; row++) {
+      memcpy(snapshot.MutableRow(offsetY + row) + static_cast<size_t>(offsetX) * 4, frame.view.Row(row), rowBytes);
+    }
+  }
 }
 
-// 辅助函数实现
+// 窗口函数实现
+
+Robot::WindowRegistry &windowRegistry() {
+  static Robot::WindowRegistry registry;
+  return registry;
+}
+
+std::vector<Robot::WindowInfo> getAllWindows() {
+  return windowRegistry().Windows();
+}
+
+std::vector<Robot::WindowInfo> getWindowsWithTitle(const std::string &title) {
+  return windowRegistry().FindByTitle(title);
+}
+
+std::optional<Robot::WindowInfo> getActiveWindow() {
+  return windowRegistry().Active();
+}
+
+std::optional<Robot::WindowInfo> getWindowAt(int x, int y) {
+  return windowRegistry().At(x, y);
+}
+
+namespace {
+
+Robot::WindowInfo currentWindowInfo(unsigned long id) {
+  std::optional<Robot::WindowInfo> info = windowRegistry().Get(id);
+  if (!info) {
+    throw AutoGUIException("Window no longer exists");
+  }
+  return *info;
+}
+
+} // namespace
 
-bool isValidCoord(int x, int y) {
-  const Robot::Point screenSize = size();
-  return x >= 0 && x < screenSize.x && y >= 0 && y < screenSize.y;
+Robot::Point windowToScreen(const Robot::WindowInfo &window, int x, int y) {
+  const Robot::Rect geometry = currentWindowInfo(window.id).geometry;
+  return {geometry.x + x, geometry.y + y};
 }
 
+void moveTo(const Robot::WindowInfo &window, int x, int y, double duration) {
+  const Robot::Point target = windowToScreen(window, x, y);
+  moveTo(target.x, target.y, duration);
+}
+
+void click(const Robot::WindowInfo &window, int x, int y, Button button, int clicks, double interval) {
+  const Robot::Point target = windowToScreen(window, x, y);
+  moveTo(target.x, target.y);
+  delayMs(10);
+  click(-1, -1, button, clicks, interval);
+}
+
+WindowBatch::WindowBatch(const Robot::WindowInfo &window, bool throwOnMove)
+    : initial(currentWindowInfo(window.id)), current(initial), throwOnMove(throwOnMove) {}
+
+bool WindowBatch::moved() {
+  std::optional<Robot::WindowInfo> latest = windowRegistry().Get(initial.id);
+  return !latest || latest->geometryVersion != initial.geometryVersion;
+}
+
+Robot::Point WindowBatch::toScreen(int x, int y) {
+  Robot::WindowInfo latest = currentWindowInfo(current.id);
+  if (latest.geometryVersion != current.geometryVersion) {
+    if (throwOnMove) {
+      throw AutoGUIException("Window moved during batch: " + latest.title);
+    }
+    current = std::move(latest);
+  }
+  return {current.geometry.x + x, current.geometry.y + y};
+}
+
+void WindowBatch::moveTo(int x, int y, double duration) {
+  const Robot::Point target = toScreen(x, y);
+  AutoGUI::moveTo(target.x, target.y, duration);
+}
+
+void WindowBatch::click(int x, int y, Button button, int clicks, double interval) {
+  const Robot::Point target = toScreen(x, y);
+  AutoGUI::moveTo(target.x, target.y);
+  delayMs(10);
+  AutoGUI::click(-1, -1, button, clicks, interval);
+}
+
+// 全局热键实现
+namespace {
+
+// 将 {"ctrl", "shift", "f12"} 解析为主键与修饰键掩码
+std::pair<Robot::KeyCode, unsigned int> parseHotkey(const std::vector<std::string> &keys) {
+  if (keys.empty()) {
+    throw AutoGUIException("Hotkey cannot be empty");
+  }
+  unsigned int modifiers = Robot::HotkeyListener::MOD_NONE;
+  for (size_t i = 0; i + 1 < keys.size(); i++) {
+    const std::string key = toLower(keys[i]);
+    if (key == "ctrl" || key == "control") {
+      modifiers |= Robot::HotkeyListener::MOD_CONTROL;
+    } else if (key == "shift") {
+      modifiers |= Robot::HotkeyListener::MOD_SHIFT;
+    } else if (key == "alt") {
+      modifiers |= Robot::HotkeyListener::MOD_ALT;
+    } else if (key == "win" || key == "command" || key == "cmd") {
+      modifiers |= Robot::HotkeyListener::MOD_META;
+    } else {
+      throw AutoGUIException("Unknown hotkey modifier: " + keys[i]);
+    }
+  }
+
+  const std::string mainKey = toLower(keys.back());
+  if (mainKey.length() == 1) {
+    return {Robot::Keyboard::AsciiToVirtualKey(mainKey[0]), modifiers};
+  }
+  if (isSpecialKey(mainKey)) {
+    return {Robot::Keyboard::SpecialKeyToVirtualKey(stringToSpecialKey(mainKey)), modifiers};
+  }
+  throw AutoGUIException("Unknown key: " + keys.back());
+}
+
+} // namespace
+
+Robot::HotkeyListener &hotkeyListener() {
+  static Robot::HotkeyListener listener;
+  return listener;
+}
+
+int registerHotkey(const std::vector<std::string> &keys, std::function<void()> callback) {
+  auto parsed = parseHotkey(keys);
+  Robot::HotkeyListener &listener = hotkeyListener();
+  if (!listener.IsRunning()) {
+    listener.Start();
+  }
+  return listener.Register(parsed.first, parsed.second, std::move(callback));
+}
+
+int registerKillSwitch(const std::vector<std::string> &keys, std::function<void()> callback) {
+  auto parsed = parseHotkey(keys);
+  Robot::HotkeyListener &listener = hotkeyListener();
+  if (!listener.IsRunning()) {
+    listener.Start();
+  }
+  return listener.RegisterKillSwitch(parsed.first, parsed.second, std::move(callback));
+}
+
+void unregisterHotkey(int id) {
+  hotkeyListener().Unregister(id);
+}
+
+// 辅助函数实现
+
+bool isValidCoord(int x, int y) { return defaultSession().isValidCoord(x, y); }
+
 std::string toLower(const std::string &str) {
   std::string result = str;
   std::transform(result.begin(), result.end(), result.begin(), ::tolower);
@@ -576,31 +1088,13 @@ void dragRandomInArea(const int x1, const int y1, const int x2, const int y2,
 }
 
 // 模拟人类打字
-void typeHumanLike(const std::string& text, double minDelay, double maxDelay, double errorRate) {
-  std::random_device rd;
-  std::mt19937 gen(rd());
-  std::uniform_real_distribution<> delayDist(minDelay, maxDelay);
-  std::uniform_real_distribution<> errorDist(0.0, 1.0);
-
-  for (char c : text) {
-    // 有一定概率打错字
-    if (errorDist(gen) < errorRate) {
-      // 输入一个随机错误字符
-      char wrongChar = 'a' + static_cast<char>(errorDist(gen) * 26);
-      AutoGUI::press(std::string(1, wrongChar));
-
-      // 退格删除错误
-      AutoGUI::press("backspace");
-      AutoGUI::sleep(0.1);
-    }
-
-    // 输入正确字符
-    AutoGUI::press(std::string(1, c));
-
-    // 随机延迟
-    double delay = delayDist(gen);
-    AutoGUI::sleep(delay);
-  }
+void typeHumanLike(const std::string& text, double minDelay, double maxDelay, double errorRate, uint64_t seed) {
+  Robot::CadenceOptions options;
+  options.minDelay = minDelay;
+  options.maxDelay = maxDelay;
+  options.errorRate = errorRate;
+  options.seed = seed;
+  defaultSession().typeSchedule(Robot::TypingCadence(options).Schedule(text));
 }
 
 void typewriteEnter(const std::string& text, double interval) {
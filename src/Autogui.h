@@ -4,14 +4,28 @@
 #pragma once
 
 #include <algorithm>
+#include <cctype>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 #include <map>
 #include <initializer_list>
+#include <functional>
+#include <memory>
+#include <optional>
 
+#include "AdaptivePacer.h"
+#include "HotkeyListener.h"
 #include "Keyboard.h"
 #include "Mouse.h"
+#include "Screen.h"
+#include "TemplateCache.h"
+#include "TemplateMatcher.h"
+#include "TypingCadence.h"
+#include "UInput.h"
+#include "WindowInput.h"
+#include "WindowRegistry.h"
 #include "types.h"
 
 namespace AutoGUI {
@@ -56,73 +70,83 @@ inline std::string buttonToString(Button button) {
     }
 }
 
-// 键名字符串到 Keyboard::SpecialKey 的映射
-inline Robot::Keyboard::SpecialKey stringToSpecialKey(const std::string& key) {
-    static std::map<std::string, Robot::Keyboard::SpecialKey> keyMap = {
-        {"backspace", Robot::Keyboard::BACKSPACE},
-        {"enter", Robot::Keyboard::ENTER},
-        {"return", Robot::Keyboard::ENTER},
-        {"tab", Robot::Keyboard::TAB},
-        {"escape", Robot::Keyboard::ESCAPE},
-        {"esc", Robot::Keyboard::ESCAPE},
-        {"up", Robot::Keyboard::UP},
-        {"down", Robot::Keyboard::DOWN},
-        {"right", Robot::Keyboard::RIGHT},
-        {"left", Robot::Keyboard::LEFT},
-        {"win", Robot::Keyboard::META},
-        {"command", Robot::Keyboard::META},
-        {"cmd", Robot::Keyboard::META},
-        {"alt", Robot::Keyboard::ALT},
-        {"ctrl", Robot::Keyboard::CONTROL},
-        {"control", Robot::Keyboard::CONTROL},
-        {"shift", Robot::Keyboard::SHIFT},
-        {"capslock", Robot::Keyboard::CAPSLOCK},
-        {"f1", Robot::Keyboard::F1},
-        {"f2", Robot::Keyboard::F2},
-        {"f3", Robot::Keyboard::F3},
-        {"f4", Robot::Keyboard::F4},
-        {"f5", Robot::Keyboard::F5},
-        {"f6", Robot::Keyboard::F6},
-        {"f7", Robot::Keyboard::F7},
-        {"f8", Robot::Keyboard::F8},
-        {"f9", Robot::Keyboard::F9},
-        {"f10", Robot::Keyboard::F10},
-        {"f11", Robot::Keyboard::F11},
-        {"f12", Robot::Keyboard::F12},
-        {"space", Robot::Keyboard::BACKSPACE}   // 特殊处理空格
-    };
+// 键名到 Keyboard::SpecialKey 的映射表（键名均为小写），stringToSpecialKey、isSpecialKey与Session共用
+struct SpecialKeyName {
+    const char* name;
+    Robot::Keyboard::SpecialKey key;
+};
 
-    std::string lower = key;
-    std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+inline constexpr SpecialKeyName kSpecialKeyNames[] = {
+    {"backspace", Robot::Keyboard::BACKSPACE},
+    {"enter", Robot::Keyboard::ENTER},
+    {"return", Robot::Keyboard::ENTER},
+    {"tab", Robot::Keyboard::TAB},
+    {"escape", Robot::Keyboard::ESCAPE},
+    {"esc", Robot::Keyboard::ESCAPE},
+    {"up", Robot::Keyboard::UP},
+    {"down", Robot::Keyboard::DOWN},
+    {"right", Robot::Keyboard::RIGHT},
+    {"left", Robot::Keyboard::LEFT},
+    {"win", Robot::Keyboard::META},
+    {"command", Robot::Keyboard::META},
+    {"cmd", Robot::Keyboard::META},
+    {"alt", Robot::Keyboard::ALT},
+    {"ctrl", Robot::Keyboard::CONTROL},
+    {"control", Robot::Keyboard::CONTROL},
+    {"shift", Robot::Keyboard::SHIFT},
+    {"capslock", Robot::Keyboard::CAPSLOCK},
+    {"f1", Robot::Keyboard::F1},
+    {"f2", Robot::Keyboard::F2},
+    {"f3", Robot::Keyboard::F3},
+    {"f4", Robot::Keyboard::F4},
+    {"f5", Robot::Keyboard::F5},
+    {"f6", Robot::Keyboard::F6},
+    {"f7", Robot::Keyboard::F7},
+    {"f8", Robot::Keyboard::F8},
+    {"f9", Robot::Keyboard::F9},
+    {"f10", Robot::Keyboard::F10},
+    {"f11", Robot::Keyboard::F11},
+    {"f12", Robot::Keyboard::F12},
+    {"space", Robot::Keyboard::SPACE}
+};
 
-    auto it = keyMap.find(lower);
-    if (it != keyMap.end()) {
-        return it->second;
+// 最长键名的长度，更长的输入不可能是特殊键
+inline constexpr size_t kMaxSpecialKeyNameLength = [] {
+    size_t longest = 0;
+    for (const SpecialKeyName& entry : kSpecialKeyNames) {
+        longest = std::max(longest, std::char_traits<char>::length(entry.name));
     }
+    return longest;
+}();
 
-    // 如果是单个字符，直接返回（会在其他地方处理）
-    if (lower.length() == 1) {
-        // 这是单个字符键，不是特殊键
-        throw AutoGUIException("Unknown key: " + key);
+// 不区分大小写地查找键名，不产生堆分配；未找到时返回nullptr
+inline const SpecialKeyName* findSpecialKey(std::string_view key) {
+    if (key.length() > kMaxSpecialKeyNameLength) {
+        return nullptr;
+    }
+    for (const SpecialKeyName& entry : kSpecialKeyNames) {
+        const std::string_view name(entry.name);
+        if (name.length() == key.length() &&
+            std::equal(name.begin(), name.end(), key.begin(), [](char expected, char actual) {
+                return expected == std::tolower(static_cast<unsigned char>(actual));
+            })) {
+            return &entry;
+        }
     }
+    return nullptr;
+}
 
+// 键名字符串到 Keyboard::SpecialKey 的映射
+inline Robot::Keyboard::SpecialKey stringToSpecialKey(const std::string& key) {
+    if (const SpecialKeyName* entry = findSpecialKey(key)) {
+        return entry->key;
+    }
     throw AutoGUIException("Unknown key: " + key);
 }
 
 // 检查字符串是否是特殊键
 inline bool isSpecialKey(const std::string& key) {
-    static std::vector<std::string> specialKeys = {
-        "backspace", "enter", "return", "tab", "escape", "esc",
-        "up", "down", "right", "left", "win", "command", "cmd",
-        "alt", "ctrl", "control", "shift", "capslock",
-        "f1", "f2", "f3", "f4", "f5", "f6", "f7", "f8", "f9", "f10", "f11", "f12",
-        "space"
-    };
-
-    std::string lower = key;
-    std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
-
-    return std::find(specialKeys.begin(), specialKeys.end(), lower) != specialKeys.end();
+    return findSpecialKey(key) != nullptr;
 }
 
 // 解决多屏幕移动鼠标问题
@@ -309,6 +333,568 @@ void sleep(double seconds);
  */
 Robot::Point size();
 
+// 截图
+/**
+ * @brief 截取屏幕区域（Linux下基于MIT-SHM，零拷贝）
+ * @param x 区域左上角X坐标
+ * @param y 区域左上角Y坐标
+ * @param width 区域宽度，-1表示到虚拟桌面右边缘
+ * @param height 区域高度，-1表示到虚拟桌面下边缘
+ * @return 指向内部共享内存的BGRA图像视图，在下一次截图前有效
+ * @note 所有截图函数共用一个采集器，不是线程安全的，多线程请各自创建Robot::ScreenCapture
+ */
+Robot::ImageView screenshot(int x = 0, int y = 0, int width = -1, int height = -1);
+
+/**
+ * @brief 截取指定显示器的完整画面
+ * @param screenId 屏幕ID（见getAllScreens），-1表示当前鼠标所在屏幕
+ * @return BGRA图像视图，在下一次截图前有效
+ */
+Robot::ImageView screenshotScreen(int screenId = -1);
+
+/**
+ * @brief 获取截图函数共用的采集器
+ */
+Robot::ScreenCapture& screenCapture();
+
+/**
+ * @brief 获取屏幕上指定坐标的颜色
+ * @param x X坐标
+ * @param y Y坐标
+ * @return RGB颜色
+ * @note 缓存帧足够新时直接从缓存读取，见setPixelCacheMaxAge
+ */
+Robot::Color pixel(int x, int y);
+
+/**
+ * @brief 检查指定坐标的颜色是否与期望颜色匹配
+ * @param x X坐标
+ * @param y Y坐标
+ * @param expected 期望颜色
+ * @param tolerance 每个通道允许的最大差值
+ * @return 匹配返回true
+ */
+bool pixelMatchesColor(int x, int y, Robot::Color expected, int tolerance = 0);
+
+/**
+ * @brief 批量读取多个坐标的颜色，所有坐标共用一次截图
+ * @param points 坐标列表
+ * @return 与points一一对应的颜色
+ */
+std::vector<Robot::Color> pixels(const std::vector<Robot::Point>& points);
+
+/**
+ * @brief 批量读取多个坐标的颜色（无分配版本）
+ * @param points 坐标数组
+ * @param count 坐标数量
+ * @param out 输出数组，长度至少为count
+ */
+void pixels(const Robot::Point* points, size_t count, Robot::Color* out);
+
+/**
+ * @brief 设置像素查询所用缓存帧的最大寿命
+ * @param seconds 最大寿命（秒），0表示每次查询都重新截图（默认）
+ * @note 大于0时，缓存过期后会截取整个屏幕，之后该寿命内的所有查询都不再截图
+ */
+void setPixelCacheMaxAge(double seconds);
+
+/**
+ * @brief 立即使像素缓存失效（例如在点击之后）
+ */
+void invalidatePixelCache();
+
+// 图像定位
+/**
+ * @brief 在屏幕上查找与模板图像最相似的位置（零均值归一化互相关）
+ * @param needle 模板图像
+ * @param confidence 最低相似度，范围[-1, 1]，完全一致为1
+ * @param region 搜索区域，宽或高为0表示整个虚拟桌面
+ * @return 匹配区域（屏幕坐标），未找到返回std::nullopt
+ * @note 计算在共享线程池上分块并行执行，内核按CPU支持情况选择AVX2/SSE4.1/标量实现
+ * @note 使用金字塔从粗到细搜索；服务器支持XDamage时，画面未变化的连续调用会复用上次的预处理结果
+ * @note 模板的预处理结果按内容（文件按路径与修改时间）缓存，见templateCache
+ */
+std::optional<Robot::Rect> locateOnScreen(const Robot::Image& needle, double confidence = 0.999,
+                                          Robot::Rect region = {0, 0, 0, 0});
+
+/**
+ * @brief 在屏幕上查找BMP图像文件
+ * @param imagePath 未压缩的24/32位BMP文件路径
+ * @param confidence 最低相似度
+ * @param region 搜索区域，宽或高为0表示整个虚拟桌面
+ * @return 匹配区域（屏幕坐标），未找到返回std::nullopt
+ */
+std::optional<Robot::Rect> locateOnScreen(const std::string& imagePath, double confidence = 0.999,
+                                          Robot::Rect region = {0, 0, 0, 0});
+
+/**
+ * @brief 在屏幕上查找模板图像的所有出现位置
+ * @param needle 模板图像
+ * @param confidence 最低相似度
+ * @param region 搜索区域，宽或高为0表示整个虚拟桌面
+ * @param onMatch 可选回调，扫描过程中每确定一个匹配立即调用（屏幕坐标），不会被并发调用，不能抛出异常
+ * @return 所有匹配区域（屏幕坐标，从上到下、从左到右排序），相互重叠的匹配只保留得分最高者
+ * @note 与locateOnScreen共用截图缓冲区、预处理结果和线程池；只在原始比例下全分辨率搜索
+ */
+std::vector<Robot::Rect> locateAllOnScreen(const Robot::Image& needle, double confidence = 0.999,
+                                           Robot::Rect region = {0, 0, 0, 0},
+                                           const std::function<void(const Robot::Rect&)>& onMatch = nullptr);
+
+/**
+ * @brief 在屏幕上查找BMP图像文件的所有出现位置
+ * @param imagePath 未压缩的24/32位BMP文件路径
+ * @param confidence 最低相似度
+ * @param region 搜索区域，宽或高为0表示整个虚拟桌面
+ * @param onMatch 可选回调，扫描过程中每确定一个匹配立即调用
+ * @return 所有匹配区域（屏幕坐标）
+ */
+std::vector<Robot::Rect> locateAllOnScreen(const std::string& imagePath, double confidence = 0.999,
+                                           Robot::Rect region = {0, 0, 0, 0},
+                                           const std::function<void(const Robot::Rect&)>& onMatch = nullptr);
+
+/**
+ * @brief 在屏幕上同时查找多个模板图像，整个屏幕只扫描一遍
+ * @param needles 模板图像列表
+ * @param confidence 最低相似度
+ * @param region 搜索区域，宽或高为0表示整个虚拟桌面
+ * @return 与needles一一对应的匹配区域（屏幕坐标），未找到的为std::nullopt
+ * @note 适合每个周期检测大量状态模板的场景，灰度转换与积分图每帧只计算一次，尺寸相同的模板共享窗口统计量
+ */
+std::vector<std::optional<Robot::Rect>> locateManyOnScreen(const std::vector<Robot::Image>& needles,
+                                                           double confidence = 0.999,
+                                                           Robot::Rect region = {0, 0, 0, 0});
+
+/**
+ * @brief 查找模板图像并返回匹配区域的中心点
+ * @param needle 模板图像
+ * @param confidence 最低相似度
+ * @param region 搜索区域，宽或高为0表示整个虚拟桌面
+ * @return 中心点坐标，未找到返回std::nullopt
+ */
+std::optional<Robot::Point> locateCenterOnScreen(const Robot::Image& needle, double confidence = 0.999,
+                                                 Robot::Rect region = {0, 0, 0, 0});
+
+/**
+ * @brief 设置图像定位时尝试的模板缩放比例
+ * @param scales 缩放比例列表，默认{1.0}；例如{1.0, 1.25, 1.5}可用同一张100%截取的模板匹配125%/150% DPI缩放下的界面
+ * @note 每增加一个比例，粗搜阶段的计算量大致增加一份
+ */
+void setLocateScales(const std::vector<double>& scales);
+
+// 事件驱动等待
+/**
+ * @brief 等待模板图像出现在屏幕上
+ * @param needle 模板图像
+ * @param timeoutSeconds 超时时间（秒）
+ * @param confidence 最低相似度
+ * @param region 搜索区域，宽或高为0表示整个虚拟桌面
+ * @return 匹配区域（屏幕坐标），超时返回std::nullopt
+ * @note 基于XDamage：只在区域内有像素被重绘时唤醒，并只重新搜索变化部分附近，空闲时不占用CPU；
+ *       服务器不支持XDamage时退化为每50ms检查一次
+ */
+std::optional<Robot::Rect> waitForImage(const Robot::Image& needle, double timeoutSeconds,
+                                        double confidence = 0.999, Robot::Rect region = {0, 0, 0, 0});
+
+/**
+ * @brief 等待BMP图像文件出现在屏幕上
+ * @param imagePath 未压缩的24/32位BMP文件路径
+ * @param timeoutSeconds 超时时间（秒）
+ * @param confidence 最低相似度
+ * @param region 搜索区域，宽或高为0表示整个虚拟桌面
+ * @return 匹配区域（屏幕坐标），超时返回std::nullopt
+ */
+std::optional<Robot::Rect> waitForImage(const std::string& imagePath, double timeoutSeconds,
+                                        double confidence = 0.999, Robot::Rect region = {0, 0, 0, 0});
+
+/**
+ * @brief 等待指定坐标变为期望颜色
+ * @param x X坐标
+ * @param y Y坐标
+ * @param expected 期望颜色
+ * @param timeoutSeconds 超时时间（秒）
+ * @param tolerance 每个通道允许的最大差值
+ * @return 在超时前匹配返回true
+ */
+bool waitForPixel(int x, int y, Robot::Color expected, double timeoutSeconds, int tolerance = 0);
+
+/**
+ * @brief 等待区域内的像素发生变化
+ * @param region 监视区域，宽或高为0表示整个虚拟桌面
+ * @param timeoutSeconds 超时时间（秒）
+ * @return 在超时前有像素变化返回true；只有重绘而内容不变时不算变化
+ */
+bool waitForRegionChange(Robot::Rect region, double timeoutSeconds);
+
+/**
+ * @brief 等待区域内的画面稳定（连续quietSeconds秒没有像素变化），例如等待动画或页面加载结束
+ * @param region 监视区域，宽或高为0表示整个虚拟桌面
+ * @param quietSeconds 需要保持不变的时长（秒）
+ * @param timeoutSeconds 超时时间（秒）
+ * @param tolerance 每个通道允许的最大差值，用于忽略抖动的细微渲染差异
+ * @return 在超时前稳定返回true
+ * @note 变化判断使用SIMD逐帧差分（Robot::FrameDiff），只比较XDamage报告的变化区域
+ */
+bool waitUntilStable(Robot::Rect region, double quietSeconds, double timeoutSeconds, int tolerance = 0);
+
+/**
+ * @brief 预先读取并预处理一批模板文件，避免首次定位时的加载开销
+ * @param imagePaths BMP文件路径列表
+ * @note 按当前setLocateScales设置的缩放比例预处理；文件被修改后下次使用时会自动重新加载
+ */
+void preload(const std::vector<std::string>& imagePaths);
+
+/**
+ * @brief 获取图像定位函数共用的匹配器
+ */
+Robot::TemplateMatcher& templateMatcher();
+
+/**
+ * @brief 获取图像定位函数共用的预处理模板缓存（LRU，默认上限256MB），可用于调整上限或读取命中统计
+ */
+Robot::TemplateCache& templateCache();
+
+// 窗口
+/**
+ * @brief 获取所有顶层窗口
+ * @return 窗口列表，按堆叠顺序从下到上
+ * @note 窗口信息来自进程内索引，首次调用时建立，之后由X事件增量更新，查询本身不产生X请求
+ */
+std::vector<Robot::WindowInfo> getAllWindows();
+
+/**
+ * @brief 查找标题包含指定文本的窗口
+ * @param title 标题子串（区分大小写）
+ * @return 匹配的窗口，最上层的在前
+ */
+std::vector<Robot::WindowInfo> getWindowsWithTitle(const std::string& title);
+
+/**
+ * @brief 获取当前活动窗口（_NET_ACTIVE_WINDOW）
+ * @return 活动窗口，窗口管理器未提供时返回std::nullopt
+ */
+std::optional<Robot::WindowInfo> getActiveWindow();
+
+/**
+ * @brief 获取包含指定屏幕坐标的最上层可见窗口
+ * @param x X坐标
+ * @param y Y坐标
+ * @return 窗口，该位置没有窗口时返回std::nullopt
+ */
+std::optional<Robot::WindowInfo> getWindowAt(int x, int y);
+
+/**
+ * @brief 将窗口客户区内的相对坐标转换为屏幕坐标
+ * @param window 目标窗口（只使用其ID，几何信息取索引中的最新值）
+ * @param x 相对客户区左上角的X坐标
+ * @param y 相对客户区左上角的Y坐标
+ * @return 屏幕坐标
+ * @note 窗口几何由ConfigureNotify事件维护，转换不产生XTranslateCoordinates往返；窗口已关闭时抛出AutoGUIException
+ */
+Robot::Point windowToScreen(const Robot::WindowInfo& window, int x, int y);
+
+/**
+ * @brief 移动鼠标到窗口内的相对位置
+ * @param window 目标窗口
+ * @param x 相对客户区左上角的X坐标
+ * @param y 相对客户区左上角的Y坐标
+ * @param duration 移动持续时间（秒），0表示立即移动
+ */
+void moveTo(const Robot::WindowInfo& window, int x, int y, double duration = 0.0);
+
+/**
+ * @brief 在窗口内的相对位置单击
+ * @param window 目标窗口
+ * @param x 相对客户区左上角的X坐标
+ * @param y 相对客户区左上角的Y坐标
+ * @param button 鼠标按钮
+ * @param clicks 点击次数
+ * @param interval 多次点击之间的间隔（秒）
+ */
+void click(const Robot::WindowInfo& window, int x, int y, Button button = Button::LEFT, int clicks = 1,
+           double interval = 0.0);
+
+/**
+ * @brief 针对同一窗口的一组连续操作
+ * @note 构造时记录窗口的几何版本（WindowInfo::geometryVersion），每次操作前检查窗口是否被移动或改变大小。
+ *       throwOnMove为true时，检测到移动后抛出AutoGUIException，避免后续操作点到错误位置；
+ *       为false时改用新位置继续，可通过moved()得知期间发生过移动
+ */
+class WindowBatch {
+public:
+    explicit WindowBatch(const Robot::WindowInfo& window, bool throwOnMove = true);
+
+    void moveTo(int x, int y, double duration = 0.0);
+    void click(int x, int y, Button button = Button::LEFT, int clicks = 1, double interval = 0.0);
+
+    // 相对坐标转换为屏幕坐标，同样会检查窗口是否移动
+    Robot::Point toScreen(int x, int y);
+
+    // 自构造以来窗口是否被移动或改变过大小（会读取最新事件）
+    [[nodiscard]] bool moved();
+
+    // 批处理当前使用的窗口信息
+    [[nodiscard]] const Robot::WindowInfo& window() const { return current; }
+
+private:
+    Robot::WindowInfo initial;
+    Robot::WindowInfo current;
+    bool throwOnMove;
+};
+
+/**
+ * @brief 获取窗口函数共用的窗口索引
+ */
+Robot::WindowRegistry& windowRegistry();
+
+// 全局热键
+/**
+ * @brief 注册全局热键（首次调用时启动默认监听器）
+ * @param keys 组合键，如 {"ctrl", "shift", "f12"}，修饰键在前，最后一个为主键
+ * @param callback 触发时执行的回调，默认在监听器的分发线程上执行
+ * @return 热键ID，组合键被其他程序占用时返回-1
+ */
+int registerHotkey(const std::vector<std::string>& keys, std::function<void()> callback);
+
+/**
+ * @brief 注册紧急停止键，回调直接在监听器事件线程上执行，不经过分发队列
+ * @param keys 组合键
+ * @param callback 触发时执行的回调，应尽量简短（如设置停止标志）
+ * @return 热键ID，注册失败返回-1
+ */
+int registerKillSwitch(const std::vector<std::string>& keys, std::function<void()> callback);
+
+/**
+ * @brief 注销热键
+ * @param id registerHotkey/registerKillSwitch返回的ID
+ */
+void unregisterHotkey(int id);
+
+/**
+ * @brief 获取默认热键监听器，用于设置执行器或读取延迟统计
+ */
+Robot::HotkeyListener& hotkeyListener();
+
+// 会话
+/**
+ * @brief 不抛出异常的接口（try*）的返回状态
+ * @note 不能命名为Status：Xlib将Status定义为宏
+ */
+enum class InputStatus : uint8_t {
+    OK = 0,
+    INVALID_COORDINATES, // 坐标超出主屏范围
+    INVALID_ARGUMENT,    // 如负的duration
+    UNKNOWN_KEY,         // 无法识别的键名
+    UNMAPPED_KEY,        // 当前键盘布局中没有该键，不会发送任何事件
+    NO_DISPLAY,          // 无法连接默认显示器
+    FAILED               // 其他错误
+};
+
+/**
+ * @brief 状态的简短英文描述（静态字符串）
+ */
+const char* inputStatusToString(InputStatus status) noexcept;
+
+/**
+ * @brief Linux上发送输入与查询屏幕使用的协议库
+ * @note DEFAULT取环境变量AUTOGUI_BACKEND（"xlib"或"uinput"），未设置时为XLIB。
+ *       UINPUT后端通过Robot::UInput的内核虚拟设备注入输入（需要/dev/uinput写权限），
+ *       键码映射与屏幕仍从X连接读取（适用于Xorg/XWayland）；uinput事件经内核异步到达X服务器，
+ *       因此position()返回最近一次经uinput发出的坐标，尚未移动过时才查询X。没有X时直接使用Robot::UInput
+ */
+enum class Backend {
+    DEFAULT,
+    XLIB,
+    UINPUT
+};
+
+/**
+ * @brief 持有一条独立显示器连接及其全部输入状态的会话
+ * @note Linux上构造时打开连接并预先计算ASCII字符到键码（及是否需要Shift）的映射表，
+ *       屏幕信息缓存到RandR报告屏幕变化为止，按下的键与鼠标按钮记录在会话内，析构时全部释放。
+ *       会话本身不是线程安全的：多线程或多显示器（如多个Xvfb）并行时每个线程/显示器各用一个会话。
+ *       上面的鼠标、键盘与屏幕函数都委托给defaultSession()。
+ *       其他平台上会话只是对Robot::Mouse/Keyboard的包装，displayName被忽略
+ */
+class Session {
+public:
+    /**
+     * @param displayName X显示器名，如":99"；为空时使用DISPLAY环境变量
+     * @param backend 协议库，其他平台忽略
+     * @throws AutoGUIException 无法打开显示器，或请求的后端未编译进库时
+     */
+    explicit Session(const std::string& displayName = "", Backend backend = Backend::DEFAULT);
+    ~Session();
+
+    Session(const Session&) = delete;
+    Session& operator=(const Session&) = delete;
+
+    void moveTo(int x, int y, double duration = 0.0);
+    void moveRel(int xOffset, int yOffset, double duration = 0.0);
+    void click(int x = -1, int y = -1, Button button = Button::LEFT, int clicks = 1, double interval = 0.0);
+    void mouseDown(Button button = Button::LEFT, int x = -1, int y = -1);
+    void mouseUp(Button button = Button::LEFT, int x = -1, int y = -1);
+    void drag(int x1, int y1, int x2, int y2, double duration = 0.0, Button button = Button::LEFT);
+    void dragTo(int x, int y, double duration = 0.0, Button button = Button::LEFT);
+    void dragRel(int xOffset, int yOffset, double duration = 0.0, Button button = Button::LEFT);
+    Robot::Point position();
+    void scroll(int clicks, int x = 0);
+
+    void type(const std::string& text, double interval = 0.0);
+    void press(const std::string& key);
+    void keyDown(const std::string& key);
+    void keyUp(const std::string& key);
+    void hotkey(const std::vector<std::string>& keys);
+
+    // 按Robot::TypingCadence生成的时间表输入：键码在开始前一次性解析，
+    // 每次按下/释放都等待到时间表中的绝对时刻，误差不随文本长度累积
+    void typeSchedule(const std::vector<Robot::Keystroke>& schedule);
+
+    // 以下为不抛出异常的版本：参数检查失败时直接返回状态，错误路径上没有堆分配与异常开销。
+    // 坐标检查使用缓存的屏幕尺寸，不产生X请求
+    InputStatus tryMoveTo(int x, int y, double duration = 0.0) noexcept;
+    InputStatus tryClick(int x = -1, int y = -1, Button button = Button::LEFT, int clicks = 1,
+                    double interval = 0.0) noexcept;
+    InputStatus tryDrag(int x1, int y1, int x2, int y2, double duration = 0.0, Button button = Button::LEFT) noexcept;
+    InputStatus tryPress(const std::string& key) noexcept;
+    InputStatus tryKeyDown(const std::string& key) noexcept;
+    InputStatus tryKeyUp(const std::string& key) noexcept;
+
+    // 释放通过本会话按下且尚未释放的所有键与鼠标按钮
+    void releaseAll();
+
+    // 所有屏幕（缓存，屏幕配置变化后自动刷新）
+    std::vector<ScreenInfo> getAllScreens();
+
+    // 主屏尺寸
+    Robot::Point size();
+
+    bool isValidCoord(int x, int y);
+
+    // 丢弃屏幕缓存，下次查询时重新读取
+    void invalidateScreenCache();
+
+    [[nodiscard]] const std::string& displayName() const { return name; }
+
+    // 实际使用的后端（不会是DEFAULT）
+    [[nodiscard]] Backend backend() const { return activeBackend; }
+
+    // 自适应限速：开启后type/press/hotkey等键盘事件与moveTo平滑移动的每一步都经过限速器，
+    // 每隔若干事件测量一次X往返延迟（XSync），按AIMD在[minRate, maxRate]内调整速率。
+    // 默认关闭，使用每个事件1ms的固定延迟。注意XTest事件在服务器内几乎立即处理完，
+    // 往返延迟只在X服务器本身过载时上升，不能反映目标程序是否丢键，因此maxRate应按目标实测设置。
+    // UINPUT后端的事件不经过X连接，不做测量，速率保持为initialRate；其他平台同样如此
+    void setPacing(bool enabled, const Robot::PacingOptions& options = Robot::PacingOptions());
+    [[nodiscard]] bool pacingEnabled() const { return pacing; }
+
+    // 当前选定的速率与往返延迟统计
+    [[nodiscard]] Robot::PacingStats pacingStats() const { return pacer.GetStats(); }
+
+private:
+    void toggleButton(bool down, Button button);
+    void performDrag(int x1, int y1, int x2, int y2, double duration, Button button);
+    enum class KeyAction { PRESS, DOWN, UP };
+    // 解析一次键名并执行动作；press/keyDown/keyUp与对应的try版本共用，键名未知时不发送任何事件
+    InputStatus sendNamedKey(const std::string& key, KeyAction action);
+    void moveSmooth(Robot::Point target);
+    // 发送每个受限速的事件之前调用
+    void pace();
+
+#ifdef __linux__
+    struct AsciiKey {
+        unsigned int keycode = 0;  // 0表示当前键盘布局无法输入
+        bool shift = false;
+    };
+
+    // 处理已到达的事件：屏幕配置变化使屏幕缓存失效，键盘映射变化时重建映射表
+    void pollEvents();
+    void loadKeymap();
+    unsigned int keycodeFor(unsigned long keysym);
+    InputStatus lookupKey(const std::string& key, unsigned int& keycode, bool& shift);
+    void clickKeycode(unsigned int keycode, bool shift);
+    void sendKey(unsigned int keycode, bool down);
+    void clickChar(char c);
+    void loadScreens();
+
+    // 后端相关的基本操作，其余逻辑与后端无关
+    void emitKey(unsigned int keycode, bool down);
+    void emitButton(unsigned int button, bool down);
+    void emitMotion(int x, int y);
+    void flushOutput();
+
+    Display* display = nullptr;
+    std::unique_ptr<Robot::UInput> uinput;   // UINPUT后端的虚拟设备
+    Robot::Point uinputPosition{0, 0};       // 最近一次经uinput发出的绝对坐标
+    bool uinputPositionValid = false;
+    ::Window rootWindow = 0;
+    int randrEventBase = -1;
+    unsigned int shiftKeycode = 0;
+    AsciiKey asciiKeys[128];
+    std::map<unsigned long, unsigned int> keycodes;  // keysym -> keycode
+    std::vector<unsigned int> heldKeys;              // 按下顺序
+    unsigned int heldButtons = 0;                    // 第i位对应X按钮i
+    std::vector<ScreenInfo> screens;
+    bool screensValid = false;
+#endif
+    std::string name;
+    Backend activeBackend = Backend::XLIB;
+    Robot::AdaptivePacer pacer;
+    bool pacing = false;
+};
+
+/**
+ * @brief 获取普通函数使用的默认会话（首次调用时连接DISPLAY指定的显示器）
+ */
+Session& defaultSession();
+
+// 后端基准结果
+struct BackendBenchmark {
+    Backend backend;
+    double motionEventsPerSecond;   // 连续发送指针移动事件（以一次往返确认全部被处理）
+    double pointerQueryMicroseconds; // 单次position()往返
+    double screenQueryMicroseconds;  // 单次不使用缓存的getAllScreens()
+};
+
+/**
+ * @brief 在指定显示器上依次测量每个可用后端（XLIB，有/dev/uinput写权限时还有UINPUT）的输入发送速率与查询延迟
+ * @param displayName 显示器名，为空时使用DISPLAY环境变量；测试会移动该显示器上的指针，建议使用Xvfb
+ * @param iterations 每项测量的次数
+ * @return 每个后端一项，其他平台返回空
+ */
+std::vector<BackendBenchmark> benchmarkBackends(const std::string& displayName = "", int iterations = 1000);
+
+/**
+ * @brief 不抛出异常的拖动，参数与drag相同
+ * @return 坐标无效时为INVALID_COORDINATES，duration为负时为INVALID_ARGUMENT，无法连接显示器时为NO_DISPLAY
+ * @note 以下try*函数均在默认会话上执行，适合需要频繁试探坐标或键名的循环
+ */
+InputStatus tryDrag(int x1, int y1, int x2, int y2, double duration = 0.0, Button button = Button::LEFT) noexcept;
+
+/**
+ * @brief 不抛出异常的移动，坐标超出主屏时返回INVALID_COORDINATES
+ */
+InputStatus tryMoveTo(int x, int y, double duration = 0.0) noexcept;
+
+/**
+ * @brief 不抛出异常的点击，x、y均为-1时在当前位置点击
+ */
+InputStatus tryClick(int x = -1, int y = -1, Button button = Button::LEFT, int clicks = 1, double interval = 0.0) noexcept;
+
+/**
+ * @brief 不抛出异常的按键
+ * @return 键名无法识别时为UNKNOWN_KEY，当前布局中没有该键时为UNMAPPED_KEY
+ */
+InputStatus tryPress(const std::string& key) noexcept;
+
+/**
+ * @brief 不抛出异常的按下键，返回值同tryPress
+ */
+InputStatus tryKeyDown(const std::string& key) noexcept;
+
+/**
+ * @brief 不抛出异常的释放键，返回值同tryPress
+ */
+InputStatus tryKeyUp(const std::string& key) noexcept;
+
 // 辅助函数
 /**
  * @brief 检查坐标是否有效
@@ -371,9 +957,12 @@ void dragRandomInArea(int x1, int y1, int x2, int y2,
  * @param minDelay 最小延迟（秒）
  * @param maxDelay 最大延迟（秒）
  * @param errorRate 错误率（0.0-1.0）
+ * @param seed 随机种子，相同种子与参数产生完全相同的按键节奏；0表示每次不同
+ * @note 整段文本的按键时间表由Robot::TypingCadence预先生成（按前后字符调整间隔），
+ *       再由defaultSession().typeSchedule()按精确时刻执行
  */
 void typeHumanLike(const std::string& text, double minDelay = 0.05,
-                   double maxDelay = 0.2, double errorRate = 0.0);
+                   double maxDelay = 0.2, double errorRate = 0.0, uint64_t seed = 0);
 
 /**
  * @brief 输入文本并回车
@@ -0,0 +1,164 @@
+#include "./DamageCapture.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#ifdef __linux__
+#include <poll.h>
+#endif
+
+namespace Robot {
+
+namespace {
+
+// 损坏矩形过多时合并为一个外接矩形，避免大量小块读取
+constexpr int kMaxDirtyRects = 64;
+
+}  // namespace
+
+#ifdef __linux__
+
+DamageCapture::DamageCapture() {
+  display = XOpenDisplay(nullptr);
+  if (display == nullptr) {
+    throw std::runtime_error("Cannot open X11 display");
+  }
+
+  int errorBase = 0;
+  if (!XDamageQueryExtension(display, &damageEventBase, &errorBase)) {
+    XCloseDisplay(display);
+    display = nullptr;
+    throw std::runtime_error("XDamage extension is not available");
+  }
+
+  const Rect bounds = capture.RootBounds();
+  width = bounds.width;
+  height = bounds.height;
+  frame.resize(static_cast<size_t>(width) * height * 4);
+
+  // NonEmpty级别：损坏区域从空变为非空时只通知一次，直到下一次Subtract
+  damage = XDamageCreate(display, DefaultRootWindow(display), XDamageReportNonEmpty);
+  region = XFixesCreateRegion(display, nullptr, 0);
+  XSync(display, False);
+}
+
+DamageCapture::~DamageCapture() {
+  if (display != nullptr) {
+    XFixesDestroyRegion(display, region);
+    XDamageDestroy(display, damage);
+    XCloseDisplay(display);
+  }
+}
+
+bool DamageCapture::WaitForDamage(std::chrono::milliseconds timeout) {
+  const auto deadline = std::chrono::steady_clock::now() + timeout;
+  pollfd fd{};
+  fd.fd = ConnectionNumber(display);
+  fd.events = POLLIN;
+
+  while (true) {
+    while (XPending(display) > 0) {
+      XEvent event;
+      XNextEvent(display, &event);
+      if (event.type == damageEventBase + XDamageNotify) {
+        pendingDamage = true;
+      }
+    }
+    if (pendingDamage) {
+      return true;
+    }
+
+    const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+        deadline - std::chrono::steady_clock::now());
+    if (remaining.count() <= 0) {
+      return false;
+    }
+    poll(&fd, 1, static_cast<int>(remaining.count()));
+  }
+}
+
+bool DamageCapture::Update() {
+  dirtyRects.clear();
+
+  // 丢弃已到达的通知，实际损坏区域以Subtract取回的为准
+  while (XPending(display) > 0) {
+    XEvent event;
+    XNextEvent(display, &event);
+  }
+  pendingDamage = false;
+
+  XDamageSubtract(display, damage, None, region);
+
+  if (!initialized) {
+    initialized = true;
+    dirtyRects.push_back({0, 0, width, height});
+  } else {
+    int count = 0;
+    XRectangle* rects = XFixesFetchRegion(display, region, &count);
+    if (count > kMaxDirtyRects) {
+      int x1 = width, y1 = height, x2 = 0, y2 = 0;
+      for (int i = 0; i < count; i++) {
+        x1 = std::min(x1, static_cast<int>(rects[i].x));
+        y1 = std::min(y1, static_cast<int>(rects[i].y));
+        x2 = std::max(x2, rects[i].x + static_cast<int>(rects[i].width));
+        y2 = std::max(y2, rects[i].y + static_cast<int>(rects[i].height));
+      }
+      dirtyRects.push_back({x1, y1, x2 - x1, y2 - y1});
+    } else {
+      for (int i = 0; i < count; i++) {
+        dirtyRects.push_back({rects[i].x, rects[i].y, rects[i].width, rects[i].height});
+      }
+    }
+    if (rects != nullptr) {
+      XFree(rects);
+    }
+  }
+
+  for (const Rect& rect : dirtyRects) {
+    CopyRegion(rect);
+  }
+  if (!dirtyRects.empty()) {
+    frameNumber++;
+  }
+  return !dirtyRects.empty();
+}
+
+#else
+
+DamageCapture::DamageCapture() {
+  throw std::runtime_error("DamageCapture is only supported on Linux X11");
+}
+
+DamageCapture::~DamageCapture() = default;
+
+bool DamageCapture::WaitForDamage(std::chrono::milliseconds) { return false; }
+
+bool DamageCapture::Update() { return false; }
+
+#endif
+
+void DamageCapture::CopyRegion(Rect rect) {
+  const ImageView view = capture.Capture(rect);
+  if (view.Empty()) {
+    return;
+  }
+  // Capture会裁剪区域，按裁剪后的左上角写回
+  const int x = std::max(rect.x, 0);
+  const int y = std::max(rect.y, 0);
+  const size_t rowBytes = static_cast<size_t>(view.width) * 4;
+  for (int row = 0; row < view.height; row++) {
+    memcpy(frame.data() + (static_cast<size_t>(y + row) * width + x) * 4, view.Row(row), rowBytes);
+  }
+}
+
+ImageView DamageCapture::Frame() const {
+  ImageView view;
+  view.data = frame.data();
+  view.width = width;
+  view.height = height;
+  view.stride = width * 4;
+  return view;
+}
+
+}  // namespace Robot
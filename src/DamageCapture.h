@@ -0,0 +1,65 @@
+#pragma once
+
+#include "./Screen.h"
+#include "./types.h"
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#ifdef __linux__
+#include <X11/Xlib.h>
+#include <X11/extensions/Xdamage.h>
+#include <X11/extensions/Xfixes.h>
+#endif
+
+namespace Robot {
+
+// 基于XDamage的增量屏幕采集
+// 维护一份完整的持久帧，每次Update()只重新读取服务器报告为已损坏的矩形区域，
+// 画面静止时Update()不产生任何像素传输。
+// 本实例不是线程安全的，Frame()返回的视图在下一次Update()之前有效。
+class DamageCapture {
+ public:
+  DamageCapture();
+  ~DamageCapture();
+
+  DamageCapture(const DamageCapture&) = delete;
+  DamageCapture& operator=(const DamageCapture&) = delete;
+
+  // 收取所有待处理的损坏通知并刷新对应区域，返回本帧是否有变化；首次调用会读取整个屏幕
+  bool Update();
+
+  // 阻塞等待新的损坏通知，超时返回false；不会刷新帧，需要再调用Update()
+  bool WaitForDamage(std::chrono::milliseconds timeout);
+
+  // 最近一次Update()刷新的矩形区域
+  const std::vector<Rect>& DirtyRects() const { return dirtyRects; }
+
+  // 完整的持久帧（BGRA）
+  ImageView Frame() const;
+
+  // 发生过变化的Update()次数
+  uint64_t FrameNumber() const { return frameNumber; }
+
+ private:
+  void CopyRegion(Rect rect);
+
+  ScreenCapture capture;
+  std::vector<uint8_t> frame;
+  int width = 0;
+  int height = 0;
+  std::vector<Rect> dirtyRects;
+  uint64_t frameNumber = 0;
+  bool initialized = false;
+  bool pendingDamage = false;
+
+#ifdef __linux__
+  Display* display = nullptr;
+  Damage damage = 0;
+  XserverRegion region = 0;
+  int damageEventBase = 0;
+#endif
+};
+
+}  // namespace Robot
@@ -0,0 +1,616 @@
+#include "./EventCodec.h"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+
+namespace Robot {
+
+namespace {
+
+constexpr uint8_t kTagTypeMask = 0x07;
+constexpr uint8_t kTagHasCoords = 0x08;
+constexpr uint8_t kTagHasCode = 0x10;
+
+// 单个块负载的上限，防止损坏的块头导致超大分配
+constexpr uint32_t kMaxPayloadSize = EventEncoder::kMaxBlockEvents * 32;
+
+std::array<uint32_t, 256> MakeCrcTable() {
+  std::array<uint32_t, 256> table{};
+  for (uint32_t i = 0; i < 256; i++) {
+    uint32_t c = i;
+    for (int k = 0; k < 8; k++) {
+      c = (c & 1) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+    }
+    table[i] = c;
+  }
+  return table;
+}
+
+const std::array<uint32_t, 256> kCrcTable = MakeCrcTable();
+
+inline uint64_t ZigZag(int64_t value) {
+  return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+inline int64_t UnZigZag(uint64_t value) {
+  return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+inline void PutVarint(std::vector<uint8_t>& out, uint64_t value) {
+  while (value >= 0x80) {
+    out.push_back(static_cast<uint8_t>(value) | 0x80);
+    value >>= 7;
+  }
+  out.push_back(static_cast<uint8_t>(value));
+}
+
+inline uint64_t GetVarint(const std::vector<uint8_t>& in, size_t& offset) {
+  uint64_t value = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    if (offset >= in.size()) {
+      throw std::runtime_error("Truncated varint in compact event log");
+    }
+    const uint8_t byte = in[offset++];
+    value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+    if ((byte & 0x80) == 0) {
+      return value;
+    }
+  }
+  throw std::runtime_error("Malformed varint in compact event log");
+}
+
+bool TypeCarriesCode(InputEventType type) {
+  return type != InputEventType::MOTION;
+}
+
+const char* TypeToString(InputEventType type) {
+  switch (type) {
+    case InputEventType::KEY_DOWN: return "key_down";
+    case InputEventType::KEY_UP: return "key_up";
+    case InputEventType::BUTTON_DOWN: return "button_down";
+    case InputEventType::BUTTON_UP: return "button_up";
+    case InputEventType::MOTION: return "motion";
+  }
+  return "motion";
+}
+
+InputEventType TypeFromString(const std::string& name) {
+  if (name == "key_down") return InputEventType::KEY_DOWN;
+  if (name == "key_up") return InputEventType::KEY_UP;
+  if (name == "button_down") return InputEventType::BUTTON_DOWN;
+  if (name == "button_up") return InputEventType::BUTTON_UP;
+  if (name == "motion") return InputEventType::MOTION;
+  throw std::runtime_error("Unknown event type in JSON: " + name);
+}
+
+struct FileCloser {
+  void operator()(FILE* file) const { fclose(file); }
+};
+using FilePtr = std::unique_ptr<FILE, FileCloser>;
+
+// 转换失败时删除写了一半的输出；只删除普通文件，输出到设备（如/dev/stdout）时不动
+void RemovePartialOutput(const std::string& path) {
+  std::error_code error;
+  if (std::filesystem::is_regular_file(path, error)) {
+    std::filesystem::remove(path, error);
+  }
+}
+
+// 事件日志JSON的最小解析器：按结构逐个读取对象的键，不会匹配到字符串值内部的文本。
+// 只需要支持ConvertCompactToJson输出的子集（对象、数组、字符串、整数），其他值按语法跳过
+class JsonReader {
+ public:
+  JsonReader(const std::string& text, const std::string& path) : text(text), path(path) {}
+
+  void SkipSpace() {
+    while (pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos]))) {
+      pos++;
+    }
+  }
+
+  // 跳过空白后若下一个字符为c则读取并返回true
+  bool Consume(char c) {
+    SkipSpace();
+    if (pos < text.size() && text[pos] == c) {
+      pos++;
+      return true;
+    }
+    return false;
+  }
+
+  void Expect(char c) {
+    if (!Consume(c)) {
+      Fail(std::string("expected '") + c + "'");
+    }
+  }
+
+  // 读取对象中的下一个键，对象结束时返回false；first为true表示刚读过'{'
+  bool NextKey(bool& first, std::string& key) {
+    if (Consume('}')) {
+      return false;
+    }
+    if (!first) {
+      Expect(',');
+    }
+    first = false;
+    key = ReadString();
+    Expect(':');
+    return true;
+  }
+
+  std::string ReadString() {
+    Expect('"');
+    std::string value;
+    while (pos < text.size() && text[pos] != '"') {
+      char c = text[pos++];
+      if (c == '\\') {
+        if (pos >= text.size()) {
+          break;
+        }
+        c = text[pos++];
+        switch (c) {
+          case 'n': c = '\n'; break;
+          case 't': c = '\t'; break;
+          case 'r': c = '\r'; break;
+          case 'b': c = '\b'; break;
+          case 'f': c = '\f'; break;
+          case 'u':
+            // 本格式中的字符串都是ASCII，\uXXXX只需跳过
+            pos = std::min(text.size(), pos + 4);
+            c = '?';
+            break;
+          default: break;  // \" \\ \/
+        }
+      }
+      value.push_back(c);
+    }
+    Expect('"');
+    return value;
+  }
+
+  int64_t ReadInt() {
+    SkipSpace();
+    const char* begin = text.c_str() + pos;
+    char* end = nullptr;
+    const long long value = std::strtoll(begin, &end, 10);
+    if (end == begin) {
+      Fail("expected an integer");
+    }
+    pos += static_cast<size_t>(end - begin);
+    // 容忍小数/指数部分
+    while (pos < text.size() && (std::isdigit(static_cast<unsigned char>(text[pos])) || text[pos] == '.' ||
+                                 text[pos] == 'e' || text[pos] == 'E' || text[pos] == '+' || text[pos] == '-')) {
+      pos++;
+    }
+    return value;
+  }
+
+  void SkipValue() {
+    SkipSpace();
+    if (pos >= text.size()) {
+      Fail("unexpected end of input");
+    }
+    const char c = text[pos];
+    if (c == '"') {
+      ReadString();
+    } else if (c == '{') {
+      pos++;
+      bool first = true;
+      std::string key;
+      while (NextKey(first, key)) {
+        SkipValue();
+      }
+    } else if (c == '[') {
+      pos++;
+      if (!Consume(']')) {
+        do {
+          SkipValue();
+        } while (Consume(','));
+        Expect(']');
+      }
+    } else {
+      // 数字、true、false、null
+      while (pos < text.size() && text[pos] != ',' && text[pos] != '}' && text[pos] != ']' &&
+             !std::isspace(static_cast<unsigned char>(text[pos]))) {
+        pos++;
+      }
+    }
+  }
+
+  [[noreturn]] void Fail(const std::string& what) const {
+    throw std::runtime_error("Invalid JSON event log (" + what + " at offset " + std::to_string(pos) +
+                             "): " + path);
+  }
+
+ private:
+  const std::string& text;
+  const std::string& path;
+  size_t pos = 0;
+};
+
+InputEvent ReadJsonEvent(JsonReader& reader) {
+  InputEvent event{};
+  bool hasType = false;
+  reader.Expect('{');
+  bool first = true;
+  std::string key;
+  while (reader.NextKey(first, key)) {
+    if (key == "t") {
+      event.timeUs = static_cast<uint64_t>(reader.ReadInt());
+    } else if (key == "type") {
+      event.type = TypeFromString(reader.ReadString());
+      hasType = true;
+    } else if (key == "code") {
+      event.code = static_cast<uint16_t>(reader.ReadInt());
+    } else if (key == "x") {
+      event.x = static_cast<int16_t>(reader.ReadInt());
+    } else if (key == "y") {
+      event.y = static_cast<int16_t>(reader.ReadInt());
+    } else {
+      reader.SkipValue();
+    }
+  }
+  if (!hasType) {
+    reader.Fail("event without \"type\"");
+  }
+  return event;
+}
+
+}  // namespace
+
+uint32_t Crc32(const uint8_t* data, size_t size, uint32_t crc) {
+  crc = ~crc;
+  for (size_t i = 0; i < size; i++) {
+    crc = kCrcTable[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+  }
+  return ~crc;
+}
+
+// ---------------- EventEncoder ----------------
+
+EventEncoder::~EventEncoder() {
+  if (file != nullptr) {
+    try {
+      Close();
+    } catch (...) {
+      // 析构函数中不能抛出异常，需要得知写入失败时应显式调用Close()
+    }
+  }
+}
+
+void EventEncoder::Open(const std::string& path, uint64_t startEpochUs) {
+  if (file != nullptr) {
+    throw std::runtime_error("EventEncoder is already open");
+  }
+  file = fopen(path.c_str(), "wb");
+  if (file == nullptr) {
+    throw std::runtime_error("Cannot open compact event log: " + path);
+  }
+  setvbuf(file, nullptr, _IOFBF, 1 << 18);
+
+  CompactLogHeader header{};
+  memcpy(header.magic, kCompactLogMagic, sizeof(header.magic));
+  header.version = kCompactLogVersion;
+  header.startEpochUs = startEpochUs;
+  if (fwrite(&header, sizeof(header), 1, file) != 1) {
+    fclose(file);
+    file = nullptr;
+    throw std::runtime_error("Cannot write compact event log: " + path);
+  }
+
+  payload.clear();
+  payload.reserve(EventEncoder::kMaxBlockEvents * 8);
+  blockEvents = 0;
+  previous = InputEvent{};
+  eventsWritten = 0;
+  bytesWritten = sizeof(header);
+}
+
+void EventEncoder::Write(const InputEvent& event) {
+  if (file == nullptr) {
+    throw std::runtime_error("EventEncoder is not open");
+  }
+  const int64_t dx = static_cast<int64_t>(event.x) - previous.x;
+  const int64_t dy = static_cast<int64_t>(event.y) - previous.y;
+  const bool hasCoords = dx != 0 || dy != 0;
+  const bool hasCode = TypeCarriesCode(event.type);
+
+  uint8_t tag = static_cast<uint8_t>(event.type) & kTagTypeMask;
+  if (hasCoords) tag |= kTagHasCoords;
+  if (hasCode) tag |= kTagHasCode;
+
+  payload.push_back(tag);
+  PutVarint(payload, ZigZag(static_cast<int64_t>(event.timeUs - previous.timeUs)));
+  if (hasCoords) {
+    PutVarint(payload, ZigZag(dx));
+    PutVarint(payload, ZigZag(dy));
+  }
+  if (hasCode) {
+    PutVarint(payload, event.code);
+  }
+
+  previous = event;
+  eventsWritten++;
+  if (++blockEvents >= kMaxBlockEvents) {
+    FlushBlock();
+  }
+}
+
+void EventEncoder::FlushBlock() {
+  if (blockEvents == 0) {
+    return;
+  }
+  if (file == nullptr) {
+    throw std::runtime_error("EventEncoder is not open");
+  }
+  CompactBlockHeader header{};
+  header.eventCount = blockEvents;
+  header.payloadSize = static_cast<uint32_t>(payload.size());
+  header.crc32 = Crc32(payload.data(), payload.size());
+  if (fwrite(&header, sizeof(header), 1, file) != 1 ||
+      fwrite(payload.data(), 1, payload.size(), file) != payload.size()) {
+    throw std::runtime_error("Failed to write compact event log");
+  }
+  bytesWritten += sizeof(header) + payload.size();
+
+  payload.clear();
+  blockEvents = 0;
+  previous = InputEvent{};
+}
+
+void EventEncoder::Close() {
+  if (file == nullptr) {
+    return;
+  }
+  // 无论写出是否成功都关闭文件，之后再报告错误
+  bool failed = false;
+  try {
+    FlushBlock();
+  } catch (const std::runtime_error&) {
+    failed = true;
+  }
+  failed = fclose(file) != 0 || failed;
+  file = nullptr;
+  if (failed) {
+    throw std::runtime_error("Failed to write compact event log");
+  }
+}
+
+// ---------------- EventDecoder ----------------
+
+EventDecoder::~EventDecoder() {
+  Close();
+}
+
+void EventDecoder::Open(const std::string& path) {
+  if (file != nullptr) {
+    throw std::runtime_error("EventDecoder is already open");
+  }
+  file = fopen(path.c_str(), "rb");
+  if (file == nullptr) {
+    throw std::runtime_error("Cannot open compact event log: " + path);
+  }
+  setvbuf(file, nullptr, _IOFBF, 1 << 18);
+
+  CompactLogHeader header{};
+  if (fread(&header, sizeof(header), 1, file) != 1 ||
+      memcmp(header.magic, kCompactLogMagic, sizeof(header.magic)) != 0 ||
+      header.version != kCompactLogVersion) {
+    Close();
+    throw std::runtime_error("Unsupported compact event log: " + path);
+  }
+  startEpochUs = header.startEpochUs;
+  payload.clear();
+  offset = 0;
+  remaining = 0;
+}
+
+bool EventDecoder::LoadBlock() {
+  CompactBlockHeader header{};
+  if (fread(&header, sizeof(header), 1, file) != 1) {
+    return false;
+  }
+  if (header.payloadSize > kMaxPayloadSize) {
+    throw std::runtime_error("Corrupted block header in compact event log");
+  }
+  payload.resize(header.payloadSize);
+  if (fread(payload.data(), 1, payload.size(), file) != payload.size()) {
+    throw std::runtime_error("Truncated block in compact event log");
+  }
+  if (Crc32(payload.data(), payload.size()) != header.crc32) {
+    throw std::runtime_error("Checksum mismatch in compact event log");
+  }
+  offset = 0;
+  remaining = header.eventCount;
+  previous = InputEvent{};
+  return true;
+}
+
+bool EventDecoder::Next(InputEvent& event) {
+  if (file == nullptr) {
+    return false;
+  }
+  while (remaining == 0) {
+    if (!LoadBlock()) {
+      return false;
+    }
+  }
+
+  if (offset >= payload.size()) {
+    throw std::runtime_error("Truncated event in compact event log");
+  }
+  const uint8_t tag = payload[offset++];
+  event = previous;
+  event.type = static_cast<InputEventType>(tag & kTagTypeMask);
+  event.timeUs = previous.timeUs + static_cast<uint64_t>(UnZigZag(GetVarint(payload, offset)));
+  if (tag & kTagHasCoords) {
+    event.x = static_cast<int16_t>(previous.x + UnZigZag(GetVarint(payload, offset)));
+    event.y = static_cast<int16_t>(previous.y + UnZigZag(GetVarint(payload, offset)));
+  }
+  event.code = (tag & kTagHasCode) ? static_cast<uint16_t>(GetVarint(payload, offset)) : 0;
+  event.reserved = 0;
+
+  previous = event;
+  remaining--;
+  return true;
+}
+
+void EventDecoder::Close() {
+  if (file != nullptr) {
+    fclose(file);
+    file = nullptr;
+  }
+}
+
+// ---------------- 格式转换 ----------------
+
+void ConvertRawToCompact(const std::string& rawPath, const std::string& compactPath) {
+  FilePtr in(fopen(rawPath.c_str(), "rb"));
+  if (!in) {
+    throw std::runtime_error("Cannot open event log: " + rawPath);
+  }
+  EventLogHeader header{};
+  if (fread(&header, sizeof(header), 1, in.get()) != 1 ||
+      memcmp(header.magic, kEventLogMagic, sizeof(header.magic)) != 0 ||
+      header.version != kEventLogVersion || header.recordSize != sizeof(InputEvent)) {
+    throw std::runtime_error("Unsupported event log format: " + rawPath);
+  }
+
+  EventEncoder encoder;
+  encoder.Open(compactPath, header.startEpochUs);
+  std::vector<InputEvent> batch(EventEncoder::kMaxBlockEvents);
+  size_t count;
+  while ((count = fread(batch.data(), sizeof(InputEvent), batch.size(), in.get())) > 0) {
+    for (size_t i = 0; i < count; i++) {
+      encoder.Write(batch[i]);
+    }
+  }
+  encoder.Close();
+}
+
+void ConvertCompactToRaw(const std::string& compactPath, const std::string& rawPath) {
+  EventDecoder decoder;
+  decoder.Open(compactPath);
+
+  FilePtr out(fopen(rawPath.c_str(), "wb"));
+  if (!out) {
+    throw std::runtime_error("Cannot open event log: " + rawPath);
+  }
+  setvbuf(out.get(), nullptr, _IOFBF, 1 << 18);
+
+  // 解码或写入失败时不留下截断的日志
+  try {
+    EventLogHeader header{};
+    memcpy(header.magic, kEventLogMagic, sizeof(header.magic));
+    header.version = kEventLogVersion;
+    header.recordSize = sizeof(InputEvent);
+    header.startEpochUs = decoder.StartEpochUs();
+    if (fwrite(&header, sizeof(header), 1, out.get()) != 1) {
+      throw std::runtime_error("Failed to write event log: " + rawPath);
+    }
+
+    InputEvent event{};
+    while (decoder.Next(event)) {
+      if (fwrite(&event, sizeof(event), 1, out.get()) != 1) {
+        throw std::runtime_error("Failed to write event log: " + rawPath);
+      }
+    }
+    if (fclose(out.release()) != 0) {
+      throw std::runtime_error("Failed to write event log: " + rawPath);
+    }
+  } catch (...) {
+    out.reset();
+    RemovePartialOutput(rawPath);
+    throw;
+  }
+}
+
+void ConvertCompactToJson(const std::string& compactPath, const std::string& jsonPath) {
+  EventDecoder decoder;
+  decoder.Open(compactPath);
+
+  std::ofstream out(jsonPath);
+  if (!out) {
+    throw std::runtime_error("Cannot open JSON file: " + jsonPath);
+  }
+
+  try {
+    out << "{\"startEpochUs\":" << decoder.StartEpochUs() << ",\"events\":[";
+    InputEvent event{};
+    bool first = true;
+    while (decoder.Next(event)) {
+      out << (first ? "\n" : ",\n");
+      first = false;
+      out << "{\"t\":" << event.timeUs << ",\"type\":\"" << TypeToString(event.type) << "\"";
+      if (TypeCarriesCode(event.type)) {
+        out << ",\"code\":" << event.code;
+      }
+      out << ",\"x\":" << event.x << ",\"y\":" << event.y << "}";
+    }
+    out << "\n]}\n";
+    out.close();
+    if (!out) {
+      throw std::runtime_error("Failed to write JSON file: " + jsonPath);
+    }
+  } catch (...) {
+    out.close();
+    RemovePartialOutput(jsonPath);
+    throw;
+  }
+}
+
+void ConvertJsonToCompact(const std::string& jsonPath, const std::string& compactPath) {
+  std::ifstream in(jsonPath);
+  if (!in) {
+    throw std::runtime_error("Cannot open JSON file: " + jsonPath);
+  }
+  std::stringstream buffer;
+  buffer << in.rdbuf();
+  const std::string text = buffer.str();
+
+  // 键的顺序不固定（startEpochUs可能在events之后），先读完整个文档再编码
+  JsonReader reader(text, jsonPath);
+  uint64_t startEpochUs = 0;
+  std::vector<InputEvent> events;
+  bool hasEvents = false;
+  reader.Expect('{');
+  bool first = true;
+  std::string key;
+  while (reader.NextKey(first, key)) {
+    if (key == "startEpochUs") {
+      startEpochUs = static_cast<uint64_t>(reader.ReadInt());
+    } else if (key == "events") {
+      hasEvents = true;
+      reader.Expect('[');
+      if (!reader.Consume(']')) {
+        do {
+          events.push_back(ReadJsonEvent(reader));
+        } while (reader.Consume(','));
+        reader.Expect(']');
+      }
+    } else {
+      reader.SkipValue();
+    }
+  }
+  if (!hasEvents) {
+    throw std::runtime_error("JSON event log has no \"events\" array: " + jsonPath);
+  }
+
+  EventEncoder encoder;
+  encoder.Open(compactPath, startEpochUs);
+  for (const InputEvent& event : events) {
+    encoder.Write(event);
+  }
+  encoder.Close();
+}
+
+}  // namespace Robot
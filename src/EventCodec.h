@@ -0,0 +1,122 @@
+#pragma once
+
+#include "./InputEvent.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace Robot {
+
+// 紧凑事件文件格式（.agz）
+//
+//   文件头: CompactLogHeader
+//   之后为若干数据块，每块:
+//     CompactBlockHeader { eventCount, payloadSize, crc32(payload) }
+//     payload: eventCount条变长编码的事件
+//
+// 每条事件编码为:
+//   tag (1字节): 低3位为InputEventType，bit3表示携带坐标增量，bit4表示携带code
+//   zigzag varint: 与上一事件的时间差（微秒）
+//   [zigzag varint dx, zigzag varint dy]  坐标相对上一事件的增量
+//   [varint code]
+//
+// 增量状态在每个块开头清零，因此每个块可以独立解码与校验。
+// 以鼠标移动为主的录制中，单条事件通常只占4~6字节（原始格式为16字节）。
+struct CompactLogHeader {
+  char magic[8];          // "AGUIEVZ1"
+  uint32_t version;       // 当前为1
+  uint32_t reserved;
+  uint64_t startEpochUs;  // 录制开始时的系统时间（微秒，Unix纪元）
+};
+
+struct CompactBlockHeader {
+  uint32_t eventCount;
+  uint32_t payloadSize;
+  uint32_t crc32;
+};
+
+static_assert(sizeof(CompactLogHeader) == 24, "CompactLogHeader must stay 24 bytes");
+static_assert(sizeof(CompactBlockHeader) == 12, "CompactBlockHeader must stay 12 bytes");
+
+constexpr char kCompactLogMagic[8] = {'A', 'G', 'U', 'I', 'E', 'V', 'Z', '1'};
+constexpr uint32_t kCompactLogVersion = 1;
+
+// CRC-32 (IEEE 802.3)
+uint32_t Crc32(const uint8_t* data, size_t size, uint32_t crc = 0);
+
+// 流式编码器：逐条写入事件，内部攒满一个块后整体写出
+class EventEncoder {
+ public:
+  static constexpr uint32_t kMaxBlockEvents = 4096;
+
+  EventEncoder() = default;
+  ~EventEncoder();
+
+  EventEncoder(const EventEncoder&) = delete;
+  EventEncoder& operator=(const EventEncoder&) = delete;
+
+  void Open(const std::string& path, uint64_t startEpochUs);
+  // 未Open或写入失败时抛出std::runtime_error
+  void Write(const InputEvent& event);
+  // 写出最后一个未满的块并关闭文件；写入失败时文件仍会关闭，随后抛出std::runtime_error
+  void Close();
+
+  uint64_t EventsWritten() const { return eventsWritten; }
+  uint64_t BytesWritten() const { return bytesWritten; }
+
+ private:
+  void FlushBlock();
+
+  FILE* file = nullptr;
+  std::vector<uint8_t> payload;
+  uint32_t blockEvents = 0;
+  InputEvent previous{};
+  uint64_t eventsWritten = 0;
+  uint64_t bytesWritten = 0;
+};
+
+// 流式解码器：逐块读取并校验，逐条返回事件；校验失败抛出std::runtime_error
+class EventDecoder {
+ public:
+  EventDecoder() = default;
+  ~EventDecoder();
+
+  EventDecoder(const EventDecoder&) = delete;
+  EventDecoder& operator=(const EventDecoder&) = delete;
+
+  void Open(const std::string& path);
+  // 读取下一条事件，文件结束时返回false
+  bool Next(InputEvent& event);
+  void Close();
+
+  uint64_t StartEpochUs() const { return startEpochUs; }
+
+ private:
+  bool LoadBlock();
+
+  FILE* file = nullptr;
+  uint64_t startEpochUs = 0;
+  std::vector<uint8_t> payload;
+  size_t offset = 0;
+  uint32_t remaining = 0;
+  InputEvent previous{};
+};
+
+// 格式转换
+// 原始日志（Recorder输出，Replayer输入）<-> 紧凑格式
+// 读写或校验失败时抛出std::runtime_error，写了一半的输出文件被删除
+void ConvertRawToCompact(const std::string& rawPath, const std::string& compactPath);
+void ConvertCompactToRaw(const std::string& compactPath, const std::string& rawPath);
+
+// 紧凑格式 <-> 人类可读的JSON，每行一个事件:
+// {"startEpochUs":0,"events":[
+// {"t":1000,"type":"motion","x":10,"y":20},
+// {"t":2000,"type":"key_down","code":38,"x":10,"y":20}
+// ]}
+// 读取JSON时按对象结构解析键，键的顺序任意，未知的键被忽略
+void ConvertCompactToJson(const std::string& compactPath, const std::string& jsonPath);
+void ConvertJsonToCompact(const std::string& jsonPath, const std::string& compactPath);
+
+}  // namespace Robot
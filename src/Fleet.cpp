@@ -0,0 +1,291 @@
+#include "Fleet.h"
+
+#ifdef __linux__
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/prctl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace AutoGUI {
+
+Fleet::Fleet(const FleetOptions &options) : started(std::chrono::steady_clock::now()) {
+  if (options.spawn <= 0 && options.attach.empty()) {
+    throw AutoGUIException("Fleet needs at least one display");
+  }
+  try {
+    std::vector<std::string> names = options.attach;
+    for (int i = 0; i < options.spawn; i++) {
+      names.push_back(spawnXvfb(options));
+    }
+    for (const auto &name : names) {
+      auto worker = std::make_unique<Worker>();
+      worker->session = std::make_unique<Session>(name);
+      workers.push_back(std::move(worker));
+    }
+  } catch (...) {
+    workers.clear();
+    stopXvfb();
+    throw;
+  }
+  // 所有会话就绪后再启动线程，构造失败时无需回收线程
+  for (size_t i = 0; i < workers.size(); i++) {
+    workers[i]->thread = std::thread(&Fleet::workerLoop, this, i);
+  }
+}
+
+Fleet::~Fleet() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  wake.notify_all();
+  for (auto &worker : workers) {
+    worker->thread.join();
+  }
+  // 先断开连接再终止Xvfb
+  workers.clear();
+  stopXvfb();
+}
+
+const std::string &Fleet::displayName(size_t display) const {
+  if (display >= workers.size()) {
+    throw AutoGUIException("Fleet display index out of range: " + std::to_string(display));
+  }
+  return workers[display]->session->displayName();
+}
+
+std::future<void> Fleet::submit(Job job) {
+  const size_t display = nextDisplay.fetch_add(1, std::memory_order_relaxed) % workers.size();
+  return enqueue(display, std::move(job), false);
+}
+
+std::future<void> Fleet::submitTo(size_t display, Job job) {
+  if (display >= workers.size()) {
+    throw AutoGUIException("Fleet display index out of range: " + std::to_string(display));
+  }
+  return enqueue(display, std::move(job), true);
+}
+
+std::future<void> Fleet::enqueue(size_t display, Job job, bool pinned) {
+  auto promise = std::make_shared<std::promise<void>>();
+  std::future<void> result = promise->get_future();
+  Task task = [promise, job = std::move(job)](Session &session) {
+    try {
+      job(session);
+      promise->set_value();
+      return true;
+    } catch (...) {
+      promise->set_exception(std::current_exception());
+      return false;
+    }
+  };
+
+  Worker &worker = *workers[display];
+  // 先计数再入队：工作线程取到任务时计数一定已经包含它
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    outstanding++;
+    if (pinned) {
+      worker.pinnedPending.fetch_add(1, std::memory_order_relaxed);
+    } else {
+      sharedPending.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+  {
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    (pinned ? worker.pinned : worker.shared).push_back(std::move(task));
+  }
+  wake.notify_all();
+  return result;
+}
+
+bool Fleet::takeTask(size_t index, Task &task, bool &stolen) {
+  Worker &own = *workers[index];
+  {
+    std::lock_guard<std::mutex> lock(own.mutex);
+    if (!own.pinned.empty()) {
+      task = std::move(own.pinned.front());
+      own.pinned.pop_front();
+      own.pinnedPending.fetch_sub(1, std::memory_order_relaxed);
+      return true;
+    }
+    if (!own.shared.empty()) {
+      task = std::move(own.shared.front());
+      own.shared.pop_front();
+      sharedPending.fetch_sub(1, std::memory_order_relaxed);
+      return true;
+    }
+  }
+  // 自己的队列为空：从其他队列尾部窃取，与队列主人从头部取互不干扰
+  for (size_t offset = 1; offset < workers.size(); offset++) {
+    Worker &victim = *workers[(index + offset) % workers.size()];
+    std::lock_guard<std::mutex> lock(victim.mutex);
+    if (!victim.shared.empty()) {
+      task = std::move(victim.shared.back());
+      victim.shared.pop_back();
+      sharedPending.fetch_sub(1, std::memory_order_relaxed);
+      stolen = true;
+      return true;
+    }
+  }
+  return false;
+}
+
+void Fleet::workerLoop(size_t index) {
+  Worker &worker = *workers[index];
+  while (true) {
+    Task task;
+    bool stolen = false;
+    if (!takeTask(index, task, stolen)) {
+      std::unique_lock<std::mutex> lock(mutex);
+      const auto hasWork = [&] {
+        return sharedPending.load(std::memory_order_relaxed) > 0 ||
+               worker.pinnedPending.load(std::memory_order_relaxed) > 0;
+      };
+      wake.wait(lock, [&] { return stopping || hasWork(); });
+      if (stopping && !hasWork()) {
+        return;
+      }
+      continue;
+    }
+
+    const auto begin = std::chrono::steady_clock::now();
+    const bool succeeded = task(*worker.session);
+    if (!succeeded) {
+      // 任务中途失败时可能留下按下的键或按钮，避免影响同一显示器上的下一个任务；
+      // 释放本身也可能失败（uinput后端写入出错时抛出），异常逃出线程函数会终止整个进程，只记录次数
+      try {
+        worker.session->releaseAll();
+      } catch (const std::exception &) {
+        worker.releaseFailures.fetch_add(1, std::memory_order_relaxed);
+      }
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - begin;
+    worker.busyNanoseconds.fetch_add(
+        static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()),
+        std::memory_order_relaxed);
+    (succeeded ? worker.completed : worker.failed).fetch_add(1, std::memory_order_relaxed);
+    if (stolen) {
+      worker.stolen.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (--outstanding == 0) {
+      idle.notify_all();
+    }
+  }
+}
+
+void Fleet::wait() {
+  std::unique_lock<std::mutex> lock(mutex);
+  idle.wait(lock, [this] { return outstanding == 0; });
+}
+
+std::vector<DisplayStats> Fleet::stats() const {
+  const double uptime = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+  std::vector<DisplayStats> result;
+  result.reserve(workers.size());
+  for (const auto &worker : workers) {
+    DisplayStats stats;
+    stats.display = worker->session->displayName();
+    stats.completed = worker->completed.load(std::memory_order_relaxed);
+    stats.failed = worker->failed.load(std::memory_order_relaxed);
+    stats.stolen = worker->stolen.load(std::memory_order_relaxed);
+    stats.releaseFailures = worker->releaseFailures.load(std::memory_order_relaxed);
+    stats.busySeconds = static_cast<double>(worker->busyNanoseconds.load(std::memory_order_relaxed)) / 1e9;
+    if (uptime > 0) {
+      stats.jobsPerSecond = static_cast<double>(stats.completed + stats.failed) / uptime;
+      stats.utilization = stats.busySeconds / uptime;
+    }
+    result.push_back(stats);
+  }
+  return result;
+}
+
+#ifdef __linux__
+
+std::string Fleet::spawnXvfb(const FleetOptions &options) {
+  int fds[2];
+  if (pipe2(fds, O_CLOEXEC) != 0) {
+    throw AutoGUIException("Cannot create pipe for Xvfb");
+  }
+
+  // 参数在fork前准备好，子进程中只调用异步信号安全的函数
+  std::vector<std::string> args = {options.xvfbPath, "-displayfd", std::to_string(fds[1]),
+                                   "-screen", "0", options.screen, "-nolisten", "tcp"};
+  args.insert(args.end(), options.extraArgs.begin(), options.extraArgs.end());
+  std::vector<char *> argv;
+  for (auto &arg : args) {
+    argv.push_back(arg.data());
+  }
+  argv.push_back(nullptr);
+
+  const pid_t pid = fork();
+  if (pid < 0) {
+    close(fds[0]);
+    close(fds[1]);
+    throw AutoGUIException("Cannot fork Xvfb");
+  }
+  if (pid == 0) {
+    prctl(PR_SET_PDEATHSIG, SIGTERM);
+    fcntl(fds[1], F_SETFD, 0);
+    execvp(argv[0], argv.data());
+    _exit(127);
+  }
+  close(fds[1]);
+  xvfbPids.push_back(pid);
+
+  // Xvfb准备好接受连接后把选中的显示器号写入displayfd
+  std::string number;
+  const auto deadline = std::chrono::steady_clock::now() +
+                        std::chrono::milliseconds(static_cast<int>(options.startupTimeout * 1000));
+  while (number.empty() || number.back() != '\n') {
+    const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+        deadline - std::chrono::steady_clock::now()).count();
+    if (remaining <= 0) {
+      close(fds[0]);
+      throw AutoGUIException("Timed out waiting for Xvfb to start");
+    }
+    pollfd descriptor{fds[0], POLLIN, 0};
+    const int ready = poll(&descriptor, 1, static_cast<int>(remaining));
+    if (ready < 0 && errno == EINTR) {
+      continue;
+    }
+    char buffer[16];
+    const ssize_t count = ready > 0 ? read(fds[0], buffer, sizeof(buffer)) : 0;
+    if (ready > 0 && count <= 0) {
+      close(fds[0]);
+      throw AutoGUIException("Xvfb exited before becoming ready (" + options.xvfbPath + ")");
+    }
+    number.append(buffer, static_cast<size_t>(std::max<ssize_t>(count, 0)));
+  }
+  close(fds[0]);
+  number.pop_back();
+  return ":" + number;
+}
+
+void Fleet::stopXvfb() {
+  for (const int pid : xvfbPids) {
+    kill(pid, SIGTERM);
+  }
+  for (const int pid : xvfbPids) {
+    waitpid(pid, nullptr, 0);
+  }
+  xvfbPids.clear();
+}
+
+#else
+
+std::string Fleet::spawnXvfb(const FleetOptions &) {
+  throw AutoGUIException("Xvfb displays are only supported on Linux");
+}
+
+void Fleet::stopXvfb() {}
+
+#endif
+
+} // namespace AutoGUI
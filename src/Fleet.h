@@ -0,0 +1,116 @@
+#pragma once
+
+#include "Autogui.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace AutoGUI {
+
+// 显示器池配置
+struct FleetOptions {
+    int spawn = 0;                         // 启动的Xvfb数量
+    std::string screen = "1920x1080x24";   // Xvfb的-screen 0参数
+    std::string xvfbPath = "Xvfb";         // 可执行文件，按PATH查找
+    std::vector<std::string> extraArgs;    // 追加给Xvfb的参数
+    std::vector<std::string> attach;       // 直接连接的已有显示器，如":1"
+    double startupTimeout = 10.0;          // 等待每个Xvfb就绪的秒数
+};
+
+// 单个显示器的吞吐统计
+struct DisplayStats {
+    std::string display;
+    uint64_t completed = 0;     // 成功完成的任务
+    uint64_t failed = 0;        // 抛出异常的任务
+    uint64_t stolen = 0;        // 从其他显示器队列窃取执行的任务
+    uint64_t releaseFailures = 0; // 任务失败后释放按键/按钮时出错的次数（如uinput写入失败）
+    double busySeconds = 0.0;   // 执行任务的累计时间
+    double jobsPerSecond = 0.0; // (completed + failed) / 自构造以来的时间
+    double utilization = 0.0;   // busySeconds / 自构造以来的时间
+};
+
+/**
+ * @brief 在一组显示器上并行执行自动化任务
+ * @note 每个显示器一个工作线程和一个Session，任务只通过参数中的Session操作对应显示器。
+ *       submit的任务轮流放入各显示器的队列，空闲的工作线程会从其他队列尾部窃取；
+ *       submitTo的任务固定在指定显示器上执行，不会被窃取。
+ *       启动的Xvfb使用-displayfd自动选择空闲显示器号，析构时终止；Xvfb绑定到构造Fleet的线程
+ *       （PR_SET_PDEATHSIG），该线程或进程意外退出时Xvfb也会随之退出，因此该线程需存活到Fleet析构。
+ *       任务抛出异常时通过返回的future传递，并释放该会话中仍按下的键与按钮
+ */
+class Fleet {
+public:
+    using Job = std::function<void(Session&)>;
+
+    /**
+     * @throws AutoGUIException Xvfb无法启动、超时未就绪或显示器无法连接时
+     */
+    explicit Fleet(const FleetOptions& options);
+
+    // 等待已提交的任务执行完毕后停止
+    ~Fleet();
+
+    Fleet(const Fleet&) = delete;
+    Fleet& operator=(const Fleet&) = delete;
+
+    std::future<void> submit(Job job);
+    std::future<void> submitTo(size_t display, Job job);
+
+    // 阻塞到所有已提交的任务执行完毕
+    void wait();
+
+    [[nodiscard]] size_t size() const { return workers.size(); }
+    [[nodiscard]] const std::string& displayName(size_t display) const;
+
+    std::vector<DisplayStats> stats() const;
+
+private:
+    // 返回false表示任务抛出了异常（异常已交给future）
+    using Task = std::function<bool(Session&)>;
+
+    struct Worker {
+        std::unique_ptr<Session> session;
+        std::thread thread;
+        std::mutex mutex;
+        std::deque<Task> shared;  // 可被其他工作线程窃取
+        std::deque<Task> pinned;  // 只由本线程执行
+        std::atomic<size_t> pinnedPending{0};
+        std::atomic<uint64_t> completed{0};
+        std::atomic<uint64_t> failed{0};
+        std::atomic<uint64_t> stolen{0};
+        std::atomic<uint64_t> releaseFailures{0};
+        std::atomic<uint64_t> busyNanoseconds{0};
+    };
+
+    // 启动一个Xvfb并返回其显示器名
+    std::string spawnXvfb(const FleetOptions& options);
+    void stopXvfb();
+    void workerLoop(size_t index);
+    bool takeTask(size_t index, Task& task, bool& stolen);
+    std::future<void> enqueue(size_t display, Job job, bool pinned);
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<int> xvfbPids;
+    std::atomic<size_t> nextDisplay{0};
+    std::chrono::steady_clock::time_point started;
+
+    // sharedPending与outstanding在mutex下增加，保证等待方不会错过唤醒
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable idle;
+    std::atomic<size_t> sharedPending{0};
+    size_t outstanding = 0;
+    bool stopping = false;
+};
+
+} // namespace AutoGUI
@@ -0,0 +1,113 @@
+#include "./FrameDiff.h"
+
+#include "./Simd.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace Robot {
+
+FrameDiff::FrameDiff(ThreadPool& pool) : pool(pool) {}
+
+FrameDiffResult FrameDiff::Compare(const ImageView& before, const ImageView& after, uint8_t tolerance) {
+  if (before.width != after.width || before.height != after.height) {
+    throw std::invalid_argument("FrameDiff: frame sizes differ");
+  }
+  FrameDiffResult result;
+  if (before.Empty() || after.Empty()) {
+    return result;
+  }
+
+  const int width = before.width;
+  const int height = before.height;
+  const int columns = (width + kCellSize - 1) / kCellSize;
+  const int rows = (height + kCellSize - 1) / kCellSize;
+  cells.assign(static_cast<size_t>(columns) * rows, Cell{INT32_MAX, INT32_MAX, -1, -1, 0});
+
+  // 每个任务处理一行单元格，只写自己的单元格，无需同步
+  pool.ParallelFor(0, rows, [&](int cellRow) {
+    Cell* rowCells = cells.data() + static_cast<size_t>(cellRow) * columns;
+    const int y0 = cellRow * kCellSize;
+    const int y1 = std::min(height, y0 + kCellSize);
+    for (int y = y0; y < y1; y++) {
+      const uint8_t* a = before.Row(y);
+      const uint8_t* b = after.Row(y);
+      for (int column = 0; column < columns; column++) {
+        const int x0 = column * kCellSize;
+        const int pixels = std::min(kCellSize, width - x0);
+        const uint32_t mask = Simd::ChangedMask(a + x0 * 4, b + x0 * 4, pixels, tolerance);
+        if (mask == 0) {
+          continue;
+        }
+        Cell& cell = rowCells[column];
+        cell.count += static_cast<uint32_t>(Simd::PopCount(mask));
+        cell.minX = std::min(cell.minX, x0 + Simd::LowestBit(mask));
+        cell.maxX = std::max(cell.maxX, x0 + Simd::HighestBit(mask));
+        cell.minY = std::min(cell.minY, y);
+        cell.maxY = y;
+      }
+    }
+  });
+
+  // 变化单元格按8邻接连通，取每个连通块内变化像素的外接矩形
+  std::vector<int> stack;
+  std::vector<uint8_t> visited(cells.size(), 0);
+  for (size_t start = 0; start < cells.size(); start++) {
+    if (cells[start].count == 0 || visited[start]) {
+      continue;
+    }
+    Cell bounds = cells[start];
+    visited[start] = 1;
+    stack.assign(1, static_cast<int>(start));
+    while (!stack.empty()) {
+      const int index = stack.back();
+      stack.pop_back();
+      const Cell& cell = cells[index];
+      bounds.minX = std::min(bounds.minX, cell.minX);
+      bounds.minY = std::min(bounds.minY, cell.minY);
+      bounds.maxX = std::max(bounds.maxX, cell.maxX);
+      bounds.maxY = std::max(bounds.maxY, cell.maxY);
+      result.changedPixels += cell.count;
+
+      const int cx = index % columns;
+      const int cy = index / columns;
+      for (int ny = std::max(0, cy - 1); ny <= std::min(rows - 1, cy + 1); ny++) {
+        for (int nx = std::max(0, cx - 1); nx <= std::min(columns - 1, cx + 1); nx++) {
+          const int neighbor = ny * columns + nx;
+          if (cells[neighbor].count != 0 && !visited[neighbor]) {
+            visited[neighbor] = 1;
+            stack.push_back(neighbor);
+          }
+        }
+      }
+    }
+    result.rects.push_back(
+        {bounds.minX, bounds.minY, bounds.maxX - bounds.minX + 1, bounds.maxY - bounds.minY + 1});
+  }
+
+  // 不同连通块的外接矩形可能相交（例如L形区域包住另一块），合并到互不相交为止
+  bool merged = true;
+  while (merged) {
+    merged = false;
+    for (size_t i = 0; i < result.rects.size() && !merged; i++) {
+      for (size_t j = i + 1; j < result.rects.size(); j++) {
+        const Rect& a = result.rects[i];
+        const Rect& b = result.rects[j];
+        if (!a.Intersects(b)) {
+          continue;
+        }
+        const int x1 = std::min(a.x, b.x);
+        const int y1 = std::min(a.y, b.y);
+        const int x2 = std::max(a.x + a.width, b.x + b.width);
+        const int y2 = std::max(a.y + a.height, b.y + b.height);
+        result.rects[i] = {x1, y1, x2 - x1, y2 - y1};
+        result.rects.erase(result.rects.begin() + static_cast<std::ptrdiff_t>(j));
+        merged = true;
+        break;
+      }
+    }
+  }
+  return result;
+}
+
+}  // namespace Robot
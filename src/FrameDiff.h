@@ -0,0 +1,43 @@
+#pragma once
+
+#include "./Screen.h"
+#include "./ThreadPool.h"
+#include "./types.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace Robot {
+
+struct FrameDiffResult {
+  std::vector<Rect> rects;     // 变化区域的外接矩形（已合并，互不相交）
+  uint64_t changedPixels = 0;  // 变化的像素数
+
+  bool Changed() const { return changedPixels != 0; }
+};
+
+// 逐帧差分
+// 两帧按kCellSize见方的单元格划分，单元格行带交给线程池，每行每个单元格调用一次SIMD内核（Simd::ChangedMask）。
+// 每个单元格记录变化像素的精确范围，相邻（含对角）的变化单元格连通后取外接矩形，相交的矩形再合并，
+// 因此结果矩形是像素精确的，数量与变化区域的个数相当而不是与单元格个数相当。
+class FrameDiff {
+ public:
+  static constexpr int kCellSize = 32;
+
+  explicit FrameDiff(ThreadPool& pool = ThreadPool::Default());
+
+  // before与after尺寸必须相同，否则抛出std::invalid_argument
+  // B/G/R任一通道差值超过tolerance的像素视为变化，A通道被忽略
+  FrameDiffResult Compare(const ImageView& before, const ImageView& after, uint8_t tolerance = 0);
+
+ private:
+  struct Cell {
+    int minX, minY, maxX, maxY;  // 变化像素范围（闭区间），minX > maxX表示无变化
+    uint32_t count;
+  };
+
+  ThreadPool& pool;
+  std::vector<Cell> cells;  // 复用
+};
+
+}  // namespace Robot
@@ -0,0 +1,443 @@
+#include "./HotkeyListener.h"
+#include "./XErrorTrap.h"
+
+#include <future>
+#include <iostream>
+#include <stdexcept>
+
+#ifdef __linux__
+#include <X11/keysym.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif
+
+namespace Robot {
+
+namespace {
+
+// 待分发触发事件队列容量
+constexpr size_t kTriggerQueueCapacity = 1024;
+
+int64_t SteadyNowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+}  // namespace
+
+HotkeyListener::HotkeyListener() : triggers(kTriggerQueueCapacity) {}
+
+HotkeyListener::~HotkeyListener() {
+  Stop();
+}
+
+int HotkeyListener::Register(KeyCode virtualKey, unsigned int modifiers, Callback callback) {
+  return AddEntry(virtualKey, modifiers, false, std::move(callback));
+}
+
+int HotkeyListener::Register(char asciiChar, unsigned int modifiers, Callback callback) {
+  return AddEntry(Keyboard::AsciiToVirtualKey(asciiChar), modifiers, false, std::move(callback));
+}
+
+int HotkeyListener::Register(Keyboard::SpecialKey specialKey, unsigned int modifiers,
+                             Callback callback) {
+  return AddEntry(Keyboard::SpecialKeyToVirtualKey(specialKey), modifiers, false,
+                  std::move(callback));
+}
+
+int HotkeyListener::RegisterKillSwitch(KeyCode virtualKey, unsigned int modifiers,
+                                       Callback callback) {
+  return AddEntry(virtualKey, modifiers, true, std::move(callback));
+}
+
+void HotkeyListener::SetExecutor(Executor newExecutor) {
+  std::lock_guard<std::mutex> lock(mutex);
+  executor = std::move(newExecutor);
+}
+
+HotkeyListener::LatencyStats HotkeyListener::GetLatencyStats() const {
+  LatencyStats stats{};
+  stats.dispatched = dispatched.load(std::memory_order_relaxed);
+  stats.lastUs = static_cast<double>(lastLatencyNs.load(std::memory_order_relaxed)) / 1000.0;
+  stats.maxUs = static_cast<double>(maxLatencyNs.load(std::memory_order_relaxed)) / 1000.0;
+  if (stats.dispatched > 0) {
+    stats.meanUs = static_cast<double>(totalLatencyNs.load(std::memory_order_relaxed)) /
+                   1000.0 / static_cast<double>(stats.dispatched);
+  }
+  return stats;
+}
+
+void HotkeyListener::RecordLatency(int64_t triggerNs) {
+  const int64_t latency = SteadyNowNs() - triggerNs;
+  dispatched.fetch_add(1, std::memory_order_relaxed);
+  lastLatencyNs.store(latency, std::memory_order_relaxed);
+  totalLatencyNs.fetch_add(latency, std::memory_order_relaxed);
+  int64_t currentMax = maxLatencyNs.load(std::memory_order_relaxed);
+  while (latency > currentMax &&
+         !maxLatencyNs.compare_exchange_weak(currentMax, latency, std::memory_order_relaxed)) {
+  }
+}
+
+#ifdef __linux__
+
+namespace {
+
+// 回调抛出的异常不能逃出事件/分发线程，否则整个进程会被终止
+void InvokeCallback(const HotkeyListener::Callback& callback) {
+  try {
+    callback();
+  } catch (const std::exception& e) {
+    std::cerr << "Warning: hotkey callback threw: " << e.what() << std::endl;
+  } catch (...) {
+    std::cerr << "Warning: hotkey callback threw an unknown exception" << std::endl;
+  }
+}
+
+unsigned int ModifierMaskFor(Display* display, KeySym keysym) {
+  const ::KeyCode target = XKeysymToKeycode(display, keysym);
+  if (target == 0) {
+    return 0;
+  }
+  unsigned int mask = 0;
+  XModifierKeymap* map = XGetModifierMapping(display);
+  for (int mod = 0; mod < 8; mod++) {
+    for (int k = 0; k < map->max_keypermod; k++) {
+      if (map->modifiermap[mod * map->max_keypermod + k] == target) {
+        mask = 1u << mod;
+      }
+    }
+  }
+  XFreeModifiermap(map);
+  return mask;
+}
+
+unsigned int ToX11Modifiers(unsigned int modifiers) {
+  unsigned int mask = 0;
+  if (modifiers & HotkeyListener::MOD_SHIFT) mask |= ShiftMask;
+  if (modifiers & HotkeyListener::MOD_CONTROL) mask |= ControlMask;
+  if (modifiers & HotkeyListener::MOD_ALT) mask |= Mod1Mask;
+  if (modifiers & HotkeyListener::MOD_META) mask |= Mod4Mask;
+  return mask;
+}
+
+constexpr unsigned int kRelevantModifiers = ShiftMask | ControlMask | Mod1Mask | Mod4Mask;
+
+}  // namespace
+
+struct HotkeyListener::Command {
+  int id;
+  bool grab;
+  std::promise<bool> done;
+};
+
+void HotkeyListener::Wake(int fd) {
+  const uint64_t one = 1;
+  ssize_t ignored = write(fd, &one, sizeof(one));
+  (void)ignored;
+}
+
+bool HotkeyListener::GrabAll(unsigned int keycode, unsigned int modifierMask, bool grab) {
+  // 锁定类修饰键的所有组合，保证CapsLock/NumLock打开时热键依然有效
+  const unsigned int locks[] = {LockMask, numLockMask, scrollLockMask};
+  // XGrabKey失败（组合键被其他客户端占用）时Xlib默认会直接退出进程，抓取期间在本连接上捕获错误
+  XErrorTrap trap(display);
+  for (unsigned int combo = 0; combo < 8; combo++) {
+    unsigned int extra = 0;
+    for (int bit = 0; bit < 3; bit++) {
+      if (combo & (1u << bit)) {
+        extra |= locks[bit];
+      }
+    }
+    if (grab) {
+      XGrabKey(display, static_cast<int>(keycode), modifierMask | extra, rootWindow, False,
+               GrabModeAsync, GrabModeAsync);
+    } else {
+      XUngrabKey(display, static_cast<int>(keycode), modifierMask | extra, rootWindow);
+    }
+  }
+  const bool grabFailed = trap.Sync() == BadAccess;
+
+  if (grab && grabFailed) {
+    GrabAll(keycode, modifierMask, false);
+    return false;
+  }
+  return true;
+}
+
+int HotkeyListener::AddEntry(KeyCode virtualKey, unsigned int modifiers, bool killSwitch,
+                             Callback callback) {
+  if (!IsRunning()) {
+    throw std::runtime_error("HotkeyListener must be started before registering hotkeys");
+  }
+
+  Entry entry{};
+  entry.virtualKey = virtualKey;
+  entry.modifierMask = ToX11Modifiers(modifiers);
+  entry.killSwitch = killSwitch;
+  entry.callback = std::make_shared<Callback>(std::move(callback));
+
+  int id;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    id = nextId++;
+    entries[id] = entry;
+  }
+
+  if (!SubmitCommand(id, true)) {
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.erase(id);
+    return -1;
+  }
+  return id;
+}
+
+void HotkeyListener::Unregister(int id) {
+  if (!IsRunning()) {
+    return;
+  }
+  SubmitCommand(id, false);
+  std::lock_guard<std::mutex> lock(mutex);
+  entries.erase(id);
+}
+
+bool HotkeyListener::SubmitCommand(int id, bool grab) {
+  // 紧急停止键的回调运行在事件线程上，排队等待自己处理会永久阻塞，直接执行
+  if (std::this_thread::get_id() == eventThread.get_id()) {
+    return ApplyCommand(id, grab);
+  }
+  // Xlib连接不是线程安全的，键码解析与抓取都交给事件线程完成
+  Command command{id, grab, {}};
+  std::future<bool> result = command.done.get_future();
+  {
+    // 与Stop()清除running在同一把锁下检查，Stop()排空队列之后不会再有命令入队
+    std::lock_guard<std::mutex> lock(commandMutex);
+    if (!running.load(std::memory_order_acquire)) {
+      return false;
+    }
+    pendingCommands.push_back(&command);
+  }
+  Wake(commandFd);
+  return result.get();
+}
+
+bool HotkeyListener::ApplyCommand(int id, bool grab) {
+  Entry entry{};
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find(id);
+    if (it == entries.end()) {
+      return false;
+    }
+    entry = it->second;
+  }
+  entry.keycode = XKeysymToKeycode(display, entry.virtualKey);
+  const bool ok = entry.keycode != 0 && GrabAll(entry.keycode, entry.modifierMask, grab);
+  if (grab && ok) {
+    active.emplace_back(id, entry);
+  } else if (!grab) {
+    for (auto it = active.begin(); it != active.end(); ++it) {
+      if (it->first == id) {
+        active.erase(it);
+        break;
+      }
+    }
+  }
+  return ok;
+}
+
+void HotkeyListener::Start() {
+  if (IsRunning()) {
+    return;
+  }
+  display = XOpenDisplay(nullptr);
+  if (display == nullptr) {
+    throw std::runtime_error("Cannot open X11 display");
+  }
+  rootWindow = DefaultRootWindow(display);
+  numLockMask = ModifierMaskFor(display, XK_Num_Lock);
+  scrollLockMask = ModifierMaskFor(display, XK_Scroll_Lock);
+
+  commandFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  dispatchFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (commandFd < 0 || dispatchFd < 0) {
+    XCloseDisplay(display);
+    display = nullptr;
+    throw std::runtime_error("Cannot create eventfd for HotkeyListener");
+  }
+
+  running.store(true, std::memory_order_release);
+  eventThread = std::thread(&HotkeyListener::EventThread, this);
+  dispatchThread = std::thread(&HotkeyListener::DispatchThread, this);
+}
+
+void HotkeyListener::Stop() {
+  if (!IsRunning()) {
+    return;
+  }
+  const std::thread::id self = std::this_thread::get_id();
+  if (self == eventThread.get_id() || self == dispatchThread.get_id()) {
+    throw std::runtime_error("HotkeyListener::Stop cannot be called from a hotkey callback");
+  }
+  {
+    std::lock_guard<std::mutex> lock(commandMutex);
+    running.store(false, std::memory_order_release);
+  }
+  Wake(commandFd);
+  if (eventThread.joinable()) {
+    eventThread.join();
+  }
+  Wake(dispatchFd);
+  if (dispatchThread.joinable()) {
+    dispatchThread.join();
+  }
+
+  {
+    // 事件线程退出后仍未处理的命令直接判定失败，避免调用方永久等待
+    std::lock_guard<std::mutex> lock(commandMutex);
+    for (Command* command : pendingCommands) {
+      command->done.set_value(false);
+    }
+    pendingCommands.clear();
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.clear();
+  }
+  XCloseDisplay(display);
+  display = nullptr;
+  close(commandFd);
+  close(dispatchFd);
+  commandFd = dispatchFd = -1;
+}
+
+void HotkeyListener::EventThread() {
+  pollfd fds[2];
+  fds[0].fd = ConnectionNumber(display);
+  fds[0].events = POLLIN;
+  fds[1].fd = commandFd;
+  fds[1].events = POLLIN;
+
+  while (running.load(std::memory_order_acquire)) {
+    while (XPending(display) > 0) {
+      XEvent event;
+      XNextEvent(display, &event);
+      if (event.type != KeyPress) {
+        continue;
+      }
+      const int64_t now = SteadyNowNs();
+      const unsigned int state = event.xkey.state & kRelevantModifiers;
+      std::shared_ptr<Callback> killSwitch;
+      for (const auto& item : active) {
+        if (item.second.keycode != event.xkey.keycode || item.second.modifierMask != state) {
+          continue;
+        }
+        if (item.second.killSwitch) {
+          killSwitch = item.second.callback;
+        } else if (triggers.Push({item.first, now})) {
+          Wake(dispatchFd);
+        }
+        break;
+      }
+      // 回调可能注册或注销热键而修改active，因此在遍历结束后执行
+      if (killSwitch) {
+        RecordLatency(now);
+        InvokeCallback(*killSwitch);
+      }
+    }
+
+    poll(fds, 2, -1);
+
+    if (fds[1].revents & POLLIN) {
+      uint64_t value;
+      ssize_t ignored = read(commandFd, &value, sizeof(value));
+      (void)ignored;
+
+      std::vector<Command*> commands;
+      {
+        std::lock_guard<std::mutex> lock(commandMutex);
+        commands.swap(pendingCommands);
+      }
+      for (Command* command : commands) {
+        command->done.set_value(ApplyCommand(command->id, command->grab));
+      }
+    }
+  }
+
+  for (const auto& item : active) {
+    GrabAll(item.second.keycode, item.second.modifierMask, false);
+  }
+  active.clear();
+}
+
+void HotkeyListener::DispatchThread() {
+  pollfd fd{};
+  fd.fd = dispatchFd;
+  fd.events = POLLIN;
+
+  while (true) {
+    poll(&fd, 1, -1);
+    uint64_t value;
+    ssize_t ignored = read(dispatchFd, &value, sizeof(value));
+    (void)ignored;
+
+    Trigger trigger{};
+    while (triggers.Pop(trigger)) {
+      std::shared_ptr<Callback> callback;
+      Executor currentExecutor;
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = entries.find(trigger.id);
+        if (it == entries.end()) {
+          continue;
+        }
+        callback = it->second.callback;
+        currentExecutor = executor;
+      }
+
+      const int64_t triggerNs = trigger.triggerNs;
+      auto task = [this, callback, triggerNs]() {
+        RecordLatency(triggerNs);
+        InvokeCallback(*callback);
+      };
+      if (currentExecutor) {
+        currentExecutor(std::move(task));
+      } else {
+        task();
+      }
+    }
+
+    if (!running.load(std::memory_order_acquire)) {
+      break;
+    }
+  }
+}
+
+#else
+
+void HotkeyListener::Start() {
+  throw std::runtime_error("HotkeyListener is only supported on Linux X11");
+}
+
+void HotkeyListener::Stop() {}
+
+int HotkeyListener::AddEntry(KeyCode, unsigned int, bool, Callback) {
+  throw std::runtime_error("HotkeyListener is only supported on Linux X11");
+}
+
+void HotkeyListener::Unregister(int) {}
+
+bool HotkeyListener::SubmitCommand(int, bool) { return false; }
+
+bool HotkeyListener::ApplyCommand(int, bool) { return false; }
+
+void HotkeyListener::EventThread() {}
+
+void HotkeyListener::DispatchThread() {}
+
+void HotkeyListener::Wake(int) {}
+
+#endif
+
+}  // namespace Robot
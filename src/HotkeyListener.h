@@ -0,0 +1,133 @@
+#pragma once
+
+#include "./Keyboard.h"
+#include "./RingBuffer.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <X11/Xlib.h>
+#endif
+
+namespace Robot {
+
+// 全局热键监听器
+// 一个事件线程通过XGrabKey独占注册的组合键（自动覆盖CapsLock/NumLock/ScrollLock的所有组合），
+// 触发时只记录时间戳并压入无锁队列；分发线程取出后交给执行器（默认在分发线程上直接执行）。
+// 紧急停止键（kill switch）不经过队列，直接在事件线程上执行，保证最低延迟。
+// 注意：若组合键已被其他程序占用，注册会失败并返回-1。
+class HotkeyListener {
+ public:
+  using Callback = std::function<void()>;
+  // 执行器：接收一个待执行的任务，可以转交给线程池等
+  using Executor = std::function<void(std::function<void()>)>;
+
+  enum Modifier : unsigned int {
+    MOD_NONE = 0,
+    MOD_SHIFT = 1 << 0,
+    MOD_CONTROL = 1 << 1,
+    MOD_ALT = 1 << 2,
+    MOD_META = 1 << 3
+  };
+
+  // 触发（事件线程读到按键）到回调开始执行之间的延迟
+  struct LatencyStats {
+    uint64_t dispatched;  // 已执行的回调数
+    double lastUs;
+    double meanUs;
+    double maxUs;
+  };
+
+  HotkeyListener();
+  ~HotkeyListener();
+
+  HotkeyListener(const HotkeyListener&) = delete;
+  HotkeyListener& operator=(const HotkeyListener&) = delete;
+
+  void Start();
+  // 不能在热键回调中调用（事件线程与分发线程无法等待自身结束），此时抛出std::runtime_error
+  void Stop();
+  bool IsRunning() const { return running.load(std::memory_order_acquire); }
+
+  // 注册热键，返回热键ID，失败返回-1；需在Start()之后调用
+  // 可以在热键回调（包括紧急停止键）中注册与注销，事件线程上的调用直接在该线程完成抓取
+  int Register(KeyCode virtualKey, unsigned int modifiers, Callback callback);
+  int Register(char asciiChar, unsigned int modifiers, Callback callback);
+  int Register(Keyboard::SpecialKey specialKey, unsigned int modifiers, Callback callback);
+
+  // 注册紧急停止键，回调直接在事件线程上执行，应尽量简短
+  int RegisterKillSwitch(KeyCode virtualKey, unsigned int modifiers, Callback callback);
+
+  void Unregister(int id);
+
+  // 设置执行器，为空时恢复为在分发线程上直接执行
+  void SetExecutor(Executor executor);
+
+  LatencyStats GetLatencyStats() const;
+
+ private:
+  struct Entry {
+    KeyCode virtualKey;
+    unsigned int keycode;  // 由事件线程在抓取时解析
+    unsigned int modifierMask;
+    bool killSwitch;
+    std::shared_ptr<Callback> callback;
+  };
+
+  struct Trigger {
+    int id;
+    int64_t triggerNs;  // steady_clock时间戳
+  };
+
+  int AddEntry(KeyCode virtualKey, unsigned int modifiers, bool killSwitch, Callback callback);
+  void EventThread();
+  void DispatchThread();
+  bool SubmitCommand(int id, bool grab);
+  // 在事件线程上执行一条注册/注销命令
+  bool ApplyCommand(int id, bool grab);
+  void Wake(int fd);
+  void RecordLatency(int64_t triggerNs);
+
+  std::atomic<bool> running{false};
+  std::thread eventThread;
+  std::thread dispatchThread;
+
+  mutable std::mutex mutex;  // 保护entries与executor，不在事件到达的热路径上长时间持有
+  std::map<int, Entry> entries;
+  Executor executor;
+  int nextId = 1;
+
+  // 事件线程待处理的注册/注销命令，定义见实现文件
+  struct Command;
+  std::mutex commandMutex;  // 同时保护running的清除，Stop()之后不会再有命令入队
+  std::vector<Command*> pendingCommands;
+
+  SpscRingBuffer<Trigger> triggers;
+
+  std::atomic<uint64_t> dispatched{0};
+  std::atomic<int64_t> lastLatencyNs{0};
+  std::atomic<int64_t> totalLatencyNs{0};
+  std::atomic<int64_t> maxLatencyNs{0};
+
+#ifdef __linux__
+  bool GrabAll(unsigned int keycode, unsigned int modifierMask, bool grab);
+
+  Display* display = nullptr;
+  Window rootWindow = 0;
+  std::vector<std::pair<int, Entry>> active;  // 已抓取的热键，只由事件线程访问
+  unsigned int numLockMask = 0;
+  unsigned int scrollLockMask = 0;
+  int commandFd = -1;   // 唤醒事件线程（注册/注销/停止）
+  int dispatchFd = -1;  // 唤醒分发线程
+#endif
+};
+
+}  // namespace Robot
@@ -0,0 +1,214 @@
+#include "./Image.h"
+
+#include "./Simd.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+
+namespace Robot {
+
+namespace {
+
+// BMP文件按小端存储
+uint32_t ReadLe32(const uint8_t* p) {
+  return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+         (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+uint16_t ReadLe16(const uint8_t* p) {
+  return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+void WriteLe32(uint8_t* p, uint32_t value) {
+  p[0] = static_cast<uint8_t>(value);
+  p[1] = static_cast<uint8_t>(value >> 8);
+  p[2] = static_cast<uint8_t>(value >> 16);
+  p[3] = static_cast<uint8_t>(value >> 24);
+}
+
+void WriteLe16(uint8_t* p, uint16_t value) {
+  p[0] = static_cast<uint8_t>(value);
+  p[1] = static_cast<uint8_t>(value >> 8);
+}
+
+struct FileCloser {
+  void operator()(FILE* file) const { fclose(file); }
+};
+
+constexpr size_t kBmpFileHeaderSize = 14;
+constexpr size_t kBmpInfoHeaderSize = 40;
+constexpr uint32_t kBiRgb = 0;
+constexpr uint32_t kBiBitfields = 3;
+
+}  // namespace
+
+Image::Image(int width, int height)
+    : pixels(static_cast<size_t>(width) * height * 4), width(width), height(height) {}
+
+Image Image::FromView(const ImageView& view) {
+  if (view.Empty()) {
+    return {};
+  }
+  Image image(view.width, view.height);
+  const size_t rowBytes = static_cast<size_t>(view.width) * 4;
+  for (int y = 0; y < view.height; y++) {
+    memcpy(image.MutableRow(y), view.Row(y), rowBytes);
+  }
+  return image;
+}
+
+ImageView Image::View() const {
+  ImageView view;
+  view.data = pixels.empty() ? nullptr : pixels.data();
+  view.width = width;
+  view.height = height;
+  view.stride = width * 4;
+  return view;
+}
+
+Image Image::LoadBmp(const std::string& path) {
+  std::unique_ptr<FILE, FileCloser> file(fopen(path.c_str(), "rb"));
+  if (!file) {
+    throw std::runtime_error("Cannot open image file: " + path);
+  }
+
+  uint8_t header[kBmpFileHeaderSize + kBmpInfoHeaderSize];
+  if (fread(header, 1, sizeof(header), file.get()) != sizeof(header) || header[0] != 'B' ||
+      header[1] != 'M') {
+    throw std::runtime_error("Not a BMP file: " + path);
+  }
+
+  const uint32_t dataOffset = ReadLe32(header + 10);
+  const uint8_t* info = header + kBmpFileHeaderSize;
+  const int32_t rawWidth = static_cast<int32_t>(ReadLe32(info + 4));
+  const int32_t rawHeight = static_cast<int32_t>(ReadLe32(info + 8));
+  const uint16_t bitCount = ReadLe16(info + 14);
+  const uint32_t compression = ReadLe32(info + 16);
+
+  // 32位BI_BITFIELDS在实践中几乎都是BGRA排列，按BI_RGB处理
+  if ((bitCount != 24 && bitCount != 32) ||
+      !(compression == kBiRgb || (compression == kBiBitfields && bitCount == 32))) {
+    throw std::runtime_error("Unsupported BMP format (only uncompressed 24/32-bit): " + path);
+  }
+  if (rawWidth <= 0 || rawHeight == 0 || rawWidth > 65535 || rawHeight > 65535 || rawHeight < -65535) {
+    throw std::runtime_error("Invalid BMP dimensions: " + path);
+  }
+
+  // 高度为负表示自上而下存储
+  const bool topDown = rawHeight < 0;
+  const int width = rawWidth;
+  const int height = topDown ? -rawHeight : rawHeight;
+  const size_t bytesPerPixel = bitCount / 8;
+  const size_t srcStride = (static_cast<size_t>(width) * bytesPerPixel + 3) & ~static_cast<size_t>(3);
+
+  if (fseek(file.get(), static_cast<long>(dataOffset), SEEK_SET) != 0) {
+    throw std::runtime_error("Truncated BMP file: " + path);
+  }
+
+  Image image(width, height);
+  std::vector<uint8_t> row(srcStride);
+  for (int i = 0; i < height; i++) {
+    if (fread(row.data(), 1, srcStride, file.get()) != srcStride) {
+      throw std::runtime_error("Truncated BMP file: " + path);
+    }
+    uint8_t* dst = image.MutableRow(topDown ? i : height - 1 - i);
+    if (bytesPerPixel == 4) {
+      memcpy(dst, row.data(), static_cast<size_t>(width) * 4);
+    } else {
+      for (int x = 0; x < width; x++) {
+        dst[x * 4 + 0] = row[x * 3 + 0];
+        dst[x * 4 + 1] = row[x * 3 + 1];
+        dst[x * 4 + 2] = row[x * 3 + 2];
+        dst[x * 4 + 3] = 255;
+      }
+    }
+  }
+  return image;
+}
+
+void Image::SaveBmp(const std::string& path) const {
+  std::unique_ptr<FILE, FileCloser> file(fopen(path.c_str(), "wb"));
+  if (!file) {
+    throw std::runtime_error("Cannot open image file for writing: " + path);
+  }
+
+  const uint32_t dataSize = static_cast<uint32_t>(pixels.size());
+  uint8_t header[kBmpFileHeaderSize + kBmpInfoHeaderSize] = {};
+  header[0] = 'B';
+  header[1] = 'M';
+  WriteLe32(header + 2, static_cast<uint32_t>(sizeof(header)) + dataSize);
+  WriteLe32(header + 10, static_cast<uint32_t>(sizeof(header)));
+  uint8_t* info = header + kBmpFileHeaderSize;
+  WriteLe32(info, static_cast<uint32_t>(kBmpInfoHeaderSize));
+  WriteLe32(info + 4, static_cast<uint32_t>(width));
+  WriteLe32(info + 8, static_cast<uint32_t>(-height));  // 自上而下存储，可直接整块写出
+  WriteLe16(info + 12, 1);
+  WriteLe16(info + 14, 32);
+  WriteLe32(info + 16, kBiRgb);
+  WriteLe32(info + 20, dataSize);
+
+  if (fwrite(header, 1, sizeof(header), file.get()) != sizeof(header) ||
+      fwrite(pixels.data(), 1, pixels.size(), file.get()) != pixels.size()) {
+    throw std::runtime_error("Failed to write image file: " + path);
+  }
+}
+
+void BgraToGrayRow(const uint8_t* src, uint8_t* dst, int width) {
+  Simd::BgraToGray(src, dst, width);
+}
+
+void BgraToRgbRow(const uint8_t* src, uint8_t* dst, int width) {
+  Simd::BgraToRgb(src, dst, width);
+}
+
+void ToGray(const ImageView& src, GrayImage& dst) {
+  dst.Resize(src.width, src.height);
+  for (int y = 0; y < src.height; y++) {
+    BgraToGrayRow(src.Row(y), dst.MutableRow(y), src.width);
+  }
+}
+
+void Downscale2x(const GrayImage& src, GrayImage& dst) {
+  dst.Resize(src.width / 2, src.height / 2);
+  for (int y = 0; y < dst.height; y++) {
+    Simd::Downscale2xGray(src.Row(y * 2), src.Row(y * 2 + 1), dst.MutableRow(y), dst.width);
+  }
+}
+
+void ResizeGray(const GrayImage& src, int width, int height, GrayImage& dst) {
+  dst.Resize(width, height);
+  if (src.width <= 0 || src.height <= 0 || width <= 0 || height <= 0) {
+    return;
+  }
+  // 像素中心对齐，源坐标使用16位定点数
+  const double scaleX = static_cast<double>(src.width) / width;
+  const double scaleY = static_cast<double>(src.height) / height;
+  std::vector<int> x0(width);
+  std::vector<int> fx(width);
+  for (int x = 0; x < width; x++) {
+    const double sx = std::max(0.0, (x + 0.5) * scaleX - 0.5);
+    x0[x] = std::min(static_cast<int>(sx), src.width - 1);
+    fx[x] = static_cast<int>((sx - x0[x]) * 65536.0);
+  }
+  for (int y = 0; y < height; y++) {
+    const double sy = std::max(0.0, (y + 0.5) * scaleY - 0.5);
+    const int y0 = std::min(static_cast<int>(sy), src.height - 1);
+    const int y1 = std::min(y0 + 1, src.height - 1);
+    const int64_t fy = static_cast<int64_t>((sy - y0) * 65536.0);
+    const uint8_t* top = src.Row(y0);
+    const uint8_t* bottom = src.Row(y1);
+    uint8_t* out = dst.MutableRow(y);
+    for (int x = 0; x < width; x++) {
+      const int xa = x0[x];
+      const int xb = std::min(xa + 1, src.width - 1);
+      const int64_t t = top[xa] * (65536 - fx[x]) + static_cast<int64_t>(top[xb]) * fx[x];
+      const int64_t b = bottom[xa] * (65536 - fx[x]) + static_cast<int64_t>(bottom[xb]) * fx[x];
+      out[x] = static_cast<uint8_t>((t * (65536 - fy) + b * fy + (int64_t{1} << 31)) >> 32);
+    }
+  }
+}
+
+}  // namespace Robot
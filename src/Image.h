@@ -0,0 +1,68 @@
+#pragma once
+
+#include "./Screen.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Robot {
+
+// 拥有像素数据的BGRA图像，内存布局与ImageView一致（stride = width * 4）
+class Image {
+ public:
+  Image() = default;
+  Image(int width, int height);
+
+  // 从视图深拷贝，常用于保存采集结果
+  static Image FromView(const ImageView& view);
+
+  // 读取未压缩的24/32位BMP文件，失败时抛出std::runtime_error
+  static Image LoadBmp(const std::string& path);
+
+  // 保存为32位BMP文件
+  void SaveBmp(const std::string& path) const;
+
+  ImageView View() const;
+  int Width() const { return width; }
+  int Height() const { return height; }
+  bool Empty() const { return width <= 0 || height <= 0; }
+  uint8_t* MutableRow(int y) { return pixels.data() + static_cast<size_t>(y) * width * 4; }
+
+ private:
+  std::vector<uint8_t> pixels;
+  int width = 0;
+  int height = 0;
+};
+
+// 8位灰度平面，用于模板匹配
+struct GrayImage {
+  std::vector<uint8_t> pixels;
+  int width = 0;
+  int height = 0;
+
+  const uint8_t* Row(int y) const { return pixels.data() + static_cast<size_t>(y) * width; }
+  uint8_t* MutableRow(int y) { return pixels.data() + static_cast<size_t>(y) * width; }
+  void Resize(int w, int h) {
+    width = w;
+    height = h;
+    pixels.resize(static_cast<size_t>(w) * h);
+  }
+};
+
+// 单行BGRA转灰度（ITU-R BT.601整数近似）
+void BgraToGrayRow(const uint8_t* src, uint8_t* dst, int width);
+
+// 单行BGRA转紧凑RGB（每像素3字节）
+void BgraToRgbRow(const uint8_t* src, uint8_t* dst, int width);
+
+// 整幅BGRA转灰度，dst按src尺寸重新分配
+void ToGray(const ImageView& src, GrayImage& dst);
+
+// 2x2均值降采样，奇数尺寸时丢弃最后一行/列
+void Downscale2x(const GrayImage& src, GrayImage& dst);
+
+// 双线性缩放到指定尺寸
+void ResizeGray(const GrayImage& src, int width, int height, GrayImage& dst);
+
+}  // namespace Robot
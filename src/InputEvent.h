@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Robot {
+
+// 录制/回放使用的原始输入事件类型
+enum class InputEventType : uint8_t {
+  KEY_DOWN = 0,
+  KEY_UP = 1,
+  BUTTON_DOWN = 2,
+  BUTTON_UP = 3,
+  MOTION = 4
+};
+
+// 单条原始输入事件，固定16字节，直接按内存布局写入日志文件
+// code: 键盘事件为平台原生键码（X11 keycode），鼠标事件为按钮号（1=左 2=中 3=右 4/5=滚轮 ...）
+// x/y:  事件发生时指针在虚拟桌面上的绝对坐标
+struct InputEvent {
+  uint64_t timeUs;      // 相对录制开始的微秒数（由X服务器事件时间换算，精度为毫秒）
+  InputEventType type;
+  uint8_t reserved;
+  uint16_t code;
+  int16_t x;
+  int16_t y;
+};
+
+static_assert(sizeof(InputEvent) == 16, "InputEvent must stay 16 bytes");
+
+// 二进制事件日志文件头，文件剩余部分为连续的InputEvent数组
+struct EventLogHeader {
+  char magic[8];          // "AGUIREC1"
+  uint32_t version;       // 当前为1
+  uint32_t recordSize;    // sizeof(InputEvent)
+  uint64_t startEpochUs;  // 录制开始时的系统时间（微秒，Unix纪元）
+};
+
+static_assert(sizeof(EventLogHeader) == 24, "EventLogHeader must stay 24 bytes");
+
+constexpr char kEventLogMagic[8] = {'A', 'G', 'U', 'I', 'R', 'E', 'C', '1'};
+constexpr uint32_t kEventLogVersion = 1;
+
+}  // namespace Robot
@@ -8,11 +8,11 @@
 #include <X11/extensions/XTest.h>
 #endif
 #include <iostream>
-#include <random>
 #include <map>
 #include <cstring>
 
 #include "./Keyboard.h"
+#include "./TypingCadence.h"
 #include "./Utils.h"
 
 namespace Robot {
@@ -189,18 +189,26 @@ void Keyboard::Type(const std::string &query) {
 }
 
 void Keyboard::TypeHumanLike(const std::string &query) {
-  std::normal_distribution<double> distribution(75, 25);
-  std::random_device rd;
-  std::mt19937 engine(rd());
-
-  for (char c : query) {
+  std::string text;
+  text.reserve(query.size());
+  for (const char c : query) {
     if (!KeyUtils::IsValidAscii(c)) {
       std::cerr << "Warning: Skipping invalid ASCII character: " << static_cast<int>(c) << std::endl;
       continue;
     }
+    text.push_back(c);
+  }
 
-    Click(c);
-    Robot::delay((int)distribution(engine));
+  // 间隔范围约为原先正态分布(75ms, 25ms)的±2σ
+  CadenceOptions options;
+  options.minDelay = 0.025;
+  options.maxDelay = 0.125;
+  const std::vector<Keystroke> schedule = TypingCadence(options).Schedule(text);
+
+  const auto start = std::chrono::steady_clock::now();
+  for (const Keystroke &keystroke : schedule) {
+    Robot::delayUntil(start + keystroke.offset);
+    Click(keystroke.character);
   }
 }
 
@@ -444,6 +452,20 @@ void Keyboard::Release(SpecialKey specialKey) {
   Robot::delay(delay);
 }
 
+#ifdef __linux__
+void Keyboard::PressNative(unsigned int nativeCode) {
+  InitializeX11();
+  XTestFakeKeyEvent(display, nativeCode, True, CurrentTime);
+  XFlush(display);
+}
+
+void Keyboard::ReleaseNative(unsigned int nativeCode) {
+  InitializeX11();
+  XTestFakeKeyEvent(display, nativeCode, False, CurrentTime);
+  XFlush(display);
+}
+#endif
+
 KeyCode Keyboard::SpecialKeyToVirtualKey(SpecialKey specialKey) {
   return specialKeyToVirtualKeyMap.at(specialKey);
 }
@@ -601,7 +623,8 @@ std::map<Keyboard::SpecialKey, KeyCode> Keyboard::specialKeyToVirtualKeyMap = {
     {Keyboard::F9, kVK_F9},
     {Keyboard::F10, kVK_F10},
     {Keyboard::F11, kVK_F11},
-    {Keyboard::F12, kVK_F12}};
+    {Keyboard::F12, kVK_F12},
+    {Keyboard::SPACE, kVK_Space}};
 #endif
 
 
@@ -632,7 +655,8 @@ std::map<Keyboard::SpecialKey, KeyCode> Keyboard::specialKeyToVirtualKeyMap = {
     {Keyboard::F9, XK_F9},
     {Keyboard::F10, XK_F10},
     {Keyboard::F11, XK_F11},
-    {Keyboard::F12, XK_F12}};
+    {Keyboard::F12, XK_F12},
+    {Keyboard::SPACE, XK_space}};
 #endif
 
   char Keyboard::VirtualKeyToAscii(KeyCode virtualKey) {
@@ -835,7 +859,8 @@ std::map<Keyboard::SpecialKey, KeyCode> Keyboard::specialKeyToVirtualKeyMap = {
     {Keyboard::F9, VK_F9},
     {Keyboard::F10, VK_F10},
     {Keyboard::F11, VK_F11},
-    {Keyboard::F12, VK_F12}};
+    {Keyboard::F12, VK_F12},
+    {Keyboard::SPACE, VK_SPACE}};
 #endif
 
 #ifdef __APPLE__
@@ -64,7 +64,8 @@ class Keyboard {
     F9,
     F10,
     F11,
-    F12
+    F12,
+    SPACE
   };
 
   static const char INVALID_ASCII;
@@ -90,9 +91,18 @@ class Keyboard {
   static void Release(char asciiChar);
   static void Release(SpecialKey specialKey);
 
+#ifdef __linux__
+  // 直接按下/释放平台原生键码（X11 keycode），不做字符映射，也不附加delay，供事件回放使用
+  static void PressNative(unsigned int nativeCode);
+  static void ReleaseNative(unsigned int nativeCode);
+#endif
+
   static char VirtualKeyToAscii(KeyCode virtualKey);
   static SpecialKey VirtualKeyToSpecialKey(KeyCode virtualKey);
 
+  static KeyCode AsciiToVirtualKey(char asciiChar);
+  static KeyCode SpecialKeyToVirtualKey(SpecialKey specialKey);
+
  private:
   static std::thread keyPressThread;
   static std::atomic<bool> continueHolding;
@@ -103,10 +113,6 @@ class Keyboard {
 
   static int delay;
 
-  static KeyCode AsciiToVirtualKey(char asciiChar);
-
-  static KeyCode SpecialKeyToVirtualKey(SpecialKey specialKey);
-
   static std::map<SpecialKey, KeyCode> specialKeyToVirtualKeyMap;
     // Platform-specific implementations
 #ifdef __linux__
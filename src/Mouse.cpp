@@ -208,6 +208,14 @@ void Mouse::ToggleButton(bool down, MouseButton button, bool doubleClick) {
   }
 }
 
+#ifdef __linux__
+void Mouse::ToggleNativeButton(bool down, unsigned int buttonCode) {
+  InitializeX11();
+  XTestFakeButtonEvent(display, buttonCode, down ? True : False, CurrentTime);
+  XFlush(display);
+}
+#endif
+
 void Mouse::MoveWithButtonPressed(Robot::Point point, MouseButton button) {
 #ifdef _WIN32
   // On Windows, just calling Move is enough as it will keep the button state.
@@ -50,6 +50,11 @@ class Mouse {
 
   static void ScrollBy(int y, int x = 0);
 
+#ifdef __linux__
+  // 直接发送X11原生按钮号（1=左 2=中 3=右 4-7=滚轮），不附加delay，供事件回放使用
+  static void ToggleNativeButton(bool down, unsigned int buttonCode);
+#endif
+
  private:
   static void MoveWithButtonPressed(Robot::Point point, MouseButton button);
     // Platform-specific implementations
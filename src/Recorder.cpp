@@ -0,0 +1,300 @@
+#include "./Recorder.h"
+
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#ifdef __linux__
+#include <X11/Xproto.h>
+#endif
+
+namespace Robot {
+
+namespace {
+
+// 写入线程每批最多取出的事件数
+constexpr size_t kWriteBatch = 4096;
+
+// 队列为空时写入线程的休眠时间
+constexpr auto kWriterIdle = std::chrono::milliseconds(2);
+
+}  // namespace
+
+Recorder::Recorder(size_t queueCapacity) : queue(queueCapacity) {}
+
+Recorder::~Recorder() {
+  if (IsRecording()) {
+    try {
+      Stop();
+    } catch (...) {
+      // 析构函数中不能抛出异常
+    }
+  }
+}
+
+bool Recorder::IsRecording() const {
+  return recording.load(std::memory_order_acquire);
+}
+
+Recorder::Stats Recorder::GetStats() const {
+  return {captured.load(std::memory_order_relaxed),
+          written.load(std::memory_order_relaxed),
+          dropped.load(std::memory_order_relaxed),
+          maxQueueDepth.load(std::memory_order_relaxed)};
+}
+
+void Recorder::Enqueue(const InputEvent& event) {
+  captured.fetch_add(1, std::memory_order_relaxed);
+  if (!queue.Push(event)) {
+    dropped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  const size_t depth = queue.SizeApprox();
+  if (depth > maxQueueDepth.load(std::memory_order_relaxed)) {
+    maxQueueDepth.store(depth, std::memory_order_relaxed);
+  }
+}
+
+void Recorder::WriterThread() {
+  std::vector<InputEvent> batch(kWriteBatch);
+  while (true) {
+    const size_t count = queue.PopBulk(batch.data(), batch.size());
+    if (count > 0) {
+      // 写入失败后继续取出事件以免采集线程的队列堆满，但不再写文件
+      if (!writeFailed.load(std::memory_order_relaxed)) {
+        const size_t done = fwrite(batch.data(), sizeof(InputEvent), count, file);
+        written.fetch_add(done, std::memory_order_relaxed);
+        if (done != count) {
+          writeFailed.store(true, std::memory_order_relaxed);
+        }
+      }
+      continue;
+    }
+    // 采集已停止且队列已清空才退出
+    if (!writerRunning.load(std::memory_order_acquire)) {
+      break;
+    }
+    std::this_thread::sleep_for(kWriterIdle);
+  }
+  if (fflush(file) != 0) {
+    writeFailed.store(true, std::memory_order_relaxed);
+  }
+}
+
+#ifdef __linux__
+
+void Recorder::OnInterceptedData(XPointer closure, XRecordInterceptData* data) {
+  auto* self = reinterpret_cast<Recorder*>(closure);
+
+  if (data->category == XRecordStartOfData && !self->startSignaled) {
+    self->startSignaled = true;
+    self->started.set_value(true);
+  }
+
+  if (data->category == XRecordFromServer && data->data != nullptr) {
+    const auto* raw = reinterpret_cast<const xEvent*>(data->data);
+
+    InputEvent event{};
+    // XRecord成批投递事件，回调时刻的本地时钟会把一批事件挤到同一时刻，因此使用服务器记录的事件时间。
+    // 第一个事件以本地时钟对齐到录制开始时刻，之后按服务器时间差（32位毫秒，无符号相减处理回绕）累加
+    const uint32_t serverTime = raw->u.keyButtonPointer.time;
+    if (!self->haveServerTime) {
+      self->haveServerTime = true;
+      self->timeUs = static_cast<uint64_t>(
+          std::chrono::duration_cast<std::chrono::microseconds>(
+              std::chrono::steady_clock::now() - self->startTime)
+              .count());
+    } else {
+      self->timeUs += static_cast<uint64_t>(static_cast<uint32_t>(serverTime - self->lastServerTime)) * 1000;
+    }
+    self->lastServerTime = serverTime;
+    event.timeUs = self->timeUs;
+    event.code = raw->u.u.detail;
+    event.x = raw->u.keyButtonPointer.rootX;
+    event.y = raw->u.keyButtonPointer.rootY;
+
+    bool known = true;
+    switch (raw->u.u.type & 0x7F) {
+      case KeyPress:
+        event.type = InputEventType::KEY_DOWN;
+        break;
+      case KeyRelease:
+        event.type = InputEventType::KEY_UP;
+        break;
+      case ButtonPress:
+        event.type = InputEventType::BUTTON_DOWN;
+        break;
+      case ButtonRelease:
+        event.type = InputEventType::BUTTON_UP;
+        break;
+      case MotionNotify:
+        event.type = InputEventType::MOTION;
+        break;
+      default:
+        known = false;
+    }
+
+    if (known) {
+      self->Enqueue(event);
+    }
+  }
+
+  XRecordFreeData(data);
+}
+
+void Recorder::CaptureThread() {
+  // 阻塞直到控制连接调用XRecordDisableContext
+  XRecordEnableContext(dataDisplay, context, &Recorder::OnInterceptedData,
+                       reinterpret_cast<XPointer>(this));
+  if (!startSignaled) {
+    // 启用失败，没有收到XRecordStartOfData
+    startSignaled = true;
+    started.set_value(false);
+  }
+}
+
+void Recorder::Start(const std::string& path) {
+  if (IsRecording()) {
+    throw std::runtime_error("Recorder is already running");
+  }
+
+  // XRecord要求控制连接与数据连接分离
+  controlDisplay = XOpenDisplay(nullptr);
+  dataDisplay = XOpenDisplay(nullptr);
+  if (controlDisplay == nullptr || dataDisplay == nullptr) {
+    if (controlDisplay) XCloseDisplay(controlDisplay);
+    if (dataDisplay) XCloseDisplay(dataDisplay);
+    controlDisplay = dataDisplay = nullptr;
+    throw std::runtime_error("Cannot open X11 display");
+  }
+
+  int major = 0, minor = 0;
+  if (!XRecordQueryVersion(controlDisplay, &major, &minor)) {
+    XCloseDisplay(controlDisplay);
+    XCloseDisplay(dataDisplay);
+    controlDisplay = dataDisplay = nullptr;
+    throw std::runtime_error("XRecord extension is not available");
+  }
+
+  XRecordClientSpec clients = XRecordAllClients;
+  XRecordRange* range = XRecordAllocRange();
+  range->device_events.first = KeyPress;
+  range->device_events.last = MotionNotify;
+  context = XRecordCreateContext(controlDisplay, 0, &clients, 1, &range, 1);
+  XFree(range);
+  if (context == 0) {
+    XCloseDisplay(controlDisplay);
+    XCloseDisplay(dataDisplay);
+    controlDisplay = dataDisplay = nullptr;
+    throw std::runtime_error("Cannot create XRecord context");
+  }
+  XSync(controlDisplay, False);
+
+  file = fopen(path.c_str(), "wb");
+  if (file == nullptr) {
+    XRecordFreeContext(controlDisplay, context);
+    XCloseDisplay(controlDisplay);
+    XCloseDisplay(dataDisplay);
+    controlDisplay = dataDisplay = nullptr;
+    context = 0;
+    throw std::runtime_error("Cannot open record file: " + path);
+  }
+  // 较大的stdio缓冲区，减少写入线程的系统调用次数
+  setvbuf(file, nullptr, _IOFBF, 1 << 20);
+
+  EventLogHeader header{};
+  memcpy(header.magic, kEventLogMagic, sizeof(header.magic));
+  header.version = kEventLogVersion;
+  header.recordSize = sizeof(InputEvent);
+  header.startEpochUs = static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          std::chrono::system_clock::now().time_since_epoch())
+          .count());
+  if (fwrite(&header, sizeof(header), 1, file) != 1) {
+    fclose(file);
+    file = nullptr;
+    XRecordFreeContext(controlDisplay, context);
+    XCloseDisplay(controlDisplay);
+    XCloseDisplay(dataDisplay);
+    controlDisplay = dataDisplay = nullptr;
+    context = 0;
+    throw std::runtime_error("Cannot write record file: " + path);
+  }
+
+  captured = 0;
+  written = 0;
+  dropped = 0;
+  maxQueueDepth = 0;
+  writeFailed = false;
+  startTime = std::chrono::steady_clock::now();
+  started = std::promise<bool>();
+  startSignaled = false;
+  haveServerTime = false;
+  timeUs = 0;
+
+  writerRunning.store(true, std::memory_order_release);
+  writerThread = std::thread(&Recorder::WriterThread, this);
+  recording.store(true, std::memory_order_release);
+  std::future<bool> enabled = started.get_future();
+  captureThread = std::thread(&Recorder::CaptureThread, this);
+
+  // 等待服务器确认开始投递，保证随后的Stop()中XRecordDisableContext不会早于XRecordEnableContext而失效
+  if (!enabled.get()) {
+    captureThread.join();
+    writerRunning.store(false, std::memory_order_release);
+    writerThread.join();
+    XRecordFreeContext(controlDisplay, context);
+    XCloseDisplay(dataDisplay);
+    XCloseDisplay(controlDisplay);
+    dataDisplay = controlDisplay = nullptr;
+    context = 0;
+    fclose(file);
+    file = nullptr;
+    recording.store(false, std::memory_order_release);
+    throw std::runtime_error("Cannot enable XRecord context");
+  }
+}
+
+void Recorder::Stop() {
+  if (!IsRecording()) {
+    return;
+  }
+
+  XRecordDisableContext(controlDisplay, context);
+  XSync(controlDisplay, False);
+  if (captureThread.joinable()) {
+    captureThread.join();
+  }
+
+  writerRunning.store(false, std::memory_order_release);
+  if (writerThread.joinable()) {
+    writerThread.join();
+  }
+
+  XRecordFreeContext(controlDisplay, context);
+  XCloseDisplay(dataDisplay);
+  XCloseDisplay(controlDisplay);
+  dataDisplay = controlDisplay = nullptr;
+  context = 0;
+
+  const bool closeFailed = fclose(file) != 0;
+  file = nullptr;
+  recording.store(false, std::memory_order_release);
+  if (writeFailed.load(std::memory_order_relaxed) || closeFailed) {
+    throw std::runtime_error("Failed to write record file, the recording is truncated");
+  }
+}
+
+#else
+
+void Recorder::CaptureThread() {}
+
+void Recorder::Start(const std::string&) {
+  throw std::runtime_error("Recorder is only supported on Linux X11");
+}
+
+void Recorder::Stop() {}
+
+#endif
+
+}  // namespace Robot
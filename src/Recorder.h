@@ -0,0 +1,86 @@
+#pragma once
+
+#include "./InputEvent.h"
+#include "./RingBuffer.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <future>
+#include <string>
+#include <thread>
+
+#ifdef __linux__
+#include <X11/Xlib.h>
+#include <X11/extensions/record.h>
+#endif
+
+namespace Robot {
+
+// 全局输入录制器
+// 采集线程通过XRecord被动接收服务器上的设备事件，只做解析与入队（无锁、不阻塞、不分配内存），
+// 写入线程批量取出事件写入二进制日志（格式见InputEvent.h）。
+// 队列满时事件会被计入dropped而不是阻塞采集线程，默认容量可缓冲约1分钟的1kHz鼠标事件。
+class Recorder {
+ public:
+  struct Stats {
+    uint64_t captured;     // 采集线程收到的事件数
+    uint64_t written;      // 已写入文件的事件数
+    uint64_t dropped;      // 因队列满而丢弃的事件数
+    size_t maxQueueDepth;  // 队列最高水位
+  };
+
+  explicit Recorder(size_t queueCapacity = 1 << 16);
+  ~Recorder();
+
+  Recorder(const Recorder&) = delete;
+  Recorder& operator=(const Recorder&) = delete;
+
+  // 开始录制到指定文件（覆盖已有文件），返回时服务器已开始投递事件
+  void Start(const std::string& path);
+
+  // 停止录制，等待队列中剩余事件全部落盘
+  // 写文件失败（如磁盘已满）时在清理完成后抛出std::runtime_error，此时文件不完整
+  void Stop();
+
+  bool IsRecording() const;
+
+  Stats GetStats() const;
+
+ private:
+  void CaptureThread();
+  void WriterThread();
+  void Enqueue(const InputEvent& event);
+
+  SpscRingBuffer<InputEvent> queue;
+  std::atomic<bool> recording{false};
+  std::atomic<bool> writerRunning{false};
+  std::atomic<bool> writeFailed{false};
+  std::thread captureThread;
+  std::thread writerThread;
+  FILE* file = nullptr;
+  std::chrono::steady_clock::time_point startTime;
+
+  std::atomic<uint64_t> captured{0};
+  std::atomic<uint64_t> written{0};
+  std::atomic<uint64_t> dropped{0};
+  std::atomic<size_t> maxQueueDepth{0};
+
+#ifdef __linux__
+  static void OnInterceptedData(XPointer closure, XRecordInterceptData* data);
+
+  Display* controlDisplay = nullptr;
+  Display* dataDisplay = nullptr;
+  XRecordContext context = 0;
+
+  // 以下仅由采集线程访问
+  std::promise<bool> started;  // 收到XRecordStartOfData（true）或启用失败（false）
+  bool startSignaled = false;
+  bool haveServerTime = false;
+  uint32_t lastServerTime = 0;  // X服务器时间（毫秒，32位回绕）
+  uint64_t timeUs = 0;          // 最近一个事件相对录制开始的时间
+#endif
+};
+
+}  // namespace Robot
@@ -0,0 +1,241 @@
+#include "./Replayer.h"
+#include "./Keyboard.h"
+#include "./Mouse.h"
+#include "./Utils.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Robot {
+
+#ifdef __linux__
+
+Replayer::Replayer(const std::string& path) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw std::runtime_error("Cannot open event log: " + path);
+  }
+
+  struct stat st {};
+  if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(EventLogHeader)) {
+    close(fd);
+    throw std::runtime_error("Invalid event log: " + path);
+  }
+
+  mappingSize = static_cast<size_t>(st.st_size);
+  mapping = mmap(nullptr, mappingSize, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (mapping == MAP_FAILED) {
+    mapping = nullptr;
+    throw std::runtime_error("Cannot mmap event log: " + path);
+  }
+
+  const auto* header = static_cast<const EventLogHeader*>(mapping);
+  if (memcmp(header->magic, kEventLogMagic, sizeof(header->magic)) != 0 ||
+      header->version != kEventLogVersion ||
+      header->recordSize != sizeof(InputEvent)) {
+    munmap(mapping, mappingSize);
+    mapping = nullptr;
+    throw std::runtime_error("Unsupported event log format: " + path);
+  }
+
+  startEpochUs = header->startEpochUs;
+  events = reinterpret_cast<const InputEvent*>(static_cast<const char*>(mapping) +
+                                               sizeof(EventLogHeader));
+  count = (mappingSize - sizeof(EventLogHeader)) / sizeof(InputEvent);
+
+  // 回放是顺序读取，让内核提前预读
+  madvise(mapping, mappingSize, MADV_SEQUENTIAL);
+
+  sparseIndex.reserve(count / kIndexStride + 1);
+  for (size_t i = 0; i < count; i += kIndexStride) {
+    sparseIndex.push_back(events[i].timeUs);
+  }
+}
+
+Replayer::~Replayer() {
+  if (mapping != nullptr) {
+    munmap(mapping, mappingSize);
+  }
+}
+
+void Replayer::Emit(const InputEvent& event) {
+  switch (event.type) {
+    case InputEventType::MOTION:
+      Mouse::Move({event.x, event.y});
+      break;
+    case InputEventType::KEY_DOWN:
+      Keyboard::PressNative(event.code);
+      heldKeys[event.code & 0xFF] = true;
+      break;
+    case InputEventType::KEY_UP:
+      Keyboard::ReleaseNative(event.code);
+      heldKeys[event.code & 0xFF] = false;
+      break;
+    case InputEventType::BUTTON_DOWN:
+      Mouse::ToggleNativeButton(true, event.code);
+      heldButtons[event.code & 0x1F] = true;
+      break;
+    case InputEventType::BUTTON_UP:
+      Mouse::ToggleNativeButton(false, event.code);
+      heldButtons[event.code & 0x1F] = false;
+      break;
+  }
+}
+
+void Replayer::ReleaseHeld() {
+  for (size_t code = 0; code < heldKeys.size(); code++) {
+    if (heldKeys[code]) {
+      Keyboard::ReleaseNative(static_cast<unsigned int>(code));
+      heldKeys[code] = false;
+    }
+  }
+  for (size_t button = 0; button < heldButtons.size(); button++) {
+    if (heldButtons[button]) {
+      Mouse::ToggleNativeButton(false, static_cast<unsigned int>(button));
+      heldButtons[button] = false;
+    }
+  }
+}
+
+#else
+
+Replayer::Replayer(const std::string&) {
+  throw std::runtime_error("Replayer is only supported on Linux X11");
+}
+
+Replayer::~Replayer() = default;
+
+void Replayer::Emit(const InputEvent&) {}
+
+void Replayer::ReleaseHeld() {}
+
+#endif
+
+uint64_t Replayer::DurationUs() const {
+  if (count == 0) {
+    return 0;
+  }
+  return events[count - 1].timeUs - events[0].timeUs;
+}
+
+void Replayer::SetSpeed(double multiplier) {
+  if (multiplier < kMinSpeed || multiplier > kMaxSpeed) {
+    throw std::invalid_argument("Replay speed must be within [0.5, 100]");
+  }
+  speed = multiplier;
+}
+
+size_t Replayer::FindFirstAtOrAfter(uint64_t timeUs) const {
+  if (count == 0) {
+    return 0;
+  }
+  // 先在稀疏索引中定位块，再在块内二分
+  // 取第一个>=timeUs的索引条目k，结果在块k-1内或正好是条目k；
+  // 相同时间戳跨越块边界时块k-1的末尾也可能等于timeUs，用upper_bound会跳过它们
+  const auto it = std::lower_bound(sparseIndex.begin(), sparseIndex.end(), timeUs);
+  if (it == sparseIndex.begin()) {
+    return 0;
+  }
+  const size_t block = static_cast<size_t>(it - sparseIndex.begin()) - 1;
+  const InputEvent* first = events + block * kIndexStride;
+  const InputEvent* last = events + std::min(count, (block + 1) * kIndexStride);
+  const InputEvent* found = std::lower_bound(
+      first, last, timeUs,
+      [](const InputEvent& event, uint64_t t) { return event.timeUs < t; });
+  return static_cast<size_t>(found - events);
+}
+
+void Replayer::Seek(uint64_t timeUs) {
+  cursor = FindFirstAtOrAfter(timeUs);
+}
+
+void Replayer::Play() {
+  PlayUntil(UINT64_MAX);
+}
+
+void Replayer::Stop() {
+  stopRequested.store(true, std::memory_order_release);
+}
+
+void Replayer::PlayUntil(uint64_t endTimeUs) {
+  stopRequested.store(false, std::memory_order_release);
+  histogram.fill(0);
+  reportEvents = 0;
+  errorSumUs = 0;
+  errorMaxUs = 0;
+  lateEvents = 0;
+
+  if (cursor >= count) {
+    return;
+  }
+
+  const uint64_t baseUs = events[cursor].timeUs;
+  const auto start = std::chrono::steady_clock::now();
+
+  while (cursor < count && !stopRequested.load(std::memory_order_acquire)) {
+    const InputEvent& event = events[cursor];
+    if (event.timeUs >= endTimeUs) {
+      break;
+    }
+
+    const auto offset = std::chrono::duration<double, std::micro>(
+        static_cast<double>(event.timeUs - baseUs) / speed);
+    const auto target =
+        start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(offset);
+    delayUntil(target);
+
+    const double errorUs = std::chrono::duration<double, std::micro>(
+        std::chrono::steady_clock::now() - target).count();
+    Emit(event);
+    cursor++;
+
+    reportEvents++;
+    errorSumUs += errorUs;
+    errorMaxUs = std::max(errorMaxUs, errorUs);
+    if (errorUs > 1000.0) {
+      lateEvents++;
+    }
+    const size_t bucket = std::min(kHistogramBuckets - 1,
+                                   static_cast<size_t>(std::max(0.0, errorUs) / 10.0));
+    histogram[bucket]++;
+  }
+
+  // 被打断或播放到结尾时，释放仍按下的键和按钮
+  if (stopRequested.load(std::memory_order_acquire) || cursor >= count) {
+    ReleaseHeld();
+  }
+}
+
+Replayer::TimingReport Replayer::GetReport() const {
+  TimingReport report{};
+  report.events = reportEvents;
+  report.maxErrorUs = errorMaxUs;
+  report.lateEvents = lateEvents;
+  if (reportEvents == 0) {
+    return report;
+  }
+  report.meanErrorUs = errorSumUs / static_cast<double>(reportEvents);
+
+  const uint64_t threshold = (reportEvents * 99 + 99) / 100;
+  uint64_t accumulated = 0;
+  for (size_t i = 0; i < kHistogramBuckets; i++) {
+    accumulated += histogram[i];
+    if (accumulated >= threshold) {
+      report.p99ErrorUs = static_cast<double>(i + 1) * 10.0;
+      break;
+    }
+  }
+  return report;
+}
+
+}  // namespace Robot
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "./InputEvent.h"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Robot {
+
+// 二进制事件日志回放器
+// 日志文件通过mmap只读映射，事件直接从映射区读取，堆上只保留稀疏时间索引（每4096条事件一项），
+// 因此数小时的日志也不会占用对应大小的内存。
+// 每个事件按照 播放起点 + 原始时间戳/速度 的绝对时刻发出（而不是累加相对延迟），
+// 误差不会随播放时长累积。
+class Replayer {
+ public:
+  // 回放时间误差统计（实际发出时间 - 计划发出时间）
+  struct TimingReport {
+    uint64_t events;      // 已回放事件数
+    double meanErrorUs;   // 平均误差
+    double maxErrorUs;    // 最大误差
+    double p99ErrorUs;    // 99分位误差（10us精度，超过10ms按10ms计）
+    uint64_t lateEvents;  // 误差超过1ms的事件数
+  };
+
+  static constexpr double kMinSpeed = 0.5;
+  static constexpr double kMaxSpeed = 100.0;
+
+  explicit Replayer(const std::string& path);
+  ~Replayer();
+
+  Replayer(const Replayer&) = delete;
+  Replayer& operator=(const Replayer&) = delete;
+
+  size_t EventCount() const { return count; }
+
+  // 日志总时长（微秒）
+  uint64_t DurationUs() const;
+
+  // 录制开始时的系统时间（微秒，Unix纪元）
+  uint64_t StartEpochUs() const { return startEpochUs; }
+
+  // 设置回放速度倍率，范围[0.5, 100]
+  void SetSpeed(double multiplier);
+  double GetSpeed() const { return speed; }
+
+  // 将回放位置移动到第一个时间戳 >= timeUs 的事件
+  void Seek(uint64_t timeUs);
+
+  // 当前回放位置（事件序号）
+  size_t Position() const { return cursor; }
+
+  // 从当前位置回放到结尾（阻塞），可被Stop()从其他线程打断
+  void Play();
+
+  // 从当前位置回放到时间戳 < endTimeUs 的最后一个事件（阻塞）
+  void PlayUntil(uint64_t endTimeUs);
+
+  // 请求停止正在进行的回放，可在任意线程调用
+  void Stop();
+
+  // 获取最近一次Play/PlayUntil的时间误差统计
+  TimingReport GetReport() const;
+
+ private:
+  static constexpr size_t kIndexStride = 4096;
+  static constexpr size_t kHistogramBuckets = 1000;  // 每桶10us
+
+  size_t FindFirstAtOrAfter(uint64_t timeUs) const;
+  void Emit(const InputEvent& event);
+  void ReleaseHeld();
+
+  void* mapping = nullptr;
+  size_t mappingSize = 0;
+  const InputEvent* events = nullptr;
+  size_t count = 0;
+  uint64_t startEpochUs = 0;
+
+  std::vector<uint64_t> sparseIndex;  // sparseIndex[i] = events[i * kIndexStride].timeUs
+  size_t cursor = 0;
+  double speed = 1.0;
+  std::atomic<bool> stopRequested{false};
+
+  // 回放期间仍处于按下状态的键/按钮，用于停止时释放，避免卡键
+  std::array<bool, 256> heldKeys{};
+  std::array<bool, 32> heldButtons{};
+
+  std::array<uint32_t, kHistogramBuckets> histogram{};
+  uint64_t reportEvents = 0;
+  double errorSumUs = 0;
+  double errorMaxUs = 0;
+  uint64_t lateEvents = 0;
+};
+
+}  // namespace Robot
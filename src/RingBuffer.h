@@ -0,0 +1,103 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+
+namespace Robot {
+
+// 单生产者/单消费者无锁环形队列
+// 生产者与消费者各自缓存对方的索引，只有在缓存看起来已满/已空时才去读取对方的原子变量，
+// 这样在稳定状态下每次Push/Pop只触碰自己的缓存行
+template <typename T>
+class SpscRingBuffer {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "SpscRingBuffer only supports trivially copyable types");
+
+ public:
+  // capacity会向上取整到2的幂
+  explicit SpscRingBuffer(size_t capacity) {
+    if (capacity < 2) {
+      throw std::invalid_argument("SpscRingBuffer capacity must be >= 2");
+    }
+    size_t rounded = 1;
+    while (rounded < capacity) {
+      rounded <<= 1;
+    }
+    mask = rounded - 1;
+    buffer.reset(new T[rounded]);
+  }
+
+  SpscRingBuffer(const SpscRingBuffer&) = delete;
+  SpscRingBuffer& operator=(const SpscRingBuffer&) = delete;
+
+  // 仅生产者线程调用，队列满时立即返回false，从不阻塞
+  bool Push(const T& item) noexcept {
+    const size_t head = producer.index.load(std::memory_order_relaxed);
+    if (head - producer.cachedOther > mask) {
+      producer.cachedOther = consumer.index.load(std::memory_order_acquire);
+      if (head - producer.cachedOther > mask) {
+        return false;
+      }
+    }
+    buffer[head & mask] = item;
+    producer.index.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  // 仅消费者线程调用，队列空时返回false
+  bool Pop(T& item) noexcept {
+    const size_t tail = consumer.index.load(std::memory_order_relaxed);
+    if (tail == consumer.cachedOther) {
+      consumer.cachedOther = producer.index.load(std::memory_order_acquire);
+      if (tail == consumer.cachedOther) {
+        return false;
+      }
+    }
+    item = buffer[tail & mask];
+    consumer.index.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // 仅消费者线程调用，一次取出最多maxCount个元素，返回实际数量
+  size_t PopBulk(T* out, size_t maxCount) noexcept {
+    const size_t tail = consumer.index.load(std::memory_order_relaxed);
+    consumer.cachedOther = producer.index.load(std::memory_order_acquire);
+    size_t available = consumer.cachedOther - tail;
+    if (available > maxCount) {
+      available = maxCount;
+    }
+    for (size_t i = 0; i < available; i++) {
+      out[i] = buffer[(tail + i) & mask];
+    }
+    consumer.index.store(tail + available, std::memory_order_release);
+    return available;
+  }
+
+  // 近似值，仅用于统计
+  size_t SizeApprox() const noexcept {
+    const size_t head = producer.index.load(std::memory_order_acquire);
+    const size_t tail = consumer.index.load(std::memory_order_acquire);
+    return head - tail;
+  }
+
+  size_t Capacity() const noexcept { return mask + 1; }
+
+ private:
+  static constexpr size_t kCacheLine = 64;
+
+  struct alignas(kCacheLine) Cursor {
+    std::atomic<size_t> index{0};
+    size_t cachedOther = 0;
+  };
+
+  Cursor producer;
+  Cursor consumer;
+  size_t mask = 0;
+  std::unique_ptr<T[]> buffer;
+};
+
+}  // namespace Robot
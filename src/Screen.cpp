@@ -0,0 +1,220 @@
+#include "./Screen.h"
+#include "./XErrorTrap.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#ifdef __linux__
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#endif
+
+namespace Robot {
+
+#ifdef __linux__
+
+namespace {
+
+// 将区域裁剪到[0, width) x [0, height)
+Rect ClipRegion(Rect region, int width, int height) {
+  const int x1 = std::max(region.x, 0);
+  const int y1 = std::max(region.y, 0);
+  const int x2 = std::min(region.x + region.width, width);
+  const int y2 = std::min(region.y + region.height, height);
+  return {x1, y1, std::max(0, x2 - x1), std::max(0, y2 - y1)};
+}
+
+}  // namespace
+
+ScreenCapture::ScreenCapture() {
+  display = XOpenDisplay(nullptr);
+  if (display == nullptr) {
+    throw std::runtime_error("Cannot open X11 display");
+  }
+  rootWindow = DefaultRootWindow(display);
+  XWindowAttributes attributes;
+  XGetWindowAttributes(display, rootWindow, &attributes);
+  rootWidth = attributes.width;
+  rootHeight = attributes.height;
+
+  InitShm();
+}
+
+ScreenCapture::~ScreenCapture() {
+  ReleaseShm();
+  if (display != nullptr) {
+    XCloseDisplay(display);
+  }
+}
+
+void ScreenCapture::InitShm() {
+  if (!XShmQueryExtension(display)) {
+    return;
+  }
+
+  const int screen = DefaultScreen(display);
+  shmImage = XShmCreateImage(display, DefaultVisual(display, screen),
+                             static_cast<unsigned int>(DefaultDepth(display, screen)), ZPixmap,
+                             nullptr, &shmInfo, static_cast<unsigned int>(rootWidth),
+                             static_cast<unsigned int>(rootHeight));
+  // 只处理常见的32位像素格式（depth 24/32），其他格式走XGetImage
+  if (shmImage == nullptr || shmImage->bits_per_pixel != 32) {
+    if (shmImage != nullptr) {
+      XDestroyImage(shmImage);
+      shmImage = nullptr;
+    }
+    return;
+  }
+
+  shmInfo.shmid = shmget(IPC_PRIVATE,
+                         static_cast<size_t>(shmImage->bytes_per_line) * shmImage->height,
+                         IPC_CREAT | 0600);
+  if (shmInfo.shmid < 0) {
+    XDestroyImage(shmImage);
+    shmImage = nullptr;
+    return;
+  }
+  void* address = shmat(shmInfo.shmid, nullptr, 0);
+  if (address == reinterpret_cast<void*>(-1)) {
+    shmctl(shmInfo.shmid, IPC_RMID, nullptr);
+    XDestroyImage(shmImage);
+    shmImage = nullptr;
+    return;
+  }
+  shmInfo.shmaddr = shmImage->data = static_cast<char*>(address);
+  shmInfo.readOnly = False;
+
+  // XShmAttach在远程显示上会产生BadAccess，Xlib默认会直接退出进程，附加期间在本连接上捕获错误
+  bool attachFailed = false;
+  {
+    XErrorTrap trap(display);
+    XShmAttach(display, &shmInfo);
+    attachFailed = trap.Sync() != Success;
+  }
+
+  // 所有进程分离后自动释放共享内存段
+  shmctl(shmInfo.shmid, IPC_RMID, nullptr);
+
+  if (attachFailed) {
+    shmdt(shmInfo.shmaddr);
+    shmImage->data = nullptr;
+    XDestroyImage(shmImage);
+    shmImage = nullptr;
+    return;
+  }
+  shmAvailable = true;
+}
+
+void ScreenCapture::ReleaseShm() {
+  if (shmImage == nullptr) {
+    return;
+  }
+  if (shmAvailable) {
+    XShmDetach(display, &shmInfo);
+    XSync(display, False);
+  }
+  shmdt(shmInfo.shmaddr);
+  shmImage->data = nullptr;  // 数据位于共享内存，不能交给XDestroyImage释放
+  XDestroyImage(shmImage);
+  shmImage = nullptr;
+  shmAvailable = false;
+}
+
+Rect ScreenCapture::RootBounds() const {
+  return {0, 0, rootWidth, rootHeight};
+}
+
+bool ScreenCapture::UsingShm() const {
+  return shmAvailable;
+}
+
+ImageView ScreenCapture::Capture(Rect region) {
+  const Rect clipped = ClipRegion(region, rootWidth, rootHeight);
+  if (clipped.width == 0 || clipped.height == 0) {
+    return {};
+  }
+  generation++;
+  if (!shmAvailable) {
+    return CaptureFallback(clipped);
+  }
+
+  // 复用同一块共享内存，只调整图像头中的尺寸
+  shmImage->width = clipped.width;
+  shmImage->height = clipped.height;
+  shmImage->bytes_per_line = clipped.width * 4;
+  if (!XShmGetImage(display, rootWindow, shmImage, clipped.x, clipped.y, AllPlanes)) {
+    return CaptureFallback(clipped);
+  }
+
+  ImageView view;
+  view.data = reinterpret_cast<const uint8_t*>(shmImage->data);
+  view.width = clipped.width;
+  view.height = clipped.height;
+  view.stride = shmImage->bytes_per_line;
+  return view;
+}
+
+ImageView ScreenCapture::CaptureFallback(Rect region) {
+  XImage* image = XGetImage(display, rootWindow, region.x, region.y,
+                            static_cast<unsigned int>(region.width),
+                            static_cast<unsigned int>(region.height), AllPlanes, ZPixmap);
+  if (image == nullptr) {
+    return {};
+  }
+
+  const size_t rowBytes = static_cast<size_t>(region.width) * 4;
+  if (fallbackBuffer.size() < rowBytes * region.height) {
+    fallbackBuffer.resize(static_cast<size_t>(rootWidth) * rootHeight * 4);
+  }
+  if (image->bits_per_pixel == 32) {
+    for (int y = 0; y < region.height; y++) {
+      memcpy(fallbackBuffer.data() + rowBytes * y, image->data + static_cast<size_t>(y) * image->bytes_per_line,
+             rowBytes);
+    }
+  } else {
+    // 非32位格式逐像素转换
+    for (int y = 0; y < region.height; y++) {
+      uint8_t* row = fallbackBuffer.data() + rowBytes * y;
+      for (int x = 0; x < region.width; x++) {
+        const unsigned long pixel = XGetPixel(image, x, y);
+        row[x * 4 + 0] = static_cast<uint8_t>((pixel & image->blue_mask) * 255 / image->blue_mask);
+        row[x * 4 + 1] = static_cast<uint8_t>((pixel & image->green_mask) * 255 / image->green_mask);
+        row[x * 4 + 2] = static_cast<uint8_t>((pixel & image->red_mask) * 255 / image->red_mask);
+        row[x * 4 + 3] = 255;
+      }
+    }
+  }
+  XDestroyImage(image);
+
+  ImageView view;
+  view.data = fallbackBuffer.data();
+  view.width = region.width;
+  view.height = region.height;
+  view.stride = static_cast<int>(rowBytes);
+  return view;
+}
+
+ImageView ScreenCapture::CaptureFull() {
+  return Capture(RootBounds());
+}
+
+#else
+
+ScreenCapture::ScreenCapture() {
+  throw std::runtime_error("ScreenCapture is only supported on Linux X11");
+}
+
+ScreenCapture::~ScreenCapture() = default;
+
+ImageView ScreenCapture::Capture(Rect) { return {}; }
+
+ImageView ScreenCapture::CaptureFull() { return {}; }
+
+Rect ScreenCapture::RootBounds() const { return {0, 0, 0, 0}; }
+
+bool ScreenCapture::UsingShm() const { return false; }
+
+#endif
+
+}  // namespace Robot
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "./types.h"
+
+#include <cstdint>
+#include <vector>
+
+#ifdef __linux__
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+#include <X11/extensions/XShm.h>
+#endif
+
+namespace Robot {
+
+// 非拥有的BGRA图像视图（每像素4字节，字节顺序B、G、R、A，A通道内容未定义）
+// 指向采集器内部缓冲区，在同一采集器的下一次采集之后失效
+struct ImageView {
+  const uint8_t* data = nullptr;
+  int width = 0;
+  int height = 0;
+  int stride = 0;  // 每行字节数
+
+  const uint8_t* Row(int y) const { return data + static_cast<size_t>(y) * stride; }
+  const uint8_t* Pixel(int x, int y) const { return Row(y) + static_cast<size_t>(x) * 4; }
+  bool Empty() const { return data == nullptr || width <= 0 || height <= 0; }
+  Color ColorAt(int x, int y) const {
+    const uint8_t* p = Pixel(x, y);
+    return {p[2], p[1], p[0]};
+  }
+};
+
+// 基于MIT-SHM的屏幕采集器
+// 共享内存段按整个根窗口大小一次性分配并重复使用，区域采集只修改XImage的尺寸字段，
+// 因此每次采集只有一次服务端拷贝，没有socket传输，也没有堆分配。
+// 服务器不支持MIT-SHM（如远程显示）时回退到XGetImage。
+// 每个实例持有独立的X连接，实例本身不是线程安全的。
+class ScreenCapture {
+ public:
+  ScreenCapture();
+  ~ScreenCapture();
+
+  ScreenCapture(const ScreenCapture&) = delete;
+  ScreenCapture& operator=(const ScreenCapture&) = delete;
+
+  // 采集虚拟桌面上的矩形区域，区域会被裁剪到根窗口范围内
+  ImageView Capture(Rect region);
+
+  // 采集整个虚拟桌面
+  ImageView CaptureFull();
+
+  // 根窗口（虚拟桌面）范围
+  Rect RootBounds() const;
+
+  bool UsingShm() const;
+
+  // 每次采集递增，用于判断之前返回的视图是否已被覆盖
+  uint64_t Generation() const { return generation; }
+
+ private:
+#ifdef __linux__
+  void InitShm();
+  void ReleaseShm();
+  ImageView CaptureFallback(Rect region);
+
+  Display* display = nullptr;
+  Window rootWindow = 0;
+  int rootWidth = 0;
+  int rootHeight = 0;
+
+  XShmSegmentInfo shmInfo{};
+  XImage* shmImage = nullptr;
+  bool shmAvailable = false;
+
+  std::vector<uint8_t> fallbackBuffer;
+#endif
+  uint64_t generation = 0;
+};
+
+}  // namespace Robot
@@ -0,0 +1,866 @@
+#include "Autogui.h"
+#include "Utils.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+#ifdef __linux__
+#include <unistd.h>
+#include <X11/XKBlib.h>
+#include <X11/extensions/XTest.h>
+#include <X11/extensions/Xrandr.h>
+#endif
+
+namespace AutoGUI {
+
+namespace {
+
+// 与Robot::Mouse/Keyboard的时序保持一致
+constexpr int kKeyDelayMs = 1;
+constexpr int kButtonDelayMs = 10;
+constexpr int kDoubleClickGapMs = 80;
+constexpr int kHotkeyHoldMs = 50;
+
+} // namespace
+
+Session& defaultSession() {
+  static Session session;
+  return session;
+}
+
+#ifdef __linux__
+
+namespace {
+
+unsigned int buttonCode(Button button) {
+  switch (button) {
+    case Button::RIGHT: return 3;
+    case Button::MIDDLE: return 2;
+    default: return 1;
+  }
+}
+
+Backend resolveBackend(Backend requested) {
+  if (requested != Backend::DEFAULT) {
+    return requested;
+  }
+  if (const char *name = std::getenv("AUTOGUI_BACKEND")) {
+    if (std::strcmp(name, "xlib") == 0) {
+      return Backend::XLIB;
+    }
+    if (std::strcmp(name, "uinput") == 0) {
+      return Backend::UINPUT;
+    }
+  }
+  return Backend::XLIB;
+}
+
+} // namespace
+
+Session::Session(const std::string &displayName, Backend backend)
+    : name(displayName), activeBackend(resolveBackend(backend)) {
+  display = XOpenDisplay(displayName.empty() ? nullptr : displayName.c_str());
+  if (display == nullptr) {
+    throw AutoGUIException("Cannot open X11 display: " + (displayName.empty() ? std::string("$DISPLAY") : displayName));
+  }
+  if (name.empty()) {
+    name = DisplayString(display);
+  }
+  rootWindow = DefaultRootWindow(display);
+
+  int eventBase = 0, errorBase = 0, major = 0, minor = 0;
+  if (!XTestQueryExtension(display, &eventBase, &errorBase, &major, &minor)) {
+    XCloseDisplay(display);
+    display = nullptr;
+    throw AutoGUIException("XTest extension is not available on display " + name);
+  }
+
+  // 订阅屏幕配置变化，屏幕缓存只在收到通知后失效
+  if (XRRQueryExtension(display, &randrEventBase, &errorBase)) {
+    XRRSelectInput(display, rootWindow,
+                   RRScreenChangeNotifyMask | RRCrtcChangeNotifyMask | RROutputChangeNotifyMask);
+  } else {
+    randrEventBase = -1;
+  }
+  if (activeBackend == Backend::UINPUT) {
+    // 绝对坐标范围取整个根窗口，与XTest的坐标系一致
+    const int screen = DefaultScreen(display);
+    try {
+      uinput = std::make_unique<Robot::UInput>(DisplayWidth(display, screen), DisplayHeight(display, screen));
+    } catch (const std::exception &e) {
+      XCloseDisplay(display);
+      display = nullptr;
+      throw AutoGUIException(e.what());
+    }
+  }
+  loadKeymap();
+}
+
+Session::~Session() {
+  if (display != nullptr) {
+    // 析构函数中不能抛出异常；uinput写入失败时按键可能仍处于按下状态，但连接照常关闭
+    try {
+      releaseAll();
+    } catch (const AutoGUIException &) {
+    }
+    XSync(display, False);
+    XCloseDisplay(display);
+  }
+}
+
+void Session::pollEvents() {
+  bool keymapChanged = false;
+  while (XPending(display) > 0) {
+    XEvent event;
+    XNextEvent(display, &event);
+    if (randrEventBase >= 0 &&
+        (event.type == randrEventBase + RRScreenChangeNotify || event.type == randrEventBase + RRNotify)) {
+      XRRUpdateConfiguration(&event);
+      screensValid = false;
+    } else if (event.type == MappingNotify) {
+      XRefreshKeyboardMapping(&event.xmapping);
+      keymapChanged = keymapChanged || event.xmapping.request != MappingPointer;
+    }
+  }
+  if (keymapChanged) {
+    loadKeymap();
+  }
+}
+
+void Session::loadKeymap() {
+  keycodes.clear();
+  shiftKeycode = XKeysymToKeycode(display, XK_Shift_L);
+  for (int c = 0; c < 128; c++) {
+    AsciiKey &key = asciiKeys[c];
+    key = AsciiKey{};
+    if (!Robot::KeyUtils::IsValidAscii(static_cast<char>(c))) {
+      continue;
+    }
+    const KeySym keysym = Robot::Keyboard::AsciiToVirtualKey(static_cast<char>(c));
+    key.keycode = XKeysymToKeycode(display, keysym);
+    if (key.keycode == 0) {
+      continue;
+    }
+    // AsciiToVirtualKey对字母返回小写keysym；其余字符按当前布局中该键位的第二级（Shift级）判断
+    key.shift = std::isupper(c) != 0 ||
+                (XkbKeycodeToKeysym(display, key.keycode, 0, 0) != keysym &&
+                 XkbKeycodeToKeysym(display, key.keycode, 0, 1) == keysym);
+  }
+}
+
+unsigned int Session::keycodeFor(unsigned long keysym) {
+  auto it = keycodes.find(keysym);
+  if (it != keycodes.end()) {
+    return it->second;
+  }
+  const unsigned int keycode = XKeysymToKeycode(display, keysym);
+  keycodes.emplace(keysym, keycode);
+  return keycode;
+}
+
+InputStatus Session::lookupKey(const std::string &key, unsigned int &keycode, bool &shift) {
+  keycode = 0;
+  shift = false;
+  // 单个字符查预先计算的表，其余按共用的键名表不区分大小写地查找，都不构造std::string
+  if (key.length() == 1) {
+    const auto c = static_cast<unsigned char>(std::tolower(static_cast<unsigned char>(key[0])));
+    if (c < 128) {
+      shift = asciiKeys[c].shift;
+      keycode = asciiKeys[c].keycode;
+    }
+  } else if (const SpecialKeyName *entry = findSpecialKey(key)) {
+    keycode = keycodeFor(Robot::Keyboard::SpecialKeyToVirtualKey(entry->key));
+  } else {
+    return InputStatus::UNKNOWN_KEY;
+  }
+  return keycode != 0 ? InputStatus::OK : InputStatus::UNMAPPED_KEY;
+}
+
+InputStatus Session::sendNamedKey(const std::string &key, KeyAction action) {
+  pollEvents();
+  // 单个字符与type一致，需要Shift的符号自动按下Shift；特殊键的shift总为false
+  unsigned int keycode = 0;
+  bool shift = false;
+  const InputStatus status = lookupKey(key, keycode, shift);
+  if (status != InputStatus::OK) {
+    return status;
+  }
+  switch (action) {
+    case KeyAction::PRESS: clickKeycode(keycode, shift); break;
+    case KeyAction::DOWN: sendKey(keycode, true); break;
+    case KeyAction::UP: sendKey(keycode, false); break;
+  }
+  return status;
+}
+
+void Session::emitKey(unsigned int keycode, bool down) {
+  if (uinput) {
+    // X服务器的键码为evdev键码加8
+    if (keycode >= 8) {
+      uinput->Key(static_cast<uint16_t>(keycode - 8), down);
+    }
+    return;
+  }
+  XTestFakeKeyEvent(display, keycode, down ? True : False, CurrentTime);
+}
+
+void Session::emitButton(unsigned int button, bool down) {
+  if (uinput) {
+    switch (button) {
+      case 1: uinput->Key(Robot::UInput::ButtonCode(Robot::MouseButton::LEFT_BUTTON), down); break;
+      case 2: uinput->Key(Robot::UInput::ButtonCode(Robot::MouseButton::CENTER_BUTTON), down); break;
+      case 3: uinput->Key(Robot::UInput::ButtonCode(Robot::MouseButton::RIGHT_BUTTON), down); break;
+      // 滚轮按钮4-7只在按下时产生一格滚动
+      case 4: case 5: case 6: case 7:
+        if (down) {
+          uinput->Wheel(button == 4 ? 1 : button == 5 ? -1 : 0, button == 7 ? 1 : button == 6 ? -1 : 0);
+        }
+        break;
+      default: break;
+    }
+    return;
+  }
+  XTestFakeButtonEvent(display, button, down ? True : False, CurrentTime);
+}
+
+void Session::emitMotion(int x, int y) {
+  if (uinput) {
+    uinput->Move(x, y);
+    // 与设备的绝对坐标范围一致，超出部分被截断
+    const int screen = DefaultScreen(display);
+    uinputPosition = {std::clamp(x, 0, DisplayWidth(display, screen) - 1),
+                      std::clamp(y, 0, DisplayHeight(display, screen) - 1)};
+    uinputPositionValid = true;
+    return;
+  }
+  XTestFakeMotionEvent(display, -1, x, y, CurrentTime);
+}
+
+void Session::flushOutput() {
+  if (uinput) {
+    try {
+      uinput->Sync();
+    } catch (const std::runtime_error &e) {
+      throw AutoGUIException(e.what());
+    }
+    return;
+  }
+  XFlush(display);
+}
+
+void Session::pace() {
+  if (!pacing) {
+    Robot::delay(kKeyDelayMs);
+    return;
+  }
+  // uinput事件经内核异步到达X服务器，X往返延迟与其无关
+  if (!pacer.Wait() || uinput) {
+    return;
+  }
+  // 往返请求在此前发出的所有请求处理完后才会得到应答，服务器端排队越多耗时越长
+  const auto begin = std::chrono::steady_clock::now();
+  XSync(display, False);
+  pacer.Record(std::chrono::steady_clock::now() - begin);
+}
+
+void Session::sendKey(unsigned int keycode, bool down) {
+  pace();
+  emitKey(keycode, down);
+  flushOutput();
+  if (down) {
+    heldKeys.push_back(keycode);
+  } else {
+    auto it = std::find(heldKeys.begin(), heldKeys.end(), keycode);
+    if (it != heldKeys.end()) {
+      heldKeys.erase(it);
+    }
+  }
+}
+
+void Session::clickKeycode(unsigned int keycode, bool shift) {
+  if (keycode == 0) {
+    return;
+  }
+  shift = shift && shiftKeycode != 0;
+  if (shift) {
+    sendKey(shiftKeycode, true);
+  }
+  sendKey(keycode, true);
+  sendKey(keycode, false);
+  if (shift) {
+    sendKey(shiftKeycode, false);
+  }
+}
+
+void Session::clickChar(char c) {
+  const AsciiKey &key = asciiKeys[static_cast<unsigned char>(c) & 0x7f];
+  clickKeycode(key.keycode, key.shift);
+}
+
+void Session::type(const std::string &text, double interval) {
+  pollEvents();
+  for (char c : text) {
+    if (!Robot::KeyUtils::IsValidAscii(c)) {
+      std::cerr << "Warning: Skipping invalid ASCII character: " << static_cast<int>(c) << std::endl;
+      continue;
+    }
+    clickChar(c);
+    if (interval > 0) {
+      sleep(interval);
+    }
+  }
+}
+
+void Session::typeSchedule(const std::vector<Robot::Keystroke> &schedule) {
+  pollEvents();
+  // 先把整张时间表解析为键码，执行循环中只剩等待与发送
+  struct ResolvedKey {
+    unsigned int keycode;
+    bool shift;
+  };
+  std::vector<ResolvedKey> resolved;
+  resolved.reserve(schedule.size());
+  const unsigned int returnKeycode = keycodeFor(XK_Return);
+  const unsigned int tabKeycode = keycodeFor(XK_Tab);
+  const unsigned int backspaceKeycode = keycodeFor(XK_BackSpace);
+  for (const Robot::Keystroke &keystroke : schedule) {
+    switch (keystroke.character) {
+      case '\n': resolved.push_back({returnKeycode, false}); break;
+      case '\t': resolved.push_back({tabKeycode, false}); break;
+      case '\b': resolved.push_back({backspaceKeycode, false}); break;
+      default: {
+        const AsciiKey &key = asciiKeys[static_cast<unsigned char>(keystroke.character) & 0x7f];
+        resolved.push_back({key.keycode, key.shift && shiftKeycode != 0});
+        break;
+      }
+    }
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < schedule.size(); i++) {
+    const ResolvedKey &key = resolved[i];
+    if (key.keycode == 0) {
+      continue;
+    }
+    const auto pressAt = start + schedule[i].offset;
+    Robot::delayUntil(pressAt);
+    if (key.shift) {
+      emitKey(shiftKeycode, true);
+    }
+    emitKey(key.keycode, true);
+    flushOutput();
+    Robot::delayUntil(pressAt + schedule[i].hold);
+    emitKey(key.keycode, false);
+    if (key.shift) {
+      emitKey(shiftKeycode, false);
+    }
+    flushOutput();
+  }
+}
+
+void Session::press(const std::string &key) {
+  if (sendNamedKey(key, KeyAction::PRESS) == InputStatus::UNKNOWN_KEY) {
+    throw AutoGUIException("Unknown key: " + key);
+  }
+}
+
+void Session::keyDown(const std::string &key) {
+  if (sendNamedKey(key, KeyAction::DOWN) == InputStatus::UNKNOWN_KEY) {
+    throw AutoGUIException("Unknown key: " + key);
+  }
+}
+
+void Session::keyUp(const std::string &key) {
+  if (sendNamedKey(key, KeyAction::UP) == InputStatus::UNKNOWN_KEY) {
+    throw AutoGUIException("Unknown key: " + key);
+  }
+}
+
+void Session::releaseAll() {
+  for (auto it = heldKeys.rbegin(); it != heldKeys.rend(); ++it) {
+    emitKey(*it, false);
+  }
+  heldKeys.clear();
+  for (unsigned int code = 1; code <= 3; code++) {
+    if (heldButtons & (1u << code)) {
+      emitButton(code, false);
+    }
+  }
+  heldButtons = 0;
+  flushOutput();
+}
+
+void Session::toggleButton(bool down, Button button) {
+  const unsigned int code = buttonCode(button);
+  emitButton(code, down);
+  flushOutput();
+  if (down) {
+    heldButtons |= 1u << code;
+  } else {
+    heldButtons &= ~(1u << code);
+  }
+}
+
+void Session::moveTo(int x, int y, double duration) {
+  if (duration > 0.0) {
+    moveSmooth({x, y});
+    return;
+  }
+  emitMotion(x, y);
+  flushOutput();
+}
+
+Robot::Point Session::position() {
+  // uinput事件经内核异步到达X服务器，此时查询X可能得到移动之前的位置，因此返回最近发出的坐标
+  if (uinput && uinputPositionValid) {
+    return uinputPosition;
+  }
+  // XTest请求与查询在同一连接上按顺序处理，此前发出的移动一定已经生效，无需像Mouse::GetPosition那样等待
+  ::Window rootReturn = 0, childReturn = 0;
+  int rootX = 0, rootY = 0, winX = 0, winY = 0;
+  unsigned int mask = 0;
+  XQueryPointer(display, rootWindow, &rootReturn, &childReturn, &rootX, &rootY, &winX, &winY, &mask);
+  return {rootX, rootY};
+}
+
+void Session::scroll(int clicks, int x) {
+  // 4=上 5=下 6=左 7=右
+  const auto send = [this](unsigned int code, int count) {
+    for (int i = 0; i < count; i++) {
+      emitButton(code, true);
+      emitButton(code, false);
+      flushOutput();
+      Robot::delay(kButtonDelayMs);
+    }
+  };
+  if (clicks != 0) {
+    send(clicks > 0 ? 4 : 5, std::abs(clicks));
+  }
+  if (x != 0) {
+    send(x > 0 ? 7 : 6, std::abs(x));
+  }
+}
+
+void Session::loadScreens() {
+  screens.clear();
+  if (randrEventBase >= 0) {
+    // Current版本只返回服务器已知的配置，不会触发可能耗时数百毫秒的输出探测
+    XRRScreenResources *resources = XRRGetScreenResourcesCurrent(display, rootWindow);
+    if (resources != nullptr) {
+      const RROutput primary = XRRGetOutputPrimary(display, rootWindow);
+      for (int i = 0; i < resources->noutput; i++) {
+        XRROutputInfo *output = XRRGetOutputInfo(display, resources, resources->outputs[i]);
+        if (output == nullptr) {
+          continue;
+        }
+        if (output->connection == RR_Connected && output->crtc) {
+          XRRCrtcInfo *crtc = XRRGetCrtcInfo(display, resources, output->crtc);
+          if (crtc != nullptr) {
+            screens.push_back({i, crtc->x, crtc->y, static_cast<int>(crtc->width),
+                               static_cast<int>(crtc->height), resources->outputs[i] == primary});
+            XRRFreeCrtcInfo(crtc);
+          }
+        }
+        XRRFreeOutputInfo(output);
+      }
+      XRRFreeScreenResources(resources);
+    }
+  }
+  if (screens.empty()) {
+    // 无RandR或无活动输出（如部分Xvfb配置）：整个根窗口作为一个屏幕
+    const int screen = DefaultScreen(display);
+    screens.push_back({0, 0, 0, DisplayWidth(display, screen), DisplayHeight(display, screen), true});
+  } else if (std::none_of(screens.begin(), screens.end(), [](const ScreenInfo &s) { return s.isPrimary; })) {
+    // 未设置主输出时，第一个已连接的输出视为主屏
+    screens.front().isPrimary = true;
+  }
+  screensValid = true;
+}
+
+std::vector<ScreenInfo> Session::getAllScreens() {
+  pollEvents();
+  if (!screensValid) {
+    loadScreens();
+  }
+  return screens;
+}
+
+Robot::Point Session::size() {
+  pollEvents();
+  if (!screensValid) {
+    loadScreens();
+  }
+  for (const auto &screen : screens) {
+    if (screen.isPrimary) {
+      return {screen.width, screen.height};
+    }
+  }
+  return {screens.front().width, screens.front().height};
+}
+
+void Session::invalidateScreenCache() { screensValid = false; }
+
+#else
+
+Session::Session(const std::string &displayName, Backend) : name(displayName) {}
+
+void Session::pace() {
+  if (!pacing) {
+    Robot::delay(kKeyDelayMs);
+    return;
+  }
+  pacer.Wait();
+}
+
+InputStatus Session::sendNamedKey(const std::string &key, KeyAction action) {
+  if (key.length() == 1) {
+    const char c = static_cast<char>(std::tolower(static_cast<unsigned char>(key[0])));
+    switch (action) {
+      case KeyAction::PRESS: Robot::Keyboard::Click(c); break;
+      case KeyAction::DOWN: Robot::Keyboard::Press(c); break;
+      case KeyAction::UP: Robot::Keyboard::Release(c); break;
+    }
+  } else if (const SpecialKeyName *entry = findSpecialKey(key)) {
+    switch (action) {
+      case KeyAction::PRESS: Robot::Keyboard::Click(entry->key); break;
+      case KeyAction::DOWN: Robot::Keyboard::Press(entry->key); break;
+      case KeyAction::UP: Robot::Keyboard::Release(entry->key); break;
+    }
+  } else {
+    return InputStatus::UNKNOWN_KEY;
+  }
+  return InputStatus::OK;
+}
+
+Session::~Session() = default;
+
+void Session::type(const std::string &text, double interval) {
+  if (interval > 0.0) {
+    for (char c : text) {
+      Robot::Keyboard::Click(c);
+      sleep(interval);
+    }
+  } else {
+    Robot::Keyboard::Type(text);
+  }
+}
+
+void Session::typeSchedule(const std::vector<Robot::Keystroke> &schedule) {
+  const auto start = std::chrono::steady_clock::now();
+  for (const Robot::Keystroke &keystroke : schedule) {
+    Robot::delayUntil(start + keystroke.offset);
+    if (keystroke.character == '\b') {
+      Robot::Keyboard::Click(Robot::Keyboard::BACKSPACE);
+    } else {
+      Robot::Keyboard::Click(keystroke.character);
+    }
+  }
+}
+
+void Session::press(const std::string &key) {
+  if (sendNamedKey(key, KeyAction::PRESS) == InputStatus::UNKNOWN_KEY) {
+    throw AutoGUIException("Unknown key: " + key);
+  }
+}
+
+void Session::keyDown(const std::string &key) {
+  if (sendNamedKey(key, KeyAction::DOWN) == InputStatus::UNKNOWN_KEY) {
+    throw AutoGUIException("Unknown key: " + key);
+  }
+}
+
+void Session::keyUp(const std::string &key) {
+  if (sendNamedKey(key, KeyAction::UP) == InputStatus::UNKNOWN_KEY) {
+    throw AutoGUIException("Unknown key: " + key);
+  }
+}
+
+void Session::releaseAll() {}
+
+void Session::toggleButton(bool down, Button button) {
+  Robot::Mouse::ToggleButton(down, toRobotButton(button));
+}
+
+void Session::moveTo(int x, int y, double duration) {
+  if (duration > 0.0) {
+    moveSmooth({x, y});
+  } else {
+    Robot::Mouse::Move({x, y});
+  }
+}
+
+Robot::Point Session::position() { return Robot::Mouse::GetPosition(); }
+
+void Session::scroll(int clicks, int x) { Robot::Mouse::ScrollBy(clicks, x); }
+
+std::vector<ScreenInfo> Session::getAllScreens() {
+#ifdef _WIN32
+  return AutoGUI::getAllScreens();
+#else
+  const Robot::Point screenSize = AutoGUI::size();
+  return {{0, 0, 0, screenSize.x, screenSize.y, true}};
+#endif
+}
+
+Robot::Point Session::size() { return AutoGUI::size(); }
+
+void Session::invalidateScreenCache() {}
+
+#endif
+
+// 以下基于平台相关的基本操作实现，各平台共用
+
+void Session::setPacing(bool enabled, const Robot::PacingOptions &options) {
+  pacing = enabled;
+  pacer.Reset(options);
+}
+
+void Session::moveSmooth(Robot::Point target) {
+  // 与Mouse::MoveSmooth相同：每像素一步，步间隔由限速器决定（关闭时为1ms）
+  const Robot::Point start = position();
+  const int dx = target.x - start.x;
+  const int dy = target.y - start.y;
+  const int steps = std::max(std::abs(dx), std::abs(dy));
+  for (int i = 1; i <= steps; i++) {
+    pace();
+    moveTo(start.x + dx * i / steps, start.y + dy * i / steps);
+  }
+}
+
+void Session::moveRel(int xOffset, int yOffset, double duration) {
+  const Robot::Point current = position();
+  moveTo(current.x + xOffset, current.y + yOffset, duration);
+}
+
+void Session::click(int x, int y, Button button, int clicks, double interval) {
+  if (x >= 0 && y >= 0) {
+    moveTo(x, y);
+    Robot::delay(kButtonDelayMs);
+  }
+  for (int i = 0; i < clicks; i++) {
+    if (i > 0) {
+      // 未指定间隔时使用与Mouse::DoubleClick相同的间隔，保证被识别为双击/三击
+      if (interval > 0) {
+        sleep(interval);
+      } else {
+        Robot::delay(kDoubleClickGapMs);
+      }
+    }
+    toggleButton(true, button);
+    Robot::delay(kButtonDelayMs);
+    toggleButton(false, button);
+  }
+}
+
+void Session::mouseDown(Button button, int x, int y) {
+  if (x >= 0 && y >= 0) {
+    moveTo(x, y);
+    Robot::delay(kButtonDelayMs);
+  }
+  toggleButton(true, button);
+}
+
+void Session::mouseUp(Button button, int x, int y) {
+  if (x >= 0 && y >= 0) {
+    moveTo(x, y);
+    Robot::delay(kButtonDelayMs);
+  }
+  toggleButton(false, button);
+}
+
+void Session::drag(int x1, int y1, int x2, int y2, double duration, Button button) {
+  if (!isValidCoord(x1, y1)) {
+    throw AutoGUIException("Invalid start coordinates: (" + std::to_string(x1) + ", " + std::to_string(y1) + ")");
+  }
+  if (!isValidCoord(x2, y2)) {
+    throw AutoGUIException("Invalid end coordinates: (" + std::to_string(x2) + ", " + std::to_string(y2) + ")");
+  }
+  if (duration < 0) {
+    throw AutoGUIException("Duration cannot be negative");
+  }
+  performDrag(x1, y1, x2, y2, duration, button);
+}
+
+void Session::performDrag(int x1, int y1, int x2, int y2, double duration, Button button) {
+  moveTo(x1, y1);
+  Robot::delay(kButtonDelayMs);
+  toggleButton(true, button);
+  Robot::delay(kButtonDelayMs);
+  moveTo(x2, y2, duration);
+  Robot::delay(kButtonDelayMs);
+  toggleButton(false, button);
+}
+
+void Session::dragTo(int x, int y, double duration, Button button) {
+  const Robot::Point current = position();
+  if (current.x == x && current.y == y) {
+    click(x, y, button);
+    return;
+  }
+  drag(current.x, current.y, x, y, duration, button);
+}
+
+void Session::dragRel(int xOffset, int yOffset, double duration, Button button) {
+  const Robot::Point current = position();
+  if (xOffset == 0 && yOffset == 0) {
+    click(current.x, current.y, button);
+    return;
+  }
+  drag(current.x, current.y, current.x + xOffset, current.y + yOffset, duration, button);
+}
+
+void Session::hotkey(const std::vector<std::string> &keys) {
+  for (const auto &key : keys) {
+    keyDown(key);
+  }
+  Robot::delay(kHotkeyHoldMs);
+  for (auto it = keys.rbegin(); it != keys.rend(); ++it) {
+    keyUp(*it);
+  }
+}
+
+bool Session::isValidCoord(int x, int y) {
+  const Robot::Point screenSize = size();
+  return x >= 0 && x < screenSize.x && y >= 0 && y < screenSize.y;
+}
+
+// 以下try*版本先做与抛出版本相同的检查，错误时只返回状态码；
+// 其余意外错误（如内存不足）统一返回FAILED
+InputStatus Session::tryMoveTo(int x, int y, double duration) noexcept {
+  try {
+    if (!isValidCoord(x, y)) {
+      return InputStatus::INVALID_COORDINATES;
+    }
+    if (duration < 0) {
+      return InputStatus::INVALID_ARGUMENT;
+    }
+    moveTo(x, y, duration);
+    return InputStatus::OK;
+  } catch (...) {
+    return InputStatus::FAILED;
+  }
+}
+
+InputStatus Session::tryClick(int x, int y, Button button, int clicks, double interval) noexcept {
+  try {
+    if (!(x == -1 && y == -1) && !isValidCoord(x, y)) {
+      return InputStatus::INVALID_COORDINATES;
+    }
+    if (clicks < 0 || interval < 0) {
+      return InputStatus::INVALID_ARGUMENT;
+    }
+    click(x, y, button, clicks, interval);
+    return InputStatus::OK;
+  } catch (...) {
+    return InputStatus::FAILED;
+  }
+}
+
+InputStatus Session::tryDrag(int x1, int y1, int x2, int y2, double duration, Button button) noexcept {
+  try {
+    if (!isValidCoord(x1, y1) || !isValidCoord(x2, y2)) {
+      return InputStatus::INVALID_COORDINATES;
+    }
+    if (duration < 0) {
+      return InputStatus::INVALID_ARGUMENT;
+    }
+    performDrag(x1, y1, x2, y2, duration, button);
+    return InputStatus::OK;
+  } catch (...) {
+    return InputStatus::FAILED;
+  }
+}
+
+InputStatus Session::tryPress(const std::string &key) noexcept {
+  try {
+    return sendNamedKey(key, KeyAction::PRESS);
+  } catch (...) {
+    return InputStatus::FAILED;
+  }
+}
+
+InputStatus Session::tryKeyDown(const std::string &key) noexcept {
+  try {
+    return sendNamedKey(key, KeyAction::DOWN);
+  } catch (...) {
+    return InputStatus::FAILED;
+  }
+}
+
+InputStatus Session::tryKeyUp(const std::string &key) noexcept {
+  try {
+    return sendNamedKey(key, KeyAction::UP);
+  } catch (...) {
+    return InputStatus::FAILED;
+  }
+}
+
+const char *inputStatusToString(InputStatus status) noexcept {
+  switch (status) {
+    case InputStatus::OK: return "ok";
+    case InputStatus::INVALID_COORDINATES: return "invalid coordinates";
+    case InputStatus::INVALID_ARGUMENT: return "invalid argument";
+    case InputStatus::UNKNOWN_KEY: return "unknown key";
+    case InputStatus::UNMAPPED_KEY: return "key not in current keyboard layout";
+    case InputStatus::NO_DISPLAY: return "cannot open display";
+    case InputStatus::FAILED: return "failed";
+  }
+  return "failed";
+}
+
+std::vector<BackendBenchmark> benchmarkBackends(const std::string &displayName, int iterations) {
+  std::vector<BackendBenchmark> results;
+#ifdef __linux__
+  std::vector<Backend> backends = {Backend::XLIB};
+  // 没有/dev/uinput权限时跳过；uinput事件经内核异步到达X服务器，其移动速率只反映注入开销，
+  // position()返回会话记录的坐标，查询延迟也不含X往返
+  if (access("/dev/uinput", W_OK) == 0) {
+    backends.push_back(Backend::UINPUT);
+  }
+  iterations = std::max(1, iterations);
+  using Clock = std::chrono::steady_clock;
+  const auto microseconds = [](Clock::duration elapsed) {
+    return std::chrono::duration<double, std::micro>(elapsed).count();
+  };
+
+  for (const Backend backend : backends) {
+    Session session(displayName, backend);
+    const Robot::Point origin = session.position();
+    BackendBenchmark result{backend, 0.0, 0.0, 0.0};
+
+    // 发送全部移动事件后查询一次指针位置，应答到达即说明服务器已处理完此前的事件
+    auto begin = Clock::now();
+    for (int i = 0; i < iterations; i++) {
+      session.moveTo(origin.x + (i & 63), origin.y);
+    }
+    session.position();
+    result.motionEventsPerSecond = iterations / (microseconds(Clock::now() - begin) / 1e6);
+    session.moveTo(origin.x, origin.y);
+
+    begin = Clock::now();
+    for (int i = 0; i < iterations; i++) {
+      session.position();
+    }
+    result.pointerQueryMicroseconds = microseconds(Clock::now() - begin) / iterations;
+
+    begin = Clock::now();
+    for (int i = 0; i < iterations; i++) {
+      session.invalidateScreenCache();
+      session.getAllScreens();
+    }
+    result.screenQueryMicroseconds = microseconds(Clock::now() - begin) / iterations;
+    results.push_back(result);
+  }
+#else
+  (void)displayName;
+  (void)iterations;
+#endif
+  return results;
+}
+
+} // namespace AutoGUI
@@ -0,0 +1,657 @@
+#include "./Simd.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <random>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define ROBOT_SIMD_X86 1
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#define ROBOT_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace Robot {
+namespace Simd {
+
+namespace {
+
+// ---------------- 标量实现 ----------------
+
+uint32_t SadScalar(const uint8_t* a, const uint8_t* b, int n) {
+  uint32_t sum = 0;
+  for (int i = 0; i < n; i++) {
+    sum += static_cast<uint32_t>(std::abs(a[i] - b[i]));
+  }
+  return sum;
+}
+
+uint64_t SsdScalar(const uint8_t* a, const uint8_t* b, int n) {
+  uint64_t sum = 0;
+  for (int i = 0; i < n; i++) {
+    const int d = a[i] - b[i];
+    sum += static_cast<uint64_t>(d * d);
+  }
+  return sum;
+}
+
+int32_t DotScalar(const uint8_t* a, const int16_t* b, int n) {
+  int32_t sum = 0;
+  for (int i = 0; i < n; i++) {
+    sum += a[i] * b[i];
+  }
+  return sum;
+}
+
+uint32_t ChangedMaskScalar(const uint8_t* a, const uint8_t* b, int pixels, uint8_t tolerance) {
+  uint32_t mask = 0;
+  for (int i = 0; i < pixels; i++) {
+    const uint8_t* pa = a + i * 4;
+    const uint8_t* pb = b + i * 4;
+    if (std::abs(pa[0] - pb[0]) > tolerance || std::abs(pa[1] - pb[1]) > tolerance ||
+        std::abs(pa[2] - pb[2]) > tolerance) {
+      mask |= 1u << i;
+    }
+  }
+  return mask;
+}
+
+// 0.114 B + 0.587 G + 0.299 R（ITU-R BT.601），系数放大2^8
+constexpr int kGrayB = 29;
+constexpr int kGrayG = 150;
+constexpr int kGrayR = 77;
+
+void BgraToGrayScalar(const uint8_t* src, uint8_t* dst, int pixels) {
+  for (int x = 0; x < pixels; x++) {
+    dst[x] = static_cast<uint8_t>((src[0] * kGrayB + src[1] * kGrayG + src[2] * kGrayR + 128) >> 8);
+    src += 4;
+  }
+}
+
+void BgraToRgbScalar(const uint8_t* src, uint8_t* dst, int pixels) {
+  for (int x = 0; x < pixels; x++) {
+    dst[0] = src[2];
+    dst[1] = src[1];
+    dst[2] = src[0];
+    src += 4;
+    dst += 3;
+  }
+}
+
+void Downscale2xGrayScalar(const uint8_t* top, const uint8_t* bottom, uint8_t* dst, int width) {
+  for (int x = 0; x < width; x++) {
+    dst[x] = static_cast<uint8_t>((top[x * 2] + top[x * 2 + 1] + bottom[x * 2] + bottom[x * 2 + 1] + 2) >> 2);
+  }
+}
+
+#ifdef ROBOT_SIMD_X86
+
+// 32位累加器每个通道每次最多增加2 * 255^2，每4096次迭代归并到64位以防溢出
+constexpr int kSsdFlushIterations = 4096;
+
+// ---------------- SSE4.1 ----------------
+
+__attribute__((target("sse4.1"))) uint32_t SadSse4(const uint8_t* a, const uint8_t* b, int n) {
+  __m128i acc = _mm_setzero_si128();
+  int i = 0;
+  for (; i + 16 <= n; i += 16) {
+    const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+    const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+    acc = _mm_add_epi64(acc, _mm_sad_epu8(va, vb));
+  }
+  uint32_t sum = static_cast<uint32_t>(_mm_cvtsi128_si64(acc) + _mm_extract_epi64(acc, 1));
+  return sum + SadScalar(a + i, b + i, n - i);
+}
+
+__attribute__((target("sse4.1"))) uint64_t SsdSse4(const uint8_t* a, const uint8_t* b, int n) {
+  uint64_t sum = 0;
+  int i = 0;
+  while (i + 8 <= n) {
+    __m128i acc = _mm_setzero_si128();
+    for (int iter = 0; iter < kSsdFlushIterations && i + 8 <= n; iter++, i += 8) {
+      const __m128i va = _mm_cvtepu8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(a + i)));
+      const __m128i vb = _mm_cvtepu8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(b + i)));
+      const __m128i d = _mm_sub_epi16(va, vb);
+      acc = _mm_add_epi32(acc, _mm_madd_epi16(d, d));
+    }
+    alignas(16) uint32_t lanes[4];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), acc);
+    sum += static_cast<uint64_t>(lanes[0]) + lanes[1] + lanes[2] + lanes[3];
+  }
+  return sum + SsdScalar(a + i, b + i, n - i);
+}
+
+__attribute__((target("sse4.1"))) int32_t DotSse4(const uint8_t* a, const int16_t* b, int n) {
+  __m128i acc = _mm_setzero_si128();
+  int i = 0;
+  for (; i + 8 <= n; i += 8) {
+    const __m128i va = _mm_cvtepu8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(a + i)));
+    const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+    acc = _mm_add_epi32(acc, _mm_madd_epi16(va, vb));
+  }
+  acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(1, 0, 3, 2)));
+  acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(2, 3, 0, 1)));
+  return _mm_cvtsi128_si32(acc) + DotScalar(a + i, b + i, n - i);
+}
+
+__attribute__((target("sse4.1"))) uint32_t ChangedMaskSse4(const uint8_t* a, const uint8_t* b, int pixels,
+                                                             uint8_t tolerance) {
+  const __m128i tol = _mm_set1_epi8(static_cast<char>(tolerance));
+  const __m128i colorMask = _mm_set1_epi32(0x00FFFFFF);
+  const __m128i zero = _mm_setzero_si128();
+  uint32_t mask = 0;
+  int i = 0;
+  for (; i + 4 <= pixels; i += 4) {
+    const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i * 4));
+    const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i * 4));
+    // |a - b|，再减去容差后仍非零的通道即为变化
+    const __m128i diff = _mm_or_si128(_mm_subs_epu8(va, vb), _mm_subs_epu8(vb, va));
+    const __m128i over = _mm_and_si128(_mm_subs_epu8(diff, tol), colorMask);
+    const int same = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(over, zero)));
+    mask |= static_cast<uint32_t>(~same & 0xF) << i;
+  }
+  if (i < pixels) {
+    mask |= ChangedMaskScalar(a + i * 4, b + i * 4, pixels - i, tolerance) << i;
+  }
+  return mask;
+}
+
+// 4个BGRA像素的灰度值（32位）
+// 每个像素展开为16位(B, G, R, A)，与(29, 150, 77, 0)做madd后相邻两个32位相加即为加权和
+__attribute__((target("sse4.1"))) inline __m128i Gray4Sse4(const uint8_t* p) {
+  const __m128i weights = _mm_setr_epi16(kGrayB, kGrayG, kGrayR, 0, kGrayB, kGrayG, kGrayR, 0);
+  const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+  const __m128i lo = _mm_madd_epi16(_mm_unpacklo_epi8(v, _mm_setzero_si128()), weights);
+  const __m128i hi = _mm_madd_epi16(_mm_unpackhi_epi8(v, _mm_setzero_si128()), weights);
+  return _mm_srli_epi32(_mm_add_epi32(_mm_hadd_epi32(lo, hi), _mm_set1_epi32(128)), 8);
+}
+
+__attribute__((target("sse4.1"))) void BgraToGraySse4(const uint8_t* src, uint8_t* dst, int pixels) {
+  int x = 0;
+  for (; x + 16 <= pixels; x += 16) {
+    const __m128i a = _mm_packs_epi32(Gray4Sse4(src + x * 4), Gray4Sse4(src + x * 4 + 16));
+    const __m128i b = _mm_packs_epi32(Gray4Sse4(src + x * 4 + 32), Gray4Sse4(src + x * 4 + 48));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x), _mm_packus_epi16(a, b));
+  }
+  BgraToGrayScalar(src + x * 4, dst + x, pixels - x);
+}
+
+__attribute__((target("sse4.1"))) void BgraToRgbSse4(const uint8_t* src, uint8_t* dst, int pixels) {
+  const __m128i shuffle = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+  int x = 0;
+  // 每次写16字节其中12字节有效，下一次写入覆盖多出的4字节；末尾留足余量不越界
+  for (; x + 6 <= pixels; x += 4) {
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x * 4));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x * 3), _mm_shuffle_epi8(v, shuffle));
+  }
+  BgraToRgbScalar(src + x * 4, dst + x * 3, pixels - x);
+}
+
+// 8个2x2块的均值（16位）：maddubs与全1相乘即相邻字节相加
+__attribute__((target("sse4.1"))) inline __m128i Box8Sse4(const uint8_t* top, const uint8_t* bottom) {
+  const __m128i ones = _mm_set1_epi8(1);
+  const __m128i t = _mm_loadu_si128(reinterpret_cast<const __m128i*>(top));
+  const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bottom));
+  const __m128i sum = _mm_add_epi16(_mm_maddubs_epi16(t, ones), _mm_maddubs_epi16(b, ones));
+  return _mm_srli_epi16(_mm_add_epi16(sum, _mm_set1_epi16(2)), 2);
+}
+
+__attribute__((target("sse4.1"))) void Downscale2xGraySse4(const uint8_t* top, const uint8_t* bottom, uint8_t* dst,
+                                                          int width) {
+  int x = 0;
+  for (; x + 16 <= width; x += 16) {
+    const __m128i lo = Box8Sse4(top + x * 2, bottom + x * 2);
+    const __m128i hi = Box8Sse4(top + x * 2 + 16, bottom + x * 2 + 16);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x), _mm_packus_epi16(lo, hi));
+  }
+  Downscale2xGrayScalar(top + x * 2, bottom + x * 2, dst + x, width - x);
+}
+
+// ---------------- AVX2 ----------------
+
+__attribute__((target("avx2"))) uint32_t SadAvx2(const uint8_t* a, const uint8_t* b, int n) {
+  __m256i acc = _mm256_setzero_si256();
+  int i = 0;
+  for (; i + 32 <= n; i += 32) {
+    const __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+    const __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+    acc = _mm256_add_epi64(acc, _mm256_sad_epu8(va, vb));
+  }
+  __m128i half = _mm_add_epi64(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+  uint32_t sum = static_cast<uint32_t>(_mm_cvtsi128_si64(half) + _mm_extract_epi64(half, 1));
+  // 剩余不足32字节时用16字节SAD处理一次
+  if (i + 16 <= n) {
+    const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+    const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+    const __m128i s = _mm_sad_epu8(va, vb);
+    sum += static_cast<uint32_t>(_mm_cvtsi128_si64(s) + _mm_extract_epi64(s, 1));
+    i += 16;
+  }
+  return sum + SadScalar(a + i, b + i, n - i);
+}
+
+__attribute__((target("avx2"))) uint64_t SsdAvx2(const uint8_t* a, const uint8_t* b, int n) {
+  uint64_t sum = 0;
+  int i = 0;
+  while (i + 16 <= n) {
+    __m256i acc = _mm256_setzero_si256();
+    for (int iter = 0; iter < kSsdFlushIterations && i + 16 <= n; iter++, i += 16) {
+      const __m256i va = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)));
+      const __m256i vb = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i)));
+      const __m256i d = _mm256_sub_epi16(va, vb);
+      acc = _mm256_add_epi32(acc, _mm256_madd_epi16(d, d));
+    }
+    alignas(32) uint32_t lanes[8];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc);
+    for (uint32_t lane : lanes) {
+      sum += lane;
+    }
+  }
+  return sum + SsdScalar(a + i, b + i, n - i);
+}
+
+__attribute__((target("avx2"))) int32_t DotAvx2(const uint8_t* a, const int16_t* b, int n) {
+  __m256i acc = _mm256_setzero_si256();
+  int i = 0;
+  for (; i + 16 <= n; i += 16) {
+    const __m256i va = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)));
+    const __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+    acc = _mm256_add_epi32(acc, _mm256_madd_epi16(va, vb));
+  }
+  __m128i half = _mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+  half = _mm_add_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(1, 0, 3, 2)));
+  half = _mm_add_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(2, 3, 0, 1)));
+  return _mm_cvtsi128_si32(half) + DotScalar(a + i, b + i, n - i);
+}
+
+__attribute__((target("avx2"))) uint32_t ChangedMaskAvx2(const uint8_t* a, const uint8_t* b, int pixels,
+                                                           uint8_t tolerance) {
+  const __m256i tol = _mm256_set1_epi8(static_cast<char>(tolerance));
+  const __m256i colorMask = _mm256_set1_epi32(0x00FFFFFF);
+  const __m256i zero = _mm256_setzero_si256();
+  uint32_t mask = 0;
+  int i = 0;
+  for (; i + 8 <= pixels; i += 8) {
+    const __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i * 4));
+    const __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i * 4));
+    const __m256i diff = _mm256_or_si256(_mm256_subs_epu8(va, vb), _mm256_subs_epu8(vb, va));
+    const __m256i over = _mm256_and_si256(_mm256_subs_epu8(diff, tol), colorMask);
+    const int same = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(over, zero)));
+    mask |= static_cast<uint32_t>(~same & 0xFF) << i;
+  }
+  if (i < pixels) {
+    mask |= ChangedMaskScalar(a + i * 4, b + i * 4, pixels - i, tolerance) << i;
+  }
+  return mask;
+}
+
+// 8个BGRA像素的灰度值（32位），unpack/hadd都在128位通道内进行，结果仍按像素顺序排列
+__attribute__((target("avx2"))) inline __m256i Gray8Avx2(const uint8_t* p) {
+  const __m256i weights = _mm256_setr_epi16(kGrayB, kGrayG, kGrayR, 0, kGrayB, kGrayG, kGrayR, 0, kGrayB, kGrayG,
+                                            kGrayR, 0, kGrayB, kGrayG, kGrayR, 0);
+  const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+  const __m256i lo = _mm256_madd_epi16(_mm256_unpacklo_epi8(v, _mm256_setzero_si256()), weights);
+  const __m256i hi = _mm256_madd_epi16(_mm256_unpackhi_epi8(v, _mm256_setzero_si256()), weights);
+  return _mm256_srli_epi32(_mm256_add_epi32(_mm256_hadd_epi32(lo, hi), _mm256_set1_epi32(128)), 8);
+}
+
+__attribute__((target("avx2"))) void BgraToGrayAvx2(const uint8_t* src, uint8_t* dst, int pixels) {
+  // pack指令按128位通道工作，四组8像素打包后的32位块顺序为0,2,4,6 | 1,3,5,7
+  const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+  int x = 0;
+  for (; x + 32 <= pixels; x += 32) {
+    const __m256i a = _mm256_packs_epi32(Gray8Avx2(src + x * 4), Gray8Avx2(src + x * 4 + 32));
+    const __m256i b = _mm256_packs_epi32(Gray8Avx2(src + x * 4 + 64), Gray8Avx2(src + x * 4 + 96));
+    const __m256i packed = _mm256_permutevar8x32_epi32(_mm256_packus_epi16(a, b), order);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + x), packed);
+  }
+  BgraToGraySse4(src + x * 4, dst + x, pixels - x);
+}
+
+__attribute__((target("avx2"))) inline __m256i Box16Avx2(const uint8_t* top, const uint8_t* bottom) {
+  const __m256i ones = _mm256_set1_epi8(1);
+  const __m256i t = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(top));
+  const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bottom));
+  const __m256i sum = _mm256_add_epi16(_mm256_maddubs_epi16(t, ones), _mm256_maddubs_epi16(b, ones));
+  return _mm256_srli_epi16(_mm256_add_epi16(sum, _mm256_set1_epi16(2)), 2);
+}
+
+__attribute__((target("avx2"))) void Downscale2xGrayAvx2(const uint8_t* top, const uint8_t* bottom, uint8_t* dst,
+                                                        int width) {
+  int x = 0;
+  for (; x + 32 <= width; x += 32) {
+    const __m256i lo = Box16Avx2(top + x * 2, bottom + x * 2);
+    const __m256i hi = Box16Avx2(top + x * 2 + 32, bottom + x * 2 + 32);
+    const __m256i packed = _mm256_packus_epi16(lo, hi);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + x), _mm256_permute4x64_epi64(packed, 0xD8));
+  }
+  Downscale2xGraySse4(top + x * 2, bottom + x * 2, dst + x, width - x);
+}
+
+#endif  // ROBOT_SIMD_X86
+
+#ifdef ROBOT_SIMD_NEON
+
+// ---------------- NEON ----------------
+// vld4/vst3直接完成BGRA的解交织与RGB的交织
+
+void BgraToGrayNeon(const uint8_t* src, uint8_t* dst, int pixels) {
+  const uint8x8_t wb = vdup_n_u8(kGrayB);
+  const uint8x8_t wg = vdup_n_u8(kGrayG);
+  const uint8x8_t wr = vdup_n_u8(kGrayR);
+  int x = 0;
+  for (; x + 16 <= pixels; x += 16) {
+    const uint8x16x4_t v = vld4q_u8(src + x * 4);
+    uint16x8_t lo = vmull_u8(vget_low_u8(v.val[0]), wb);
+    lo = vmlal_u8(lo, vget_low_u8(v.val[1]), wg);
+    lo = vmlal_u8(lo, vget_low_u8(v.val[2]), wr);
+    uint16x8_t hi = vmull_u8(vget_high_u8(v.val[0]), wb);
+    hi = vmlal_u8(hi, vget_high_u8(v.val[1]), wg);
+    hi = vmlal_u8(hi, vget_high_u8(v.val[2]), wr);
+    // 加权和不超过255 * 256，16位无溢出；vrshrn带舍入右移
+    vst1q_u8(dst + x, vcombine_u8(vrshrn_n_u16(lo, 8), vrshrn_n_u16(hi, 8)));
+  }
+  BgraToGrayScalar(src + x * 4, dst + x, pixels - x);
+}
+
+void BgraToRgbNeon(const uint8_t* src, uint8_t* dst, int pixels) {
+  int x = 0;
+  for (; x + 16 <= pixels; x += 16) {
+    const uint8x16x4_t v = vld4q_u8(src + x * 4);
+    uint8x16x3_t rgb;
+    rgb.val[0] = v.val[2];
+    rgb.val[1] = v.val[1];
+    rgb.val[2] = v.val[0];
+    vst3q_u8(dst + x * 3, rgb);
+  }
+  BgraToRgbScalar(src + x * 4, dst + x * 3, pixels - x);
+}
+
+void Downscale2xGrayNeon(const uint8_t* top, const uint8_t* bottom, uint8_t* dst, int width) {
+  int x = 0;
+  for (; x + 16 <= width; x += 16) {
+    const uint16x8_t t0 = vpaddlq_u8(vld1q_u8(top + x * 2));
+    const uint16x8_t t1 = vpaddlq_u8(vld1q_u8(top + x * 2 + 16));
+    const uint16x8_t lo = vpadalq_u8(t0, vld1q_u8(bottom + x * 2));
+    const uint16x8_t hi = vpadalq_u8(t1, vld1q_u8(bottom + x * 2 + 16));
+    vst1q_u8(dst + x, vcombine_u8(vrshrn_n_u16(lo, 2), vrshrn_n_u16(hi, 2)));
+  }
+  Downscale2xGrayScalar(top + x * 2, bottom + x * 2, dst + x, width - x);
+}
+
+#endif  // ROBOT_SIMD_NEON
+
+struct Kernels {
+  Level level;
+  uint32_t (*sad)(const uint8_t*, const uint8_t*, int);
+  uint64_t (*ssd)(const uint8_t*, const uint8_t*, int);
+  int32_t (*dot)(const uint8_t*, const int16_t*, int);
+  uint32_t (*changedMask)(const uint8_t*, const uint8_t*, int, uint8_t);
+  void (*bgraToGray)(const uint8_t*, uint8_t*, int);
+  void (*bgraToRgb)(const uint8_t*, uint8_t*, int);
+  void (*downscale2xGray)(const uint8_t*, const uint8_t*, uint8_t*, int);
+};
+
+const Kernels kScalarKernels = {Level::SCALAR,   SadScalar,        SsdScalar,       DotScalar,
+                                ChangedMaskScalar, BgraToGrayScalar, BgraToRgbScalar, Downscale2xGrayScalar};
+#ifdef ROBOT_SIMD_X86
+// BGRA转RGB受存储带宽限制，且256位shuffle只能在128位通道内进行，AVX2沿用SSE实现
+const Kernels kSse4Kernels = {Level::SSE4,    SadSse4,        SsdSse4,       DotSse4,
+                              ChangedMaskSse4, BgraToGraySse4, BgraToRgbSse4, Downscale2xGraySse4};
+const Kernels kAvx2Kernels = {Level::AVX2,    SadAvx2,        SsdAvx2,       DotAvx2,
+                              ChangedMaskAvx2, BgraToGrayAvx2, BgraToRgbSse4, Downscale2xGrayAvx2};
+#endif
+#ifdef ROBOT_SIMD_NEON
+// 目前只有颜色转换与降采样有NEON实现，其余内核使用标量版本
+const Kernels kNeonKernels = {Level::NEON,      SadScalar,      SsdScalar,     DotScalar,
+                              ChangedMaskScalar, BgraToGrayNeon, BgraToRgbNeon, Downscale2xGrayNeon};
+#endif
+
+const Kernels* KernelsFor(Level level) {
+#ifdef ROBOT_SIMD_X86
+  switch (level) {
+    case Level::AVX2:
+      return &kAvx2Kernels;
+    case Level::SSE4:
+      return &kSse4Kernels;
+    default:
+      break;
+  }
+#elif defined(ROBOT_SIMD_NEON)
+  if (level == Level::NEON) {
+    return &kNeonKernels;
+  }
+#else
+  (void)level;
+#endif
+  return &kScalarKernels;
+}
+
+Level Detect() {
+#ifdef ROBOT_SIMD_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    return Level::AVX2;
+  }
+  if (__builtin_cpu_supports("sse4.1")) {
+    return Level::SSE4;
+  }
+#elif defined(ROBOT_SIMD_NEON)
+  // AArch64必定支持NEON
+  return Level::NEON;
+#endif
+  return Level::SCALAR;
+}
+
+// 首次使用时按检测结果初始化，之后只做一次原子读取
+std::atomic<const Kernels*>& ActiveKernels() {
+  static std::atomic<const Kernels*> active{KernelsFor(DetectedLevel())};
+  return active;
+}
+
+inline const Kernels& Current() {
+  return *ActiveKernels().load(std::memory_order_relaxed);
+}
+
+}  // namespace
+
+Level DetectedLevel() {
+  static const Level detected = Detect();
+  return detected;
+}
+
+Level ActiveLevel() {
+  return Current().level;
+}
+
+void ForceLevel(Level level) {
+  if (static_cast<int>(level) > static_cast<int>(DetectedLevel())) {
+    level = DetectedLevel();
+  }
+  ActiveKernels().store(KernelsFor(level), std::memory_order_relaxed);
+}
+
+const char* LevelName(Level level) {
+  switch (level) {
+    case Level::AVX2:
+      return "avx2";
+    case Level::SSE4:
+      return "sse4.1";
+    case Level::NEON:
+      return "neon";
+    default:
+      return "scalar";
+  }
+}
+
+uint32_t Sad(const uint8_t* a, const uint8_t* b, int n) {
+  return Current().sad(a, b, n);
+}
+
+uint64_t Ssd(const uint8_t* a, const uint8_t* b, int n) {
+  return Current().ssd(a, b, n);
+}
+
+int32_t Dot(const uint8_t* a, const int16_t* b, int n) {
+  return Current().dot(a, b, n);
+}
+
+uint32_t ChangedMask(const uint8_t* a, const uint8_t* b, int pixels, uint8_t tolerance) {
+  return Current().changedMask(a, b, pixels, tolerance);
+}
+
+void BgraToGray(const uint8_t* bgra, uint8_t* gray, int pixels) {
+  Current().bgraToGray(bgra, gray, pixels);
+}
+
+void BgraToRgb(const uint8_t* bgra, uint8_t* rgb, int pixels) {
+  Current().bgraToRgb(bgra, rgb, pixels);
+}
+
+void Downscale2xGray(const uint8_t* top, const uint8_t* bottom, uint8_t* dst, int width) {
+  Current().downscale2xGray(top, bottom, dst, width);
+}
+
+std::vector<BenchmarkResult> Benchmark(int width, int height, int iterations) {
+  width = std::max(width, 2);
+  height = std::max(height, 2);
+  iterations = std::max(iterations, 1);
+  const size_t pixels = static_cast<size_t>(width) * height;
+
+  std::mt19937 rng(12345);
+  std::vector<uint8_t> frame(pixels * 4);
+  std::vector<uint8_t> other(pixels * 4);
+  for (size_t i = 0; i < frame.size(); i++) {
+    frame[i] = static_cast<uint8_t>(rng());
+    other[i] = (rng() & 7) == 0 ? static_cast<uint8_t>(rng()) : frame[i];
+  }
+  std::vector<uint8_t> gray(pixels);
+  std::vector<int16_t> coefficients(width);
+  for (int i = 0; i < width; i++) {
+    coefficients[i] = static_cast<int16_t>(static_cast<int>(rng() % 511) - 255);
+  }
+
+  // 每个内核处理整帧，结果写入out（按字节比较）；bytes为读取的输入字节数
+  struct Case {
+    const char* name;
+    size_t bytes;
+    std::function<void(const Kernels&, std::vector<uint8_t>&)> run;
+  };
+  auto appendValue = [](std::vector<uint8_t>& out, const void* value, size_t size) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(value);
+    out.insert(out.end(), bytes, bytes + size);
+  };
+  const std::vector<Case> cases = {
+      {"bgraToGray", pixels * 4,
+       [&](const Kernels& k, std::vector<uint8_t>& out) {
+         out.resize(pixels);
+         for (int y = 0; y < height; y++) {
+           k.bgraToGray(frame.data() + static_cast<size_t>(y) * width * 4, out.data() + static_cast<size_t>(y) * width,
+                        width);
+         }
+       }},
+      {"bgraToRgb", pixels * 4,
+       [&](const Kernels& k, std::vector<uint8_t>& out) {
+         out.resize(pixels * 3);
+         for (int y = 0; y < height; y++) {
+           k.bgraToRgb(frame.data() + static_cast<size_t>(y) * width * 4,
+                       out.data() + static_cast<size_t>(y) * width * 3, width);
+         }
+       }},
+      {"downscale2xGray", pixels,
+       [&](const Kernels& k, std::vector<uint8_t>& out) {
+         const int outWidth = width / 2;
+         out.resize(static_cast<size_t>(outWidth) * (height / 2));
+         for (int y = 0; y + 1 < height; y += 2) {
+           k.downscale2xGray(gray.data() + static_cast<size_t>(y) * width,
+                             gray.data() + static_cast<size_t>(y + 1) * width,
+                             out.data() + static_cast<size_t>(y / 2) * outWidth, outWidth);
+         }
+       }},
+      {"changedMask", pixels * 8,
+       [&](const Kernels& k, std::vector<uint8_t>& out) {
+         out.clear();
+         for (size_t i = 0; i < pixels; i += 32) {
+           const int count = static_cast<int>(std::min<size_t>(32, pixels - i));
+           const uint32_t mask = k.changedMask(frame.data() + i * 4, other.data() + i * 4, count, 8);
+           appendValue(out, &mask, sizeof(mask));
+         }
+       }},
+      {"sad", pixels * 2,
+       [&](const Kernels& k, std::vector<uint8_t>& out) {
+         out.clear();
+         for (int y = 0; y < height; y++) {
+           const uint32_t sum = k.sad(gray.data() + static_cast<size_t>(y) * width,
+                                      frame.data() + static_cast<size_t>(y) * width, width);
+           appendValue(out, &sum, sizeof(sum));
+         }
+       }},
+      {"ssd", pixels * 2,
+       [&](const Kernels& k, std::vector<uint8_t>& out) {
+         out.clear();
+         for (int y = 0; y < height; y++) {
+           const uint64_t sum = k.ssd(gray.data() + static_cast<size_t>(y) * width,
+                                      frame.data() + static_cast<size_t>(y) * width, width);
+           appendValue(out, &sum, sizeof(sum));
+         }
+       }},
+      {"dot", pixels * 3,
+       [&](const Kernels& k, std::vector<uint8_t>& out) {
+         out.clear();
+         for (int y = 0; y < height; y++) {
+           const int32_t sum = k.dot(gray.data() + static_cast<size_t>(y) * width, coefficients.data(), width);
+           appendValue(out, &sum, sizeof(sum));
+         }
+       }},
+  };
+
+  std::vector<const Kernels*> levels = {&kScalarKernels};
+  for (Level level : {Level::SSE4, Level::AVX2, Level::NEON}) {
+    const Kernels* kernels = KernelsFor(level);
+    if (kernels->level == level && static_cast<int>(level) <= static_cast<int>(DetectedLevel())) {
+      levels.push_back(kernels);
+    }
+  }
+
+  // 降采样的输入是灰度帧
+  kScalarKernels.bgraToGray(frame.data(), gray.data(), static_cast<int>(pixels));
+
+  std::vector<BenchmarkResult> results;
+  std::vector<uint8_t> reference;
+  std::vector<uint8_t> output;
+  for (const Case& test : cases) {
+    test.run(kScalarKernels, reference);
+    double scalarSeconds = 0;
+    for (const Kernels* kernels : levels) {
+      test.run(*kernels, output);  // 预热并检查结果
+      const bool exact = output == reference;
+      const auto start = std::chrono::steady_clock::now();
+      for (int i = 0; i < iterations; i++) {
+        test.run(*kernels, output);
+      }
+      const double seconds =
+          std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / iterations;
+      if (kernels == &kScalarKernels) {
+        scalarSeconds = seconds;
+      }
+
+      BenchmarkResult result;
+      result.kernel = test.name;
+      result.level = kernels->level;
+      result.milliseconds = seconds * 1000.0;
+      result.gigabytesPerSecond = seconds > 0 ? test.bytes / seconds / 1e9 : 0;
+      result.speedup = seconds > 0 ? scalarSeconds / seconds : 0;
+      result.matchesScalar = exact;
+      results.push_back(result);
+    }
+  }
+  return results;
+}
+
+}  // namespace Simd
+}  // namespace Robot
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace Robot {
+namespace Simd {
+
+// 运行时选择的指令集级别；x86-64上为SCALAR/SSE4/AVX2，AArch64上为SCALAR/NEON
+enum class Level { SCALAR, SSE4, AVX2, NEON };
+
+// 当前CPU支持的最高级别
+Level DetectedLevel();
+
+// 当前实际使用的级别
+Level ActiveLevel();
+
+// 限制使用的最高级别（不会超过DetectedLevel()），用于对比各实现的结果和性能
+void ForceLevel(Level level);
+
+const char* LevelName(Level level);
+
+// 绝对差之和 Σ|a[i] - b[i]|，n不超过2^24
+uint32_t Sad(const uint8_t* a, const uint8_t* b, int n);
+
+// 差平方和 Σ(a[i] - b[i])^2
+uint64_t Ssd(const uint8_t* a, const uint8_t* b, int n);
+
+// 点积 Σa[i] * b[i]，b的绝对值不超过255时n不超过32768
+int32_t Dot(const uint8_t* a, const int16_t* b, int n);
+
+// 比较两段BGRA像素（pixels不超过32），B/G/R任一通道差值超过tolerance的像素在返回值中对应位为1，忽略A通道
+uint32_t ChangedMask(const uint8_t* a, const uint8_t* b, int pixels, uint8_t tolerance);
+
+// 位操作，用于处理ChangedMask的结果；LowestBit/HighestBit要求mask非0
+inline int PopCount(uint32_t mask) {
+#if defined(__GNUC__) || defined(__clang__)
+  return __builtin_popcount(mask);
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+  return static_cast<int>(__popcnt(mask));
+#else
+  int count = 0;
+  for (; mask != 0; mask &= mask - 1) {
+    count++;
+  }
+  return count;
+#endif
+}
+
+inline int LowestBit(uint32_t mask) {
+#if defined(__GNUC__) || defined(__clang__)
+  return __builtin_ctz(mask);
+#elif defined(_MSC_VER)
+  unsigned long index = 0;
+  _BitScanForward(&index, mask);
+  return static_cast<int>(index);
+#else
+  int index = 0;
+  while ((mask & 1u) == 0) {
+    mask >>= 1;
+    index++;
+  }
+  return index;
+#endif
+}
+
+inline int HighestBit(uint32_t mask) {
+#if defined(__GNUC__) || defined(__clang__)
+  return 31 - __builtin_clz(mask);
+#elif defined(_MSC_VER)
+  unsigned long index = 0;
+  _BitScanReverse(&index, mask);
+  return static_cast<int>(index);
+#else
+  int index = 31;
+  while ((mask & 0x80000000u) == 0) {
+    mask <<= 1;
+    index--;
+  }
+  return index;
+#endif
+}
+
+// BGRA转灰度：(29 B + 150 G + 77 R + 128) >> 8，各级别结果逐位一致
+void BgraToGray(const uint8_t* bgra, uint8_t* gray, int pixels);
+
+// BGRA转紧凑RGB（每像素3字节）
+void BgraToRgb(const uint8_t* bgra, uint8_t* rgb, int pixels);
+
+// 灰度2x2均值降采样的一行：dst[x] = (top[2x] + top[2x+1] + bottom[2x] + bottom[2x+1] + 2) >> 2
+void Downscale2xGray(const uint8_t* top, const uint8_t* bottom, uint8_t* dst, int width);
+
+struct BenchmarkResult {
+  const char* kernel;
+  Level level;
+  double milliseconds;        // 处理一帧的耗时
+  double gigabytesPerSecond;  // 输入数据吞吐量，用于判断是否已达内存带宽上限
+  double speedup;             // 相对标量实现
+  bool matchesScalar;         // 输出与标量实现逐字节一致
+};
+
+// 微基准：在width x height的随机帧上单线程运行每个内核的所有可用级别，与标量实现比较结果与速度
+std::vector<BenchmarkResult> Benchmark(int width = 1920, int height = 1080, int iterations = 20);
+
+}  // namespace Simd
+}  // namespace Robot
@@ -0,0 +1,165 @@
+#include "./TemplateCache.h"
+
+#include <cstring>
+#include <stdexcept>
+
+#include <sys/stat.h>
+
+namespace Robot {
+
+namespace {
+
+// 64位内容哈希：每次处理8字节，乘法混合，不要求密码学强度
+uint64_t HashBytes(const uint8_t* data, size_t size, uint64_t seed) {
+  constexpr uint64_t kMultiplier = 0x9E3779B97F4A7C15ULL;
+  uint64_t hash = seed ^ (size * kMultiplier);
+  size_t i = 0;
+  for (; i + 8 <= size; i += 8) {
+    uint64_t word;
+    memcpy(&word, data + i, sizeof(word));
+    hash ^= word * kMultiplier;
+    hash = (hash << 31) | (hash >> 33);
+    hash *= 0xC2B2AE3D27D4EB4FULL;
+  }
+  uint64_t tail = 0;
+  memcpy(&tail, data + i, size - i);
+  hash ^= tail * kMultiplier;
+  // 最终混合（splitmix64）
+  hash ^= hash >> 30;
+  hash *= 0xBF58476D1CE4E5B9ULL;
+  hash ^= hash >> 27;
+  hash *= 0x94D049BB133111EBULL;
+  hash ^= hash >> 31;
+  return hash;
+}
+
+std::string ScalesKey(const std::vector<double>& scales) {
+  std::string key;
+  for (double scale : scales) {
+    key += '|';
+    key += std::to_string(scale);
+  }
+  return key;
+}
+
+}  // namespace
+
+TemplateCache::TemplateCache(size_t maxBytes) : maxBytes(maxBytes) {}
+
+size_t TemplateCache::MemoryBytes(const TemplatePyramid& pyramid) {
+  size_t bytes = sizeof(TemplatePyramid);
+  for (const auto& entry : pyramid.Scales()) {
+    for (const Template& level : entry.levels) {
+      bytes += sizeof(Template) + level.Gray().pixels.size() + level.Centered().size() * sizeof(int16_t);
+    }
+  }
+  return bytes;
+}
+
+std::shared_ptr<const TemplatePyramid> TemplateCache::Get(const Image& image, const std::vector<double>& scales) {
+  const ImageView view = image.View();
+  uint64_t hash = 0;
+  for (int y = 0; y < view.height; y++) {
+    hash = HashBytes(view.Row(y), static_cast<size_t>(view.width) * 4, hash);
+  }
+  const std::string key = "image:" + std::to_string(view.width) + "x" + std::to_string(view.height) + ":" +
+                          std::to_string(hash) + ScalesKey(scales);
+  if (auto cached = Lookup(key)) {
+    return cached;
+  }
+  return Insert(key, TemplatePyramid(view, scales));
+}
+
+std::shared_ptr<const TemplatePyramid> TemplateCache::Get(const std::string& path,
+                                                          const std::vector<double>& scales) {
+  struct stat info {};
+  if (stat(path.c_str(), &info) != 0) {
+    throw std::runtime_error("Cannot open image file: " + path);
+  }
+  int64_t mtimeNs = static_cast<int64_t>(info.st_mtime) * 1000000000LL;
+#ifdef __linux__
+  mtimeNs += info.st_mtim.tv_nsec;
+#endif
+  const std::string key = "file:" + path + ":" + std::to_string(mtimeNs) + ":" +
+                          std::to_string(static_cast<int64_t>(info.st_size)) + ScalesKey(scales);
+  if (auto cached = Lookup(key)) {
+    return cached;
+  }
+  const Image image = Image::LoadBmp(path);
+  return Insert(key, TemplatePyramid(image.View(), scales));
+}
+
+void TemplateCache::Preload(const std::vector<std::string>& paths, const std::vector<double>& scales) {
+  for (const std::string& path : paths) {
+    Get(path, scales);
+  }
+}
+
+std::shared_ptr<const TemplatePyramid> TemplateCache::Lookup(const std::string& key) {
+  std::lock_guard<std::mutex> lock(mutex);
+  auto it = index.find(key);
+  if (it == index.end()) {
+    stats.misses++;
+    return nullptr;
+  }
+  stats.hits++;
+  entries.splice(entries.begin(), entries, it->second);
+  return it->second->pyramid;
+}
+
+std::shared_ptr<const TemplatePyramid> TemplateCache::Insert(const std::string& key, TemplatePyramid pyramid) {
+  const size_t bytes = MemoryBytes(pyramid);
+  auto shared = std::make_shared<const TemplatePyramid>(std::move(pyramid));
+
+  std::lock_guard<std::mutex> lock(mutex);
+  // 其他线程可能已经插入了同一模板
+  auto it = index.find(key);
+  if (it != index.end()) {
+    entries.splice(entries.begin(), entries, it->second);
+    return it->second->pyramid;
+  }
+  entries.push_front({key, shared, bytes});
+  index[key] = entries.begin();
+  stats.bytes += bytes;
+  stats.entries = entries.size();
+  EvictLocked();
+  return shared;
+}
+
+void TemplateCache::EvictLocked() {
+  // 至少保留刚插入的条目，即使它本身超过上限
+  while (stats.bytes > maxBytes && entries.size() > 1) {
+    const Entry& victim = entries.back();
+    stats.bytes -= victim.bytes;
+    index.erase(victim.key);
+    entries.pop_back();
+    stats.evictions++;
+  }
+  stats.entries = entries.size();
+}
+
+void TemplateCache::SetMaxBytes(size_t bytes) {
+  std::lock_guard<std::mutex> lock(mutex);
+  maxBytes = bytes;
+  EvictLocked();
+}
+
+size_t TemplateCache::MaxBytes() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return maxBytes;
+}
+
+void TemplateCache::Clear() {
+  std::lock_guard<std::mutex> lock(mutex);
+  entries.clear();
+  index.clear();
+  stats.bytes = 0;
+  stats.entries = 0;
+}
+
+TemplateCache::Stats TemplateCache::GetStats() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return stats;
+}
+
+}  // namespace Robot
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "./Image.h"
+#include "./TemplateMatcher.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Robot {
+
+// 预处理模板（TemplatePyramid）的LRU缓存
+// 内存中的图像按像素内容哈希索引，文件按路径+修改时间+大小索引（文件被改写后自动失效）。
+// 超出内存上限时淘汰最久未使用的条目；返回的shared_ptr在条目被淘汰后仍然有效。
+// 所有方法都是线程安全的。
+class TemplateCache {
+ public:
+  struct Stats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    size_t entries = 0;
+    size_t bytes = 0;  // 缓存中所有条目的预处理数据大小
+  };
+
+  explicit TemplateCache(size_t maxBytes = 256 * 1024 * 1024);
+
+  TemplateCache(const TemplateCache&) = delete;
+  TemplateCache& operator=(const TemplateCache&) = delete;
+
+  // 按图像内容获取，未命中时预处理并缓存
+  std::shared_ptr<const TemplatePyramid> Get(const Image& image, const std::vector<double>& scales = {1.0});
+
+  // 按BMP文件获取，未命中时读取文件并预处理，文件无法读取时抛出std::runtime_error
+  std::shared_ptr<const TemplatePyramid> Get(const std::string& path, const std::vector<double>& scales = {1.0});
+
+  // 预热：提前读取并预处理一批文件
+  void Preload(const std::vector<std::string>& paths, const std::vector<double>& scales = {1.0});
+
+  void SetMaxBytes(size_t maxBytes);
+  size_t MaxBytes() const;
+  void Clear();
+  Stats GetStats() const;
+
+  // 预处理数据占用的内存估算
+  static size_t MemoryBytes(const TemplatePyramid& pyramid);
+
+ private:
+  struct Entry {
+    std::string key;
+    std::shared_ptr<const TemplatePyramid> pyramid;
+    size_t bytes;
+  };
+
+  std::shared_ptr<const TemplatePyramid> Lookup(const std::string& key);
+  std::shared_ptr<const TemplatePyramid> Insert(const std::string& key, TemplatePyramid pyramid);
+  void EvictLocked();
+
+  mutable std::mutex mutex;
+  std::list<Entry> entries;  // 最近使用的在前
+  std::unordered_map<std::string, std::list<Entry>::iterator> index;
+  size_t maxBytes;
+  Stats stats;
+};
+
+}  // namespace Robot
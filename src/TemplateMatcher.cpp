@@ -0,0 +1,895 @@
+#include "./TemplateMatcher.h"
+
+#include "./Simd.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <mutex>
+#include <utility>
+
+namespace Robot {
+
+namespace {
+
+constexpr double kRejected = -std::numeric_limits<double>::infinity();
+
+// 方差低于该值视为纯色区域，NCC无定义
+constexpr double kFlatVariance = 1e-6;
+
+// 把[0, count)平均分为parts段，返回第index段的起点
+int SplitPoint(int count, int parts, int index) {
+  return static_cast<int>(static_cast<int64_t>(count) * index / parts);
+}
+
+// 每个任务至少处理的候选行数，避免任务过碎
+constexpr int kMinRowsPerTask = 2;
+
+// 每个线程分到的任务数，用于在行代价不均（提前终止）时平衡负载
+constexpr int kTasksPerThread = 4;
+
+struct BandBest {
+  double score = kRejected;
+  int x = 0;
+  int y = 0;
+};
+
+}  // namespace
+
+// ---------------- Template ----------------
+
+Template::Template(const ImageView& image) {
+  ToGray(image, gray);
+  Init();
+}
+
+Template::Template(GrayImage image) : gray(std::move(image)) {
+  Init();
+}
+
+void Template::Init() {
+  const size_t n = gray.pixels.size();
+  if (n == 0) {
+    return;
+  }
+
+  uint64_t sum = 0;
+  for (uint8_t value : gray.pixels) {
+    sum += value;
+  }
+  mean = static_cast<double>(sum) / n;
+
+  // 取整后的均值使系数落在int16范围内，残余的Σcentered在打分时精确扣除
+  const int roundedMean = static_cast<int>(std::lround(mean));
+  centered.resize(n);
+  int64_t centeredSquares = 0;
+  centeredSum = 0;
+  for (size_t i = 0; i < n; i++) {
+    const int value = gray.pixels[i] - roundedMean;
+    centered[i] = static_cast<int16_t>(value);
+    centeredSum += value;
+    centeredSquares += value * value;
+  }
+  centeredNorm = static_cast<double>(centeredSquares) -
+                 static_cast<double>(centeredSum) * centeredSum / static_cast<double>(n);
+}
+
+// ---------------- TemplatePyramid ----------------
+
+TemplatePyramid::TemplatePyramid(const ImageView& image, const std::vector<double>& scales) {
+  GrayImage base;
+  ToGray(image, base);
+  if (base.width <= 0 || base.height <= 0) {
+    return;
+  }
+
+  for (double scale : scales) {
+    if (scale <= 0.0) {
+      continue;
+    }
+    GrayImage level;
+    if (scale == 1.0) {
+      level = base;
+    } else {
+      const int width = std::max(1, static_cast<int>(std::lround(base.width * scale)));
+      const int height = std::max(1, static_cast<int>(std::lround(base.height * scale)));
+      ResizeGray(base, width, height, level);
+    }
+
+    Scaled entry;
+    entry.scale = scale;
+    while (true) {
+      GrayImage next;
+      const bool deeper = static_cast<int>(entry.levels.size()) + 1 < kMaxLevels &&
+                          std::min(level.width, level.height) / 2 >= kMinLevelSize;
+      if (deeper) {
+        Downscale2x(level, next);
+      }
+      entry.levels.emplace_back(std::move(level));
+      if (!deeper) {
+        break;
+      }
+      level = std::move(next);
+    }
+    scaled.push_back(std::move(entry));
+  }
+}
+
+int TemplatePyramid::MaxLevels() const {
+  int count = 0;
+  for (const Scaled& entry : scaled) {
+    count = std::max(count, static_cast<int>(entry.levels.size()));
+  }
+  return count;
+}
+
+// ---------------- SearchImage ----------------
+
+void SearchImage::Prepare(const ImageView& image, ThreadPool& pool) {
+  gray.Resize(image.width, image.height);
+  Build(&image, pool);
+}
+
+void SearchImage::PrepareDownscaled(const SearchImage& finer, ThreadPool& pool) {
+  Downscale2x(finer.gray, gray);
+  Build(nullptr, pool);
+}
+
+void SearchImage::Build(const ImageView* source, ThreadPool& pool) {
+  const int width = gray.width;
+  const int height = gray.height;
+  const size_t stride = static_cast<size_t>(width) + 1;
+  integral.assign(stride * (height + 1), 0);
+  sqIntegral.assign(stride * (height + 1), 0);
+  if (width <= 0 || height <= 0) {
+    return;
+  }
+
+  // 第一遍：各行带独立（按需转换灰度并）计算带内积分图
+  const int bands = std::max(1, std::min(height, static_cast<int>(pool.Size()) * 2));
+  pool.ParallelFor(0, bands, [&](int band) {
+    const int y0 = SplitPoint(height, bands, band);
+    const int y1 = SplitPoint(height, bands, band + 1);
+    for (int y = y0; y < y1; y++) {
+      uint8_t* row = gray.MutableRow(y);
+      if (source != nullptr) {
+        BgraToGrayRow(source->Row(y), row, width);
+      }
+
+      uint32_t* out = integral.data() + (y + 1) * stride;
+      uint64_t* sqOut = sqIntegral.data() + (y + 1) * stride;
+      const uint32_t* above = (y == y0) ? nullptr : out - stride;
+      const uint64_t* sqAbove = (y == y0) ? nullptr : sqOut - stride;
+      uint32_t rowSum = 0;
+      uint64_t rowSquares = 0;
+      for (int x = 0; x < width; x++) {
+        const uint32_t value = row[x];
+        rowSum += value;
+        rowSquares += value * value;
+        out[x + 1] = rowSum + (above ? above[x + 1] : 0);
+        sqOut[x + 1] = rowSquares + (sqAbove ? sqAbove[x + 1] : 0);
+      }
+    }
+  });
+  if (bands == 1) {
+    return;
+  }
+
+  // 第二遍：串行累计每个行带之前所有行带的列和
+  std::vector<std::vector<uint32_t>> carries(bands);
+  std::vector<std::vector<uint64_t>> sqCarries(bands);
+  carries[0].assign(stride, 0);
+  sqCarries[0].assign(stride, 0);
+  for (int band = 1; band < bands; band++) {
+    const int lastRow = SplitPoint(height, bands, band);  // 上一行带最后一行在积分图中的行号
+    const uint32_t* last = integral.data() + lastRow * stride;
+    const uint64_t* sqLast = sqIntegral.data() + lastRow * stride;
+    carries[band].resize(stride);
+    sqCarries[band].resize(stride);
+    for (size_t x = 0; x < stride; x++) {
+      carries[band][x] = carries[band - 1][x] + last[x];
+      sqCarries[band][x] = sqCarries[band - 1][x] + sqLast[x];
+    }
+  }
+
+  // 第三遍：并行加上累计值
+  pool.ParallelFor(1, bands, [&](int band) {
+    const int y0 = SplitPoint(height, bands, band);
+    const int y1 = SplitPoint(height, bands, band + 1);
+    const uint32_t* carry = carries[band].data();
+    const uint64_t* sqCarry = sqCarries[band].data();
+    for (int y = y0; y < y1; y++) {
+      uint32_t* out = integral.data() + (y + 1) * stride;
+      uint64_t* sqOut = sqIntegral.data() + (y + 1) * stride;
+      for (size_t x = 0; x < stride; x++) {
+        out[x] += carry[x];
+        sqOut[x] += sqCarry[x];
+      }
+    }
+  });
+}
+
+uint32_t SearchImage::Sum(int x, int y, int width, int height) const {
+  const size_t stride = static_cast<size_t>(gray.width) + 1;
+  const uint32_t* top = integral.data() + y * stride;
+  const uint32_t* bottom = integral.data() + (y + height) * stride;
+  return bottom[x + width] - bottom[x] - top[x + width] + top[x];
+}
+
+uint64_t SearchImage::SquareSum(int x, int y, int width, int height) const {
+  const size_t stride = static_cast<size_t>(gray.width) + 1;
+  const uint64_t* top = sqIntegral.data() + y * stride;
+  const uint64_t* bottom = sqIntegral.data() + (y + height) * stride;
+  return bottom[x + width] - bottom[x] - top[x + width] + top[x];
+}
+
+// ---------------- SearchPyramid ----------------
+
+void SearchPyramid::Prepare(const ImageView& image, ThreadPool& pool) {
+  if (levels.empty()) {
+    levels.resize(1);
+  }
+  levels[0].Prepare(image, pool);
+  levelCount = 1;
+}
+
+void SearchPyramid::EnsureLevels(int count, ThreadPool& pool) {
+  if (levelCount == 0) {
+    return;
+  }
+  while (levelCount < count) {
+    const SearchImage& finer = levels[levelCount - 1];
+    if (finer.Width() < 2 || finer.Height() < 2) {
+      return;
+    }
+    if (static_cast<int>(levels.size()) <= levelCount) {
+      levels.emplace_back();
+    }
+    levels[levelCount].PrepareDownscaled(levels[levelCount - 1], pool);
+    levelCount++;
+  }
+}
+
+// ---------------- TemplateMatcher ----------------
+
+namespace {
+
+// 每个候选位置的窗口和与方差
+struct WindowStats {
+  double sum;
+  double variance;
+};
+
+WindowStats ComputeStats(const SearchImage& haystack, int x, int y, int w, int h) {
+  const double n = static_cast<double>(w) * h;
+  const double sum = haystack.Sum(x, y, w, h);
+  return {sum, static_cast<double>(haystack.SquareSum(x, y, w, h)) - sum * sum / n};
+}
+
+// 零均值归一化互相关：
+//   Σ(H - mH)(T - mT) = ΣH·C - mH·ΣC，其中C = T - round(mT)
+double ScoreNcc(const SearchImage& haystack, const Template& needle, int x, int y, const WindowStats& stats) {
+  const int w = needle.Width();
+  const int h = needle.Height();
+  const double n = static_cast<double>(w) * h;
+
+  if (needle.CenteredNorm() < kFlatVariance) {
+    // 纯色模板只能与同色纯色区域匹配
+    return (stats.variance / n < 1.0 && std::fabs(stats.sum / n - needle.Mean()) < 1.0) ? 1.0 : 0.0;
+  }
+  if (stats.variance < kFlatVariance) {
+    return 0.0;
+  }
+
+  const GrayImage& gray = haystack.Gray();
+  const int16_t* centered = needle.Centered().data();
+  int64_t cross = 0;
+  for (int row = 0; row < h; row++) {
+    cross += Simd::Dot(gray.Row(y + row) + x, centered + static_cast<size_t>(row) * w, w);
+  }
+  const double correlation =
+      static_cast<double>(cross) - stats.sum / n * static_cast<double>(needle.CenteredSum());
+  return std::clamp(correlation / std::sqrt(stats.variance * needle.CenteredNorm()), -1.0, 1.0);
+}
+
+// SAD/SSD：误差超过limit时立即放弃该位置
+double ScoreDifference(const SearchImage& haystack, const Template& needle, MatchMethod method, int x, int y,
+                       double limit) {
+  const int w = needle.Width();
+  const int h = needle.Height();
+  const GrayImage& gray = haystack.Gray();
+  const GrayImage& templ = needle.Gray();
+  uint64_t error = 0;
+  for (int row = 0; row < h; row++) {
+    const uint8_t* a = gray.Row(y + row) + x;
+    const uint8_t* b = templ.Row(row);
+    error += (method == MatchMethod::SAD) ? Simd::Sad(a, b, w) : Simd::Ssd(a, b, w);
+    if (static_cast<double>(error) > limit) {
+      return kRejected;
+    }
+  }
+  const double scale = (method == MatchMethod::SAD) ? 255.0 : 255.0 * 255.0;
+  return 1.0 - static_cast<double>(error) / (scale * w * h);
+}
+
+// 得分不低于minScore所允许的最大误差
+double ErrorLimit(MatchMethod method, double minScore, const Template& needle) {
+  const double scale = (method == MatchMethod::SAD) ? 255.0 : 255.0 * 255.0;
+  return (1.0 - minScore) * scale * needle.Width() * needle.Height();
+}
+
+}  // namespace
+
+// 单个模板（某一缩放比例）在某一层级上的扫描任务
+struct TemplateMatcher::ScanJob {
+  const Template* needle = nullptr;
+  double minScore = 0.0;    // 候选的最低得分
+  double errorLimit = 0.0;  // SAD/SSD提前终止的误差上限
+  std::vector<std::vector<Candidate>> bandPeaks;
+  std::vector<Candidate> candidates;
+};
+
+TemplateMatcher::TemplateMatcher(ThreadPool& pool) : pool(pool) {}
+
+double TemplateMatcher::Score(const SearchImage& haystack, const Template& needle, MatchMethod method, int x,
+                              int y) const {
+  if (method == MatchMethod::NCC) {
+    return ScoreNcc(haystack, needle, x, y, ComputeStats(haystack, x, y, needle.Width(), needle.Height()));
+  }
+  return ScoreDifference(haystack, needle, method, x, y, std::numeric_limits<double>::infinity());
+}
+
+std::optional<MatchResult> TemplateMatcher::FindBest(const ImageView& haystack, const Template& needle,
+                                                     const MatchOptions& options) {
+  scratch.Prepare(haystack, pool);
+  return FindBest(scratch, needle, options);
+}
+
+std::optional<MatchResult> TemplateMatcher::FindBest(const SearchImage& haystack, const Template& needle,
+                                                     const MatchOptions& options) const {
+  if (needle.Empty() || needle.Width() > haystack.Width() || needle.Height() > haystack.Height()) {
+    return std::nullopt;
+  }
+
+  const int columns = haystack.Width() - needle.Width() + 1;
+  const int rows = haystack.Height() - needle.Height() + 1;
+  const int maxTasks = static_cast<int>(pool.Size()) * kTasksPerThread;
+  const int tasks = std::max(1, std::min(maxTasks, rows / kMinRowsPerTask));
+
+  std::vector<BandBest> bests(tasks);
+  pool.ParallelFor(0, tasks, [&](int task) {
+    BandBest& best = bests[task];
+    const int y0 = SplitPoint(rows, tasks, task);
+    const int y1 = SplitPoint(rows, tasks, task + 1);
+    for (int y = y0; y < y1; y++) {
+      for (int x = 0; x < columns; x++) {
+        double score;
+        if (options.method == MatchMethod::NCC) {
+          score = Score(haystack, needle, MatchMethod::NCC, x, y);
+        } else {
+          const double minScore = std::max(options.threshold, best.score);
+          score = ScoreDifference(haystack, needle, options.method, x, y,
+                                  ErrorLimit(options.method, minScore, needle));
+        }
+        if (score > best.score && score >= options.threshold) {
+          best = {score, x, y};
+        }
+      }
+    }
+  });
+
+  // 按任务顺序归约，保证结果与线程调度无关
+  const BandBest* winner = nullptr;
+  for (const BandBest& best : bests) {
+    if (best.score != kRejected && (winner == nullptr || best.score > winner->score)) {
+      winner = &best;
+    }
+  }
+  if (winner == nullptr) {
+    return std::nullopt;
+  }
+  return MatchResult{{winner->x, winner->y, needle.Width(), needle.Height()}, winner->score};
+}
+
+std::vector<MatchResult> TemplateMatcher::FindAll(const SearchImage& haystack, const Template& needle,
+                                                  const MatchOptions& options,
+                                                  const MatchCallback& onMatch) const {
+  std::vector<MatchResult> results;
+  if (needle.Empty() || needle.Width() > haystack.Width() || needle.Height() > haystack.Height()) {
+    return results;
+  }
+
+  const int w = needle.Width();
+  const int h = needle.Height();
+  const int columns = haystack.Width() - w + 1;
+  const int rows = haystack.Height() - h + 1;
+  const int maxTasks = static_cast<int>(pool.Size()) * kTasksPerThread;
+  const int tasks = std::max(1, std::min(maxTasks, rows / kMinRowsPerTask));
+  const double errorLimit =
+      (options.method == MatchMethod::NCC) ? 0.0 : ErrorLimit(options.method, options.threshold, needle);
+
+  struct Band {
+    int y0 = 0;
+    int y1 = 0;
+    std::vector<Candidate> peaks;
+    std::vector<uint8_t> states;  // 与peaks对应的抑制状态
+    bool done = false;
+    bool emitted = false;
+  };
+  // UNRESOLVED：尚未确定；PENDING：本轮中依赖未完成的行带，轮末恢复为UNRESOLVED
+  enum : uint8_t { UNRESOLVED, KEPT, SUPPRESSED, PENDING };
+  std::vector<Band> bands(tasks);
+  for (int task = 0; task < tasks; task++) {
+    bands[task].y0 = SplitPoint(rows, tasks, task);
+    bands[task].y1 = SplitPoint(rows, tasks, task + 1);
+  }
+
+  // 同尺寸矩形的交并比
+  auto overlapRatio = [w, h](const Candidate& a, const Candidate& b) {
+    const double ix = std::max(0, w - std::abs(a.x - b.x));
+    const double iy = std::max(0, h - std::abs(a.y - b.y));
+    const double intersection = ix * iy;
+    return intersection / (2.0 * w * h - intersection);
+  };
+  // a是否优先于b：得分更高，得分相同时更靠上、靠左
+  auto beats = [](const Candidate& a, const Candidate& b) {
+    if (a.score != b.score) {
+      return a.score > b.score;
+    }
+    return a.y != b.y ? a.y < b.y : a.x < b.x;
+  };
+  // 与[y0, y1)中的候选可能重叠的行带下标范围
+  auto neighbourBands = [&](int y0, int y1, int& first, int& last) {
+    first = 0;
+    while (first < tasks - 1 && bands[first].y1 <= y0 - (h - 1)) {
+      first++;
+    }
+    last = first;
+    while (last < tasks - 1 && bands[last + 1].y0 <= y1 - 1 + (h - 1)) {
+      last++;
+    }
+  };
+
+  // 贪心非极大值抑制：候选被保留当且仅当所有优先于它且重叠的候选都被抑制。
+  // 抑制关系可以跨多个行带连锁传递，用显式栈求值，依赖未完成行带的候选本轮保持未确定。调用时需持有mutex
+  struct Frame {
+    int band;
+    size_t index;
+    int first;
+    int last;
+    int other;
+    size_t rival;
+    bool pending;
+  };
+  std::vector<Frame> stack;
+  std::vector<std::pair<int, size_t>> pendingMarks;
+  auto push = [&](int band, size_t index) {
+    Frame frame{band, index, 0, 0, 0, 0, false};
+    neighbourBands(bands[band].y0, bands[band].y1, frame.first, frame.last);
+    frame.other = frame.first;
+    stack.push_back(frame);
+  };
+  auto resolve = [&](int band, size_t index) {
+    push(band, index);
+    while (!stack.empty()) {
+      Frame& frame = stack.back();
+      const Candidate& candidate = bands[frame.band].peaks[frame.index];
+      uint8_t result = UNRESOLVED;
+      bool descended = false;
+      for (; frame.other <= frame.last && !descended; frame.other++, frame.rival = 0) {
+        Band& otherBand = bands[frame.other];
+        if (!otherBand.done) {
+          // 未完成的行带中可能有优先且重叠的候选
+          frame.pending = true;
+          continue;
+        }
+        for (; frame.rival < otherBand.peaks.size(); frame.rival++) {
+          const Candidate& rival = otherBand.peaks[frame.rival];
+          if (!beats(rival, candidate) || overlapRatio(rival, candidate) <= options.maxOverlap) {
+            continue;
+          }
+          const uint8_t state = otherBand.states[frame.rival];
+          if (state == KEPT) {
+            result = SUPPRESSED;
+            break;
+          }
+          if (state == PENDING) {
+            frame.pending = true;
+          } else if (state == UNRESOLVED) {
+            descended = true;
+            break;
+          }
+        }
+        if (result == SUPPRESSED || descended) {
+          break;
+        }
+      }
+      if (descended) {
+        // 先求出该对手的状态，返回后重新检查同一对手
+        push(frame.other, frame.rival);
+        continue;
+      }
+      if (result != SUPPRESSED) {
+        result = frame.pending ? PENDING : KEPT;
+      }
+      bands[frame.band].states[frame.index] = result;
+      if (result == PENDING) {
+        pendingMarks.emplace_back(frame.band, frame.index);
+      }
+      stack.pop_back();
+    }
+  };
+
+  std::mutex mutex;
+  std::mutex callbackMutex;
+  pool.ParallelFor(0, tasks, [&](int task) {
+    Band& band = bands[task];
+    // 多算上下各一行，用于判断行带边缘处的局部极大值
+    const int lo = std::max(0, band.y0 - 1);
+    const int hi = std::min(rows, band.y1 + 1);
+    std::vector<double> scores(static_cast<size_t>(hi - lo) * columns);
+    for (int y = lo; y < hi; y++) {
+      double* out = scores.data() + static_cast<size_t>(y - lo) * columns;
+      for (int x = 0; x < columns; x++) {
+        out[x] = (options.method == MatchMethod::NCC)
+                     ? Score(haystack, needle, options.method, x, y)
+                     : ScoreDifference(haystack, needle, options.method, x, y, errorLimit);
+      }
+    }
+
+    std::vector<Candidate> peaks;
+    for (int y = band.y0; y < band.y1; y++) {
+      for (int x = 0; x < columns; x++) {
+        const double score = scores[static_cast<size_t>(y - lo) * columns + x];
+        if (score < options.threshold) {
+          continue;
+        }
+        bool isPeak = true;
+        for (int ny = std::max(lo, y - 1); ny <= std::min(hi - 1, y + 1) && isPeak; ny++) {
+          for (int nx = std::max(0, x - 1); nx <= std::min(columns - 1, x + 1); nx++) {
+            if (scores[static_cast<size_t>(ny - lo) * columns + nx] > score) {
+              isPeak = false;
+              break;
+            }
+          }
+        }
+        if (isPeak) {
+          peaks.push_back({score, x, y});
+        }
+      }
+    }
+
+    std::vector<MatchResult> emitted;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      band.states.assign(peaks.size(), UNRESOLVED);
+      band.peaks = std::move(peaks);
+      band.done = true;
+
+      // 行带中所有候选的状态都确定后即可输出
+      for (int index = 0; index < tasks; index++) {
+        Band& candidateBand = bands[index];
+        if (candidateBand.emitted || !candidateBand.done) {
+          continue;
+        }
+        bool ready = true;
+        for (size_t i = 0; i < candidateBand.peaks.size(); i++) {
+          if (candidateBand.states[i] == UNRESOLVED) {
+            resolve(index, i);
+          }
+          ready = ready && candidateBand.states[i] != PENDING;
+        }
+        for (const auto& [pendingBand, pendingIndex] : pendingMarks) {
+          bands[pendingBand].states[pendingIndex] = UNRESOLVED;
+        }
+        pendingMarks.clear();
+        if (!ready) {
+          continue;
+        }
+        for (size_t i = 0; i < candidateBand.peaks.size(); i++) {
+          if (candidateBand.states[i] == KEPT) {
+            const Candidate& candidate = candidateBand.peaks[i];
+            results.push_back({{candidate.x, candidate.y, w, h}, candidate.score});
+            emitted.push_back(results.back());
+          }
+        }
+        candidateBand.emitted = true;
+      }
+    }
+
+    // 回调在行带锁之外执行，慢的回调（如点击）不会阻塞其他行带；回调之间仍然串行。
+    // 回调抛出的异常由ParallelFor在调用线程重新抛出
+    if (onMatch && !emitted.empty()) {
+      std::lock_guard<std::mutex> lock(callbackMutex);
+      for (const MatchResult& match : emitted) {
+        onMatch(match);
+      }
+    }
+  });
+
+  std::sort(results.begin(), results.end(), [](const MatchResult& a, const MatchResult& b) {
+    return a.rect.y != b.rect.y ? a.rect.y < b.rect.y : a.rect.x < b.rect.x;
+  });
+  return results;
+}
+
+void TemplateMatcher::ScanLevel(const SearchImage& image, const std::vector<ScanJob*>& jobs,
+                                MatchMethod method) const {
+  // 按模板尺寸分组，同组共享窗口统计量
+  std::vector<ScanJob*> sorted = jobs;
+  std::stable_sort(sorted.begin(), sorted.end(), [](const ScanJob* a, const ScanJob* b) {
+    return a->needle->Width() != b->needle->Width() ? a->needle->Width() < b->needle->Width()
+                                                    : a->needle->Height() < b->needle->Height();
+  });
+  struct Group {
+    int width;
+    int height;
+    size_t begin;
+    size_t end;
+  };
+  std::vector<Group> groups;
+  int minHeight = image.Height();
+  for (size_t i = 0; i < sorted.size(); i++) {
+    const int w = sorted[i]->needle->Width();
+    const int h = sorted[i]->needle->Height();
+    if (groups.empty() || groups.back().width != w || groups.back().height != h) {
+      groups.push_back({w, h, i, i});
+    }
+    groups.back().end = i + 1;
+    minHeight = std::min(minHeight, h);
+  }
+
+  const int maxRows = image.Height() - minHeight + 1;
+  const int maxTasks = static_cast<int>(pool.Size()) * kTasksPerThread;
+  const int tasks = std::max(1, std::min(maxTasks, maxRows / kMinRowsPerTask));
+  for (ScanJob* job : sorted) {
+    job->bandPeaks.assign(tasks, {});
+  }
+
+  pool.ParallelFor(0, tasks, [&](int task) {
+    const int y0 = SplitPoint(maxRows, tasks, task);
+    const int y1 = SplitPoint(maxRows, tasks, task + 1);
+    const int lo = std::max(0, y0 - 1);
+    const int hi = std::min(maxRows, y1 + 1);
+
+    // 每个模板只保留最近三行的得分，内存占用与被搜索图像高度无关
+    std::vector<std::vector<float>> ring(sorted.size());
+    for (size_t j = 0; j < sorted.size(); j++) {
+      ring[j].resize(static_cast<size_t>(image.Width() - sorted[j]->needle->Width() + 1) * 3);
+    }
+
+    // 第row行的局部极大值，需要row + 1行已计算（若存在）
+    auto collectRow = [&](int row) {
+      for (size_t j = 0; j < sorted.size(); j++) {
+        ScanJob& job = *sorted[j];
+        const int columns = image.Width() - job.needle->Width() + 1;
+        const int rows = std::min(hi, image.Height() - job.needle->Height() + 1);
+        if (row >= rows) {
+          continue;
+        }
+        const int firstRow = std::max(lo, row - 1);
+        const int lastRow = std::min(rows - 1, row + 1);
+        const float* current = ring[j].data() + static_cast<size_t>(row % 3) * columns;
+        for (int x = 0; x < columns; x++) {
+          const float score = current[x];
+          if (score < job.minScore) {
+            continue;
+          }
+          bool isPeak = true;
+          for (int ny = firstRow; ny <= lastRow && isPeak; ny++) {
+            const float* neighbours = ring[j].data() + static_cast<size_t>(ny % 3) * columns;
+            for (int nx = std::max(0, x - 1); nx <= std::min(columns - 1, x + 1); nx++) {
+              if (neighbours[nx] > score) {
+                isPeak = false;
+                break;
+              }
+            }
+          }
+          if (isPeak) {
+            job.bandPeaks[task].push_back({score, x, row});
+          }
+        }
+      }
+    };
+
+    for (int y = lo; y < hi; y++) {
+      for (const Group& group : groups) {
+        if (y > image.Height() - group.height) {
+          continue;
+        }
+        const int columns = image.Width() - group.width + 1;
+        for (int x = 0; x < columns; x++) {
+          WindowStats stats{};
+          if (method == MatchMethod::NCC) {
+            stats = ComputeStats(image, x, y, group.width, group.height);
+          }
+          for (size_t j = group.begin; j < group.end; j++) {
+            const ScanJob& job = *sorted[j];
+            const double score = (method == MatchMethod::NCC)
+                                     ? ScoreNcc(image, *job.needle, x, y, stats)
+                                     : ScoreDifference(image, *job.needle, method, x, y, job.errorLimit);
+            ring[j][static_cast<size_t>(y % 3) * columns + x] = static_cast<float>(score);
+          }
+        }
+      }
+      if (y - 1 >= y0 && y - 1 < y1) {
+        collectRow(y - 1);
+      }
+    }
+    if (hi == y1) {
+      collectRow(y1 - 1);
+    }
+  });
+
+  // 合并各行带的候选；相互重叠超过半个模板的只保留得分最高者
+  for (ScanJob* job : sorted) {
+    std::vector<Candidate> peaks;
+    for (auto& band : job->bandPeaks) {
+      peaks.insert(peaks.end(), band.begin(), band.end());
+    }
+    job->bandPeaks.clear();
+    std::stable_sort(peaks.begin(), peaks.end(),
+                     [](const Candidate& a, const Candidate& b) { return a.score > b.score; });
+    const int w = job->needle->Width();
+    const int h = job->needle->Height();
+    job->candidates.clear();
+    for (const Candidate& candidate : peaks) {
+      const bool overlaps = std::any_of(job->candidates.begin(), job->candidates.end(), [&](const Candidate& other) {
+        return std::abs(other.x - candidate.x) * 2 < w && std::abs(other.y - candidate.y) * 2 < h;
+      });
+      if (!overlaps) {
+        job->candidates.push_back(candidate);
+        if (static_cast<int>(job->candidates.size()) == kMaxCandidates) {
+          break;
+        }
+      }
+    }
+  }
+}
+
+TemplateMatcher::Candidate TemplateMatcher::SearchWindow(const SearchImage& haystack, const Template& needle,
+                                                         MatchMethod method, Rect positions) const {
+  Candidate best{kRejected, positions.x, positions.y};
+  for (int y = positions.y; y < positions.y + positions.height; y++) {
+    for (int x = positions.x; x < positions.x + positions.width; x++) {
+      const double score = Score(haystack, needle, method, x, y);
+      if (score > best.score) {
+        best = {score, x, y};
+      }
+    }
+  }
+  return best;
+}
+
+SearchPyramid& TemplateMatcher::PreparePyramid(const ImageView& image, uint64_t frameId) {
+  const bool reusable = frameId != 0 && frameId == pyramidFrameId && image.data == pyramidSource.data &&
+                        image.width == pyramidSource.width && image.height == pyramidSource.height &&
+                        image.stride == pyramidSource.stride;
+  if (!reusable) {
+    pyramid.Prepare(image, pool);
+    pyramidFrameId = frameId;
+    pyramidSource = image;
+  }
+  return pyramid;
+}
+
+std::optional<MatchResult> TemplateMatcher::FindBest(SearchPyramid& haystack, const TemplatePyramid& needle,
+                                                     const MatchOptions& options) const {
+  return FindBestMany(haystack, {&needle}, options).front();
+}
+
+std::vector<std::optional<MatchResult>> TemplateMatcher::FindBestMany(
+    SearchPyramid& haystack, const std::vector<const TemplatePyramid*>& needles, const MatchOptions& options) const {
+  std::vector<std::optional<MatchResult>> results(needles.size());
+  if (haystack.Levels() == 0) {
+    return results;
+  }
+
+  int maxLevels = 0;
+  for (const TemplatePyramid* needle : needles) {
+    if (needle != nullptr) {
+      maxLevels = std::max(maxLevels, needle->MaxLevels());
+    }
+  }
+  haystack.EnsureLevels(maxLevels, pool);
+
+  struct Job {
+    size_t needle;
+    const TemplatePyramid::Scaled* entry;
+    int top;
+    ScanJob scan;
+  };
+  std::vector<Job> jobs;
+  int maxTop = 0;
+  for (size_t i = 0; i < needles.size(); i++) {
+    if (needles[i] == nullptr) {
+      continue;
+    }
+    for (const TemplatePyramid::Scaled& entry : needles[i]->Scales()) {
+      // 最粗一级：模板与被搜索图像都存在且模板能放进去
+      int top = std::min(static_cast<int>(entry.levels.size()), haystack.Levels()) - 1;
+      while (top >= 0 && (entry.levels[top].Width() > haystack.Level(top).Width() ||
+                          entry.levels[top].Height() > haystack.Level(top).Height())) {
+        top--;
+      }
+      if (top < 0) {
+        continue;
+      }
+      Job job{i, &entry, top, {}};
+      job.scan.needle = &entry.levels[top];
+      // 降采样会降低得分，粗搜阶段放宽阈值
+      job.scan.minScore = (top > 0) ? options.threshold - kCoarseMargin : options.threshold;
+      if (options.method != MatchMethod::NCC) {
+        job.scan.errorLimit = ErrorLimit(options.method, job.scan.minScore, *job.scan.needle);
+      }
+      jobs.push_back(std::move(job));
+      maxTop = std::max(maxTop, top);
+    }
+  }
+
+  // 每个层级一次扫描，覆盖以该层为最粗一级的全部模板
+  for (int level = 0; level <= maxTop; level++) {
+    std::vector<ScanJob*> scans;
+    for (Job& job : jobs) {
+      if (job.top == level) {
+        scans.push_back(&job.scan);
+      }
+    }
+    if (!scans.empty()) {
+      ScanLevel(haystack.Level(level), scans, options.method);
+    }
+  }
+
+  // 细化：每一级坐标翻倍，只在±2像素的窗口内重新打分；
+  // 以原始分辨率为最粗一级的候选按double精度重新打分（扫描时得分以float保存）
+  std::vector<std::pair<Job*, Candidate*>> pending;
+  for (Job& job : jobs) {
+    for (Candidate& candidate : job.scan.candidates) {
+      pending.emplace_back(&job, &candidate);
+    }
+  }
+  constexpr int kRefineRadius = 2;
+  pool.ParallelFor(0, static_cast<int>(pending.size()), [&](int index) {
+    const Job& job = *pending[index].first;
+    Candidate& candidate = *pending[index].second;
+    if (job.top == 0) {
+      candidate.score = Score(haystack.Level(0), *job.scan.needle, options.method, candidate.x, candidate.y);
+      return;
+    }
+    for (int level = job.top - 1; level >= 0; level--) {
+      const SearchImage& image = haystack.Level(level);
+      const Template& templ = job.entry->levels[level];
+      const int maxX = image.Width() - templ.Width();
+      const int maxY = image.Height() - templ.Height();
+      if (maxX < 0 || maxY < 0) {  // 奇数尺寸取整导致模板在更精细一级放不下
+        candidate.score = kRejected;
+        return;
+      }
+      const int x0 = std::clamp(candidate.x * 2 - kRefineRadius, 0, maxX);
+      const int y0 = std::clamp(candidate.y * 2 - kRefineRadius, 0, maxY);
+      const int x1 = std::min(candidate.x * 2 + kRefineRadius, maxX);
+      const int y1 = std::min(candidate.y * 2 + kRefineRadius, maxY);
+      candidate = SearchWindow(image, templ, options.method, {x0, y0, x1 - x0 + 1, y1 - y0 + 1});
+    }
+  });
+
+  // 每个模板取所有缩放比例中得分最高者，得分相同时取最靠上、最靠左者
+  for (const Job& job : jobs) {
+    const Template& full = job.entry->levels[0];
+    for (const Candidate& candidate : job.scan.candidates) {
+      if (candidate.score < options.threshold) {
+        continue;
+      }
+      std::optional<MatchResult>& best = results[job.needle];
+      if (!best || candidate.score > best->score ||
+          (candidate.score == best->score &&
+           (candidate.y < best->rect.y || (candidate.y == best->rect.y && candidate.x < best->rect.x)))) {
+        best = MatchResult{{candidate.x, candidate.y, full.Width(), full.Height()}, candidate.score,
+                           job.entry->scale};
+      }
+    }
+  }
+  return results;
+}
+
+}  // namespace Robot
@@ -0,0 +1,210 @@
+#pragma once
+
+#include "./Image.h"
+#include "./Screen.h"
+#include "./ThreadPool.h"
+#include "./types.h"
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <vector>
+
+namespace Robot {
+
+// 匹配度量，得分统一映射为越大越相似，完全一致时为1
+enum class MatchMethod {
+  NCC,  // 归一化互相关（零均值），对整体亮度/对比度变化不敏感
+  SAD,  // 1 - 绝对差之和 / (255 * 像素数)
+  SSD,  // 1 - 差平方和 / (255^2 * 像素数)
+};
+
+struct MatchOptions {
+  MatchMethod method = MatchMethod::NCC;
+  double threshold = 0.9;  // 低于该得分的位置不视为匹配
+  double maxOverlap = 0.3;  // FindAll：交并比超过该值的匹配只保留得分最高者
+};
+
+struct MatchResult {
+  Rect rect;          // 匹配区域，坐标相对于被搜索图像
+  double score;       // 匹配得分
+  double scale = 1.0;  // 命中的模板缩放比例（金字塔搜索）
+};
+
+// 流式返回匹配结果的回调，在行带锁之外执行，同一次搜索中不会被并发调用；抛出异常时搜索停止并由FindAll重新抛出
+using MatchCallback = std::function<void(const MatchResult&)>;
+
+// 预处理后的模板：灰度、零均值系数与范数，构造一次后可反复匹配
+class Template {
+ public:
+  Template() = default;
+  explicit Template(const ImageView& image);
+  explicit Template(GrayImage gray);
+
+  int Width() const { return gray.width; }
+  int Height() const { return gray.height; }
+  bool Empty() const { return gray.width <= 0 || gray.height <= 0; }
+  const GrayImage& Gray() const { return gray; }
+
+  // NCC所需的预计算量
+  const std::vector<int16_t>& Centered() const { return centered; }
+  int64_t CenteredSum() const { return centeredSum; }
+  double CenteredNorm() const { return centeredNorm; }
+  double Mean() const { return mean; }
+
+ private:
+  void Init();
+
+  GrayImage gray;
+  std::vector<int16_t> centered;  // 灰度减去取整后的均值
+  int64_t centeredSum = 0;        // centered之和（取整误差，计算时精确补偿）
+  double centeredNorm = 0;        // Σ(centered - centeredSum / n)^2
+  double mean = 0;
+};
+
+// 模板金字塔：每个缩放比例一组逐级2倍降采样的模板
+// 最粗一级的短边不小于kMinLevelSize，保证粗搜得分仍有区分度
+class TemplatePyramid {
+ public:
+  static constexpr int kMinLevelSize = 8;
+  static constexpr int kMaxLevels = 5;
+
+  struct Scaled {
+    double scale = 1.0;
+    std::vector<Template> levels;  // levels[0]为该比例下的原始分辨率
+  };
+
+  TemplatePyramid() = default;
+
+  // scales为相对needle的缩放比例，例如{1.0, 1.25, 1.5}对应100%/125%/150% DPI
+  explicit TemplatePyramid(const ImageView& image, const std::vector<double>& scales = {1.0});
+
+  const std::vector<Scaled>& Scales() const { return scaled; }
+  bool Empty() const { return scaled.empty(); }
+
+  // 所有比例中最深的层数
+  int MaxLevels() const;
+
+ private:
+  std::vector<Scaled> scaled;
+};
+
+// 预处理后的被搜索图像：灰度与积分图
+// 和积分图使用uint32按模2^32回绕，只要单个矩形的真实和小于2^32，差分结果仍然精确
+class SearchImage {
+ public:
+  // 按行带并行转换灰度并构建积分图，内部缓冲区会被复用
+  void Prepare(const ImageView& image, ThreadPool& pool);
+
+  // 由更精细的一级2倍降采样得到
+  void PrepareDownscaled(const SearchImage& finer, ThreadPool& pool);
+
+  int Width() const { return gray.width; }
+  int Height() const { return gray.height; }
+  const GrayImage& Gray() const { return gray; }
+
+  uint32_t Sum(int x, int y, int width, int height) const;
+  uint64_t SquareSum(int x, int y, int width, int height) const;
+
+ private:
+  // gray已就绪时source为nullptr，否则同时完成灰度转换
+  void Build(const ImageView* source, ThreadPool& pool);
+
+  GrayImage gray;
+  std::vector<uint32_t> integral;    // (width + 1) * (height + 1)
+  std::vector<uint64_t> sqIntegral;  // (width + 1) * (height + 1)
+};
+
+// 被搜索图像金字塔，levels[0]为原始分辨率，按需逐级扩展
+class SearchPyramid {
+ public:
+  void Prepare(const ImageView& image, ThreadPool& pool);
+
+  // 保证至少有count级（受图像尺寸限制）
+  void EnsureLevels(int count, ThreadPool& pool);
+
+  int Levels() const { return levelCount; }
+  const SearchImage& Level(int index) const { return levels[index]; }
+
+ private:
+  std::vector<SearchImage> levels;  // 缓冲区保留以便复用
+  int levelCount = 0;
+};
+
+// 模板匹配引擎
+// 候选位置按行分块交给线程池，每个位置逐行调用运行时选择的SIMD内核（见Simd.h）。
+// SAD/SSD在部分和已超出当前最优或阈值所允许的误差时提前终止。
+// 金字塔模式先在最粗一级全图搜索候选，再逐级只在候选附近细化；多个模板可共用一次扫描。
+// 同一实例不能被多个线程同时使用。
+class TemplateMatcher {
+ public:
+  // 粗搜阶段保留的最大候选数
+  static constexpr int kMaxCandidates = 32;
+
+  // 粗搜阶段相对阈值放宽的幅度（降采样会降低得分）
+  static constexpr double kCoarseMargin = 0.25;
+
+  explicit TemplateMatcher(ThreadPool& pool = ThreadPool::Default());
+
+  // 返回得分最高且不低于阈值的位置，得分相同时取最靠上、最靠左者
+  std::optional<MatchResult> FindBest(const SearchImage& haystack, const Template& needle,
+                                      const MatchOptions& options = {}) const;
+
+  // 先预处理haystack（使用内部缓冲区）再搜索
+  std::optional<MatchResult> FindBest(const ImageView& haystack, const Template& needle,
+                                      const MatchOptions& options = {});
+
+  // 金字塔从粗到细搜索，遍历needle的所有缩放比例，返回得分最高者
+  std::optional<MatchResult> FindBest(SearchPyramid& haystack, const TemplatePyramid& needle,
+                                      const MatchOptions& options = {}) const;
+
+  // 多模板单次扫描，返回值与needles一一对应
+  // 粗搜阶段同一金字塔层级上的所有模板共用一次按行带的扫描：每行的被搜索图像数据在缓存中时依次计算所有模板，
+  // 尺寸相同的模板共享窗口的和与方差，因此被搜索图像只需从内存读取一遍
+  std::vector<std::optional<MatchResult>> FindBestMany(SearchPyramid& haystack,
+                                                       const std::vector<const TemplatePyramid*>& needles,
+                                                       const MatchOptions& options = {}) const;
+
+  // 返回所有得分不低于阈值的匹配（按从上到下、从左到右排序），重叠的匹配经贪心非极大值抑制
+  // （按得分从高到低，只有被保留的匹配才能抑制其他匹配）
+  // onMatch非空时，某个行带中所有候选的去留都能确定（通常在上下相邻的行带完成后）即回调其中保留的匹配，
+  // 调用方可以在整幅扫描结束前开始处理
+  std::vector<MatchResult> FindAll(const SearchImage& haystack, const Template& needle,
+                                   const MatchOptions& options = {},
+                                   const MatchCallback& onMatch = nullptr) const;
+
+  // 预处理并缓存被搜索图像金字塔
+  // frameId非0、与上次相同且image指向同一块内存、尺寸一致时直接复用上次结果
+  SearchPyramid& PreparePyramid(const ImageView& image, uint64_t frameId);
+
+  // 计算模板左上角位于(x, y)时的得分，调用方保证位置合法
+  double Score(const SearchImage& haystack, const Template& needle, MatchMethod method, int x,
+               int y) const;
+
+  ThreadPool& Pool() const { return pool; }
+
+ private:
+  struct Candidate {
+    double score;
+    int x;
+    int y;
+  };
+
+  struct ScanJob;
+
+  // 在同一层级上一次扫描所有jobs，收集各自的候选（局部极大值，已排序并抑制重叠）
+  void ScanLevel(const SearchImage& image, const std::vector<ScanJob*>& jobs, MatchMethod method) const;
+
+  // 在positions范围内（左上角坐标，已裁剪）寻找最优位置
+  Candidate SearchWindow(const SearchImage& haystack, const Template& needle, MatchMethod method,
+                         Rect positions) const;
+
+  ThreadPool& pool;
+  SearchImage scratch;
+
+  SearchPyramid pyramid;
+  uint64_t pyramidFrameId = 0;
+  ImageView pyramidSource;
+};
+
+}  // namespace Robot
@@ -0,0 +1,122 @@
+#include "./ThreadPool.h"
+
+#include <algorithm>
+#include <exception>
+
+namespace Robot {
+
+ThreadPool::ThreadPool(size_t threads) {
+  if (threads == 0) {
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  workers.reserve(threads);
+  for (size_t i = 0; i < threads; i++) {
+    workers.emplace_back(&ThreadPool::WorkerLoop, this);
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  condition.notify_all();
+  for (auto& worker : workers) {
+    worker.join();
+  }
+}
+
+ThreadPool& ThreadPool::Default() {
+  static ThreadPool pool;
+  return pool;
+}
+
+void ThreadPool::Enqueue(std::function<void()> task) {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    tasks.push_back(std::move(task));
+  }
+  condition.notify_one();
+}
+
+void ThreadPool::WorkerLoop() {
+  while (true) {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      condition.wait(lock, [this] { return stopping || !tasks.empty(); });
+      if (stopping && tasks.empty()) {
+        return;
+      }
+      task = std::move(tasks.front());
+      tasks.pop_front();
+    }
+    task();
+  }
+}
+
+void ThreadPool::ParallelFor(int begin, int end, const std::function<void(int)>& body) {
+  if (end <= begin) {
+    return;
+  }
+  if (end - begin == 1) {
+    body(begin);
+    return;
+  }
+
+  // 共享状态放在堆上，工作线程可能在调用线程返回后才领取到已无剩余下标的辅助任务
+  struct State {
+    std::atomic<int> next;
+    std::atomic<int> remaining;
+    int end;
+    const std::function<void(int)>* body;
+    std::atomic<bool> failed{false};
+    std::exception_ptr error;  // 第一个异常，由mutex保护
+    std::mutex mutex;
+    std::condition_variable done;
+  };
+  auto state = std::make_shared<State>();
+  state->next = begin;
+  state->remaining = end - begin;
+  state->end = end;
+  state->body = &body;
+
+  auto run = [](const std::shared_ptr<State>& s) {
+    while (true) {
+      const int index = s->next.fetch_add(1, std::memory_order_relaxed);
+      if (index >= s->end) {
+        return;
+      }
+      // 出错后剩余下标只计数不执行；异常不能逃出工作线程，且必须计数，否则调用线程不会等待仍在使用body的辅助线程
+      if (!s->failed.load(std::memory_order_relaxed)) {
+        try {
+          (*s->body)(index);
+        } catch (...) {
+          std::lock_guard<std::mutex> lock(s->mutex);
+          if (!s->error) {
+            s->error = std::current_exception();
+          }
+          s->failed.store(true, std::memory_order_relaxed);
+        }
+      }
+      if (s->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        std::lock_guard<std::mutex> lock(s->mutex);
+        s->done.notify_all();
+      }
+    }
+  };
+
+  const size_t helpers = std::min(workers.size(), static_cast<size_t>(end - begin - 1));
+  for (size_t i = 0; i < helpers; i++) {
+    Enqueue([state, run]() { run(state); });
+  }
+  run(state);
+
+  std::unique_lock<std::mutex> lock(state->mutex);
+  state->done.wait(lock, [&state] { return state->remaining.load(std::memory_order_acquire) == 0; });
+  if (state->error) {
+    std::rethrow_exception(state->error);
+  }
+}
+
+}  // namespace Robot
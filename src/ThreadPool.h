@@ -0,0 +1,57 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace Robot {
+
+// 固定大小线程池
+// ParallelFor将[begin, end)的任务下标交给工作线程与调用线程共同领取，调用线程阻塞到全部完成。
+// body抛出异常时不再执行尚未开始的下标，等全部已开始的调用结束后在调用线程重新抛出第一个异常。
+class ThreadPool {
+ public:
+  // threads为0时使用硬件线程数
+  explicit ThreadPool(size_t threads = 0);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  size_t Size() const { return workers.size(); }
+
+  template <typename F>
+  auto Submit(F&& task) -> std::future<typename std::invoke_result<F>::type> {
+    using Result = typename std::invoke_result<F>::type;
+    auto packaged = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(task));
+    std::future<Result> result = packaged->get_future();
+    Enqueue([packaged]() { (*packaged)(); });
+    return result;
+  }
+
+  // 并行执行body(i)，i属于[begin, end)
+  void ParallelFor(int begin, int end, const std::function<void(int)>& body);
+
+  // 进程内共享的默认线程池
+  static ThreadPool& Default();
+
+ private:
+  void Enqueue(std::function<void()> task);
+  void WorkerLoop();
+
+  std::vector<std::thread> workers;
+  std::deque<std::function<void()>> tasks;
+  std::mutex mutex;
+  std::condition_variable condition;
+  bool stopping = false;
+};
+
+}  // namespace Robot
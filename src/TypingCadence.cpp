@@ -0,0 +1,250 @@
+#include "./TypingCadence.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+
+namespace Robot {
+
+namespace {
+
+uint64_t SplitMix64(uint64_t& x) {
+  uint64_t z = (x += 0x9E3779B97F4A7C15ULL);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+uint64_t Rotl(uint64_t x, int k) {
+  return (x << k) | (x >> (64 - k));
+}
+
+// 美式QWERTY布局下各手指负责的键（未按Shift的字符），0-3为左手小指到食指，4-7为右手食指到小指
+constexpr const char* kFingerKeys[8] = {
+    "`1qaz", "2wsx", "3edc", "45rtfgvb", "67yuhjnm", "8ik,", "9ol.", "0p;/-=[]'\\"};
+
+// 字母键行，用于选取打错时的相邻键
+constexpr const char* kLetterRows[3] = {"qwertyuiop", "asdfghjkl", "zxcvbnm"};
+
+// 英文中最常见的双字母组合，熟练打字者输入它们明显更快
+constexpr const char* kCommonBigrams[] = {
+    "th", "he", "in", "er", "an", "re", "on", "at", "en", "nd", "ti", "es", "or", "te", "of",
+    "ed", "is", "it", "al", "ar", "st", "to", "nt", "ng", "se", "ha", "as", "ou", "io", "le"};
+
+constexpr char kShiftedDigits[] = ")!@#$%^&*(";
+constexpr char kShiftedSymbols[] = "_+{}|:\"~<>?";
+constexpr char kSymbolBases[] = "-=[]\\;'`,./";
+
+// 把字符还原为实际按下的键（去掉Shift）
+char BaseKey(char c) {
+  if (c >= 'A' && c <= 'Z') {
+    return static_cast<char>(c - 'A' + 'a');
+  }
+  if (const char* p = std::strchr(kShiftedDigits, c); p != nullptr && c != '\0') {
+    return static_cast<char>('0' + (p - kShiftedDigits));
+  }
+  if (const char* p = std::strchr(kShiftedSymbols, c); p != nullptr && c != '\0') {
+    return kSymbolBases[p - kShiftedSymbols];
+  }
+  return c;
+}
+
+bool NeedsShift(char c) {
+  return (c >= 'A' && c <= 'Z') ||
+         (c != '\0' && (std::strchr(kShiftedDigits, c) != nullptr || std::strchr(kShiftedSymbols, c) != nullptr));
+}
+
+// 返回负责该键的手指，空格、回车等返回-1
+int Finger(char base) {
+  if (base == '\0') {
+    return -1;
+  }
+  for (int i = 0; i < 8; i++) {
+    if (std::strchr(kFingerKeys[i], base) != nullptr) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+bool IsCommonBigram(char a, char b) {
+  for (const char* bigram : kCommonBigrams) {
+    if (bigram[0] == a && bigram[1] == b) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool IsSentenceEnd(char c) {
+  return c == '.' || c == '!' || c == '?' || c == ',' || c == ';' || c == ':';
+}
+
+bool Supported(char c) {
+  return (c >= 0x20 && c < 0x7F) || c == '\n' || c == '\t';
+}
+
+// 字母在键盘同一行上的左右邻键，保持大小写
+char Neighbour(char c, uint64_t r) {
+  const bool upper = c >= 'A' && c <= 'Z';
+  const char base = BaseKey(c);
+  for (const char* row : kLetterRows) {
+    const char* p = std::strchr(row, base);
+    if (p == nullptr) {
+      continue;
+    }
+    const size_t index = static_cast<size_t>(p - row);
+    const size_t length = std::strlen(row);
+    size_t neighbour;
+    if (index == 0) {
+      neighbour = 1;
+    } else if (index + 1 == length) {
+      neighbour = index - 1;
+    } else {
+      neighbour = (r & 1) ? index + 1 : index - 1;
+    }
+    return upper ? static_cast<char>(row[neighbour] - 'a' + 'A') : row[neighbour];
+  }
+  return '\0';
+}
+
+std::chrono::nanoseconds Seconds(double seconds) {
+  return std::chrono::nanoseconds(static_cast<int64_t>(seconds * 1e9));
+}
+
+}  // namespace
+
+Xoshiro256::Xoshiro256(uint64_t seed) {
+  if (seed == 0) {
+    static std::atomic<uint64_t> counter{0};
+    seed = static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count()) ^
+           (counter.fetch_add(1, std::memory_order_relaxed) * 0xD1B54A32D192ED03ULL);
+  }
+  for (uint64_t& word : state) {
+    word = SplitMix64(seed);
+  }
+}
+
+uint64_t Xoshiro256::Next() {
+  const uint64_t result = Rotl(state[1] * 5, 7) * 9;
+  const uint64_t t = state[1] << 17;
+  state[2] ^= state[0];
+  state[3] ^= state[1];
+  state[1] ^= state[2];
+  state[0] ^= state[3];
+  state[2] ^= t;
+  state[3] = Rotl(state[3], 45);
+  return result;
+}
+
+double Xoshiro256::NextDouble() {
+  return static_cast<double>(Next() >> 11) * 0x1.0p-53;
+}
+
+double Xoshiro256::NextNormal() {
+  // Box-Muller，1 - u保证对数参数不为0
+  const double u = 1.0 - NextDouble();
+  const double v = NextDouble();
+  return std::sqrt(-2.0 * std::log(u)) * std::cos(6.283185307179586 * v);
+}
+
+TypingCadence::TypingCadence(const CadenceOptions& options) : options(options), random(options.seed) {
+  this->options.minDelay = std::max(0.0, options.minDelay);
+  this->options.maxDelay = std::max(this->options.minDelay, options.maxDelay);
+  this->options.errorRate = std::clamp(options.errorRate, 0.0, 1.0);
+}
+
+double TypingCadence::Interval(char beforePrevious, char previous, char current) {
+  const double low = options.minDelay;
+  const double high = options.maxDelay;
+  // 几何中点作为中位数，对数正态抖动让偶尔的长停顿比短停顿更常见
+  const double median = low > 0 ? std::sqrt(low * high) : high / 2;
+
+  double factor = 1.0;
+  const char base = BaseKey(current);
+  const char previousBase = BaseKey(previous);
+  const int finger = Finger(base);
+  const int previousFinger = Finger(previousBase);
+
+  if (NeedsShift(current)) {
+    factor *= 1.3;
+  }
+  if (!std::isalpha(static_cast<unsigned char>(base)) && finger >= 0) {
+    factor *= 1.2;
+  }
+  if (previous != '\0') {
+    if (base == previousBase) {
+      factor *= 0.75;
+    } else if (IsCommonBigram(previousBase, base)) {
+      factor *= 0.8;
+    } else if (finger >= 0 && previousFinger >= 0) {
+      if ((finger < 4) != (previousFinger < 4)) {
+        factor *= 0.85;
+      } else if (finger == previousFinger) {
+        factor *= 1.25;
+      }
+    }
+    if (previous == ' ' || previous == '\n' || previous == '\t') {
+      factor *= IsSentenceEnd(beforePrevious) ? 1.6 : 1.15;
+    }
+  }
+
+  const double interval = median * factor * std::exp(0.25 * random.NextNormal());
+  return std::clamp(interval, low, high);
+}
+
+std::chrono::nanoseconds TypingCadence::Hold(double interval) {
+  // 按住时长不超过到下一次按下间隔的60%，保证相邻按键不会重叠
+  const double hold = std::clamp(0.08 + 0.02 * random.NextNormal(), 0.03, 0.15);
+  return Seconds(std::min(hold, interval * 0.6));
+}
+
+std::vector<Keystroke> TypingCadence::Schedule(const std::string& text) {
+  std::vector<Keystroke> schedule;
+  schedule.reserve(text.size() + text.size() / 8);
+
+  double time = 0.0;
+  char beforePrevious = '\0';
+  char previous = '\0';
+  auto add = [&](char c, double interval) {
+    if (!schedule.empty()) {
+      time += interval;
+    }
+    schedule.push_back({c, Seconds(time), std::chrono::nanoseconds(0)});
+  };
+
+  for (char c : text) {
+    if (!Supported(c)) {
+      continue;
+    }
+    if (options.errorRate > 0 && std::isalpha(static_cast<unsigned char>(c)) &&
+        random.NextDouble() < options.errorRate) {
+      const char wrong = Neighbour(c, random.Next());
+      if (wrong != '\0') {
+        add(wrong, Interval(beforePrevious, previous, wrong));
+        // 发现打错后的停顿，再退格
+        add('\b', 0.15 + 0.2 * random.NextDouble());
+        add(c, Interval('\0', '\b', c) * 1.2);
+        beforePrevious = previous;
+        previous = c;
+        continue;
+      }
+    }
+    add(c, Interval(beforePrevious, previous, c));
+    beforePrevious = previous;
+    previous = c;
+  }
+
+  // 按住时长依赖于到下一次按下的间隔，最后一个键按上限计算
+  for (size_t i = 0; i < schedule.size(); i++) {
+    const double gap = i + 1 < schedule.size()
+                           ? std::chrono::duration<double>(schedule[i + 1].offset - schedule[i].offset).count()
+                           : options.maxDelay;
+    schedule[i].hold = Hold(gap);
+  }
+  return schedule;
+}
+
+}  // namespace Robot
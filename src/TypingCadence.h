@@ -0,0 +1,64 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Robot {
+
+// xoshiro256**：快速、可设定种子的伪随机数生成器，同一种子在各平台上产生相同序列
+class Xoshiro256 {
+ public:
+  // seed为0时从时钟与进程内计数器取种子
+  explicit Xoshiro256(uint64_t seed = 0);
+
+  uint64_t Next();
+
+  // [0, 1)
+  double NextDouble();
+
+  // 标准正态分布
+  double NextNormal();
+
+ private:
+  uint64_t state[4];
+};
+
+// 一次按键：在offset时刻按下character，按住hold后释放
+// character为'\b'表示退格（纠正打错的字符），'\n'为回车，'\t'为Tab，其余为可打印ASCII字符
+struct Keystroke {
+  char character;
+  std::chrono::nanoseconds offset;
+  std::chrono::nanoseconds hold;
+};
+
+struct CadenceOptions {
+  double minDelay = 0.05;  // 相邻按键间隔的下限（秒）
+  double maxDelay = 0.2;   // 相邻按键间隔的上限（秒）
+  double errorRate = 0.0;  // 每个字母先按错一个相邻键再退格纠正的概率
+  uint64_t seed = 0;       // 相同种子与文本产生相同的时间表；0表示每次不同
+};
+
+// 打字节奏模型
+// 一次性生成整段文本的按键时间表：按键间隔以[minDelay, maxDelay]的几何中点为中位数做对数正态抖动，
+// 再按前后两个字符（QWERTY布局）修正：左右手交替、常见双字母组合与重复字母更快，
+// 同一手指连续按不同键、需要Shift、数字与符号以及单词/句子边界更慢。结果截断到[minDelay, maxDelay]。
+// 执行方只需按offset精确等待（delayUntil）后发送事件，逐字符没有额外的随机数或字符串开销。
+class TypingCadence {
+ public:
+  explicit TypingCadence(const CadenceOptions& options = CadenceOptions());
+
+  // 不支持的字符（非ASCII、控制字符）被跳过
+  std::vector<Keystroke> Schedule(const std::string& text);
+
+ private:
+  // beforePrevious/previous为0表示不存在
+  double Interval(char beforePrevious, char previous, char current);
+  std::chrono::nanoseconds Hold(double interval);
+
+  CadenceOptions options;
+  Xoshiro256 random;
+};
+
+}  // namespace Robot
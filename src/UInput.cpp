@@ -0,0 +1,321 @@
+#include "./UInput.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+#ifdef __linux__
+#include <cerrno>
+#include <fcntl.h>
+#include <linux/uinput.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#endif
+
+namespace Robot {
+
+#ifdef __linux__
+
+namespace {
+
+constexpr uint16_t kLetterKeys[26] = {
+    KEY_A, KEY_B, KEY_C, KEY_D, KEY_E, KEY_F, KEY_G, KEY_H, KEY_I, KEY_J, KEY_K, KEY_L, KEY_M,
+    KEY_N, KEY_O, KEY_P, KEY_Q, KEY_R, KEY_S, KEY_T, KEY_U, KEY_V, KEY_W, KEY_X, KEY_Y, KEY_Z};
+
+// 数字键行上的符号：")!@#$%^&*("依次对应0-9
+constexpr char kShiftedDigits[] = ")!@#$%^&*(";
+
+std::string ErrorText(const std::string& what) {
+  return what + ": " + std::strerror(errno);
+}
+
+void Ioctl(int fd, unsigned long request, unsigned long value) {
+  if (ioctl(fd, request, value) < 0) {
+    throw std::runtime_error(ErrorText("uinput device setup failed"));
+  }
+}
+
+int CreateDevice(const std::string& name, bool pointer, int width, int height) {
+  const int fd = open("/dev/uinput", O_WRONLY | O_CLOEXEC);
+  if (fd < 0) {
+    throw std::runtime_error(ErrorText("Cannot open /dev/uinput"));
+  }
+  try {
+    Ioctl(fd, UI_SET_EVBIT, EV_KEY);
+    uinput_setup setup{};
+    setup.id.bustype = BUS_VIRTUAL;
+    setup.id.vendor = 0x1209;
+    setup.id.product = pointer ? 0x0002 : 0x0001;
+    const std::string deviceName = name + (pointer ? " pointer" : " keyboard");
+    std::strncpy(setup.name, deviceName.c_str(), UINPUT_MAX_NAME_SIZE - 1);
+
+    if (pointer) {
+      Ioctl(fd, UI_SET_KEYBIT, BTN_LEFT);
+      Ioctl(fd, UI_SET_KEYBIT, BTN_RIGHT);
+      Ioctl(fd, UI_SET_KEYBIT, BTN_MIDDLE);
+      Ioctl(fd, UI_SET_EVBIT, EV_REL);
+      Ioctl(fd, UI_SET_RELBIT, REL_WHEEL);
+      Ioctl(fd, UI_SET_RELBIT, REL_HWHEEL);
+      Ioctl(fd, UI_SET_EVBIT, EV_ABS);
+      Ioctl(fd, UI_SET_ABSBIT, ABS_X);
+      Ioctl(fd, UI_SET_ABSBIT, ABS_Y);
+      // 坐标范围与桌面像素一一对应，混成器/X服务器会把它映射到整个桌面
+      const std::pair<uint16_t, int> axes[] = {{ABS_X, width}, {ABS_Y, height}};
+      for (const auto& [code, size] : axes) {
+        uinput_abs_setup axis{};
+        axis.code = code;
+        axis.absinfo.minimum = 0;
+        axis.absinfo.maximum = std::max(1, size - 1);
+        if (ioctl(fd, UI_ABS_SETUP, &axis) < 0) {
+          throw std::runtime_error(ErrorText("uinput device setup failed"));
+        }
+      }
+    } else {
+      // 普通键盘键码范围，BTN_*从0x100开始
+      for (int code = 1; code < BTN_MISC; code++) {
+        Ioctl(fd, UI_SET_KEYBIT, code);
+      }
+    }
+
+    // UI_DEV_SETUP/UI_ABS_SETUP需要Linux 4.5及以上
+    if (ioctl(fd, UI_DEV_SETUP, &setup) < 0 || ioctl(fd, UI_DEV_CREATE) < 0) {
+      throw std::runtime_error(ErrorText("uinput device creation failed"));
+    }
+  } catch (...) {
+    close(fd);
+    throw;
+  }
+  return fd;
+}
+
+void DestroyDevice(int fd) {
+  if (fd >= 0) {
+    ioctl(fd, UI_DEV_DESTROY);
+    close(fd);
+  }
+}
+
+}  // namespace
+
+UInput::UInput(int width, int height, const std::string& name, int settleMs) {
+  keyboardFd = CreateDevice(name, false, width, height);
+  try {
+    pointerFd = CreateDevice(name, true, width, height);
+  } catch (...) {
+    DestroyDevice(keyboardFd);
+    throw;
+  }
+  keyboardGroup.reserve(sizeof(input_event) * 8);
+  pointerGroup.reserve(sizeof(input_event) * 8);
+  if (settleMs > 0) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(settleMs));
+  }
+}
+
+UInput::~UInput() {
+  DestroyDevice(keyboardFd);
+  DestroyDevice(pointerFd);
+}
+
+void UInput::Append(std::vector<uint8_t>& group, uint16_t type, uint16_t code, int32_t value) {
+  input_event event{};  // 时间戳由内核填写
+  event.type = type;
+  event.code = code;
+  event.value = value;
+  const auto* bytes = reinterpret_cast<const uint8_t*>(&event);
+  group.insert(group.end(), bytes, bytes + sizeof(event));
+}
+
+void UInput::Flush(int fd, std::vector<uint8_t>& group) {
+  if (group.empty()) {
+    return;
+  }
+  Append(group, EV_SYN, SYN_REPORT, 0);
+  ssize_t written;
+  do {
+    written = write(fd, group.data(), group.size());
+  } while (written < 0 && errno == EINTR);
+  group.clear();
+  if (written < 0) {
+    throw std::runtime_error(ErrorText("uinput write failed"));
+  }
+}
+
+void UInput::Key(uint16_t code, bool down) {
+  Append(code >= BTN_MISC ? pointerGroup : keyboardGroup, EV_KEY, code, down ? 1 : 0);
+}
+
+void UInput::Move(int x, int y) {
+  Append(pointerGroup, EV_ABS, ABS_X, x);
+  Append(pointerGroup, EV_ABS, ABS_Y, y);
+}
+
+void UInput::Wheel(int vertical, int horizontal) {
+  if (vertical != 0) {
+    Append(pointerGroup, EV_REL, REL_WHEEL, vertical);
+  }
+  if (horizontal != 0) {
+    Append(pointerGroup, EV_REL, REL_HWHEEL, horizontal);
+  }
+}
+
+void UInput::Sync() {
+  Flush(keyboardFd, keyboardGroup);
+  Flush(pointerFd, pointerGroup);
+}
+
+void UInput::KeyClick(uint16_t code) {
+  // 按下与释放放在不同的组中，避免接收方在同一帧内同时看到两者而忽略按键
+  Key(code, true);
+  Sync();
+  Key(code, false);
+  Sync();
+}
+
+void UInput::MoveTo(int x, int y) {
+  Move(x, y);
+  Sync();
+}
+
+void UInput::ButtonDown(MouseButton button) {
+  Key(ButtonCode(button), true);
+  Sync();
+}
+
+void UInput::ButtonUp(MouseButton button) {
+  Key(ButtonCode(button), false);
+  Sync();
+}
+
+void UInput::Click(MouseButton button, int clicks) {
+  for (int i = 0; i < clicks; i++) {
+    ButtonDown(button);
+    ButtonUp(button);
+  }
+}
+
+void UInput::Scroll(int vertical, int horizontal) {
+  Wheel(vertical, horizontal);
+  Sync();
+}
+
+void UInput::Type(const std::string& text) {
+  for (char c : text) {
+    bool shift = false;
+    const uint16_t code = AsciiToKeyCode(c, shift);
+    if (code == 0) {
+      continue;
+    }
+    if (shift) {
+      Key(KEY_LEFTSHIFT, true);
+    }
+    Key(code, true);
+    Sync();
+    Key(code, false);
+    if (shift) {
+      Key(KEY_LEFTSHIFT, false);
+    }
+    Sync();
+  }
+}
+
+uint16_t UInput::AsciiToKeyCode(char c, bool& shift) {
+  shift = false;
+  if (c >= 'a' && c <= 'z') {
+    return kLetterKeys[c - 'a'];
+  }
+  if (c >= 'A' && c <= 'Z') {
+    shift = true;
+    return kLetterKeys[c - 'A'];
+  }
+  if (c >= '1' && c <= '9') {
+    return static_cast<uint16_t>(KEY_1 + (c - '1'));
+  }
+  if (c == '0') {
+    return KEY_0;
+  }
+  if (const char* digit = std::strchr(kShiftedDigits, c); digit != nullptr && c != '\0') {
+    shift = true;
+    const int index = static_cast<int>(digit - kShiftedDigits);
+    return index == 0 ? KEY_0 : static_cast<uint16_t>(KEY_1 + index - 1);
+  }
+  switch (c) {
+    case ' ': return KEY_SPACE;
+    case '\n': return KEY_ENTER;
+    case '\t': return KEY_TAB;
+    case '-': return KEY_MINUS;
+    case '=': return KEY_EQUAL;
+    case '[': return KEY_LEFTBRACE;
+    case ']': return KEY_RIGHTBRACE;
+    case '\\': return KEY_BACKSLASH;
+    case ';': return KEY_SEMICOLON;
+    case '\'': return KEY_APOSTROPHE;
+    case '`': return KEY_GRAVE;
+    case ',': return KEY_COMMA;
+    case '.': return KEY_DOT;
+    case '/': return KEY_SLASH;
+    default: break;
+  }
+  shift = true;
+  switch (c) {
+    case '_': return KEY_MINUS;
+    case '+': return KEY_EQUAL;
+    case '{': return KEY_LEFTBRACE;
+    case '}': return KEY_RIGHTBRACE;
+    case '|': return KEY_BACKSLASH;
+    case ':': return KEY_SEMICOLON;
+    case '"': return KEY_APOSTROPHE;
+    case '~': return KEY_GRAVE;
+    case '<': return KEY_COMMA;
+    case '>': return KEY_DOT;
+    case '?': return KEY_SLASH;
+    default:
+      shift = false;
+      return 0;
+  }
+}
+
+uint16_t UInput::ButtonCode(MouseButton button) {
+  switch (button) {
+    case MouseButton::RIGHT_BUTTON:
+      return BTN_RIGHT;
+    case MouseButton::CENTER_BUTTON:
+      return BTN_MIDDLE;
+    default:
+      return BTN_LEFT;
+  }
+}
+
+#else
+
+UInput::UInput(int, int, const std::string&, int) {
+  throw std::runtime_error("uinput is only supported on Linux");
+}
+
+UInput::~UInput() = default;
+
+void UInput::Append(std::vector<uint8_t>&, uint16_t, uint16_t, int32_t) {}
+void UInput::Flush(int, std::vector<uint8_t>&) {}
+void UInput::Key(uint16_t, bool) {}
+void UInput::Move(int, int) {}
+void UInput::Wheel(int, int) {}
+void UInput::Sync() {}
+void UInput::KeyClick(uint16_t) {}
+void UInput::MoveTo(int, int) {}
+void UInput::ButtonDown(MouseButton) {}
+void UInput::ButtonUp(MouseButton) {}
+void UInput::Click(MouseButton, int) {}
+void UInput::Scroll(int, int) {}
+void UInput::Type(const std::string&) {}
+uint16_t UInput::AsciiToKeyCode(char, bool& shift) {
+  shift = false;
+  return 0;
+}
+uint16_t UInput::ButtonCode(MouseButton) { return 0; }
+
+#endif
+
+}  // namespace Robot
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "./Mouse.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Robot {
+
+// 通过/dev/uinput创建内核虚拟输入设备：一个键盘和一个绝对坐标指针（ABS_X/ABS_Y，类似虚拟机的tablet设备）
+// 事件直接进入内核输入子系统，由X服务器、Wayland混成器或控制台像真实设备一样读取，因此不依赖X11，注入路径上也没有X往返。
+// 事件先累积在当前组中，Sync()追加SYN_REPORT后每个设备一次write()写出；便捷方法各自成组并立即写出。
+//
+// 需要对/dev/uinput的写权限（通常为root，或通过udev规则授予input组）。
+// 新设备创建后需要一段时间才会被混成器/X服务器识别，此前写入的事件会丢失，构造函数会等待settleMs。
+// 键码为evdev码（KEY_*、BTN_*，见linux/input-event-codes.h）；X服务器的键码通常为evdev码加8。
+// 实例本身不是线程安全的。
+class UInput {
+ public:
+  // width/height为绝对坐标范围，通常为整个桌面的像素尺寸
+  UInput(int width, int height, const std::string& name = "autogui-cpp", int settleMs = 200);
+  ~UInput();
+
+  UInput(const UInput&) = delete;
+  UInput& operator=(const UInput&) = delete;
+
+  // 以下追加到当前组，调用Sync()后才会生效
+  void Key(uint16_t code, bool down);  // KEY_*写入键盘设备，BTN_*写入指针设备
+  void Move(int x, int y);
+  void Wheel(int vertical, int horizontal);  // 正值向上/向右
+  void Sync();
+
+  // 以下各自成组并立即写出
+  void KeyClick(uint16_t code);
+  void MoveTo(int x, int y);
+  void ButtonDown(MouseButton button);
+  void ButtonUp(MouseButton button);
+  void Click(MouseButton button, int clicks = 1);
+  void Scroll(int vertical, int horizontal = 0);
+
+  // 按美式键盘布局逐字符输入可打印ASCII字符，不支持的字符被跳过
+  void Type(const std::string& text);
+
+  // 美式布局下字符对应的evdev键码，无对应键时返回0
+  static uint16_t AsciiToKeyCode(char c, bool& shift);
+
+  static uint16_t ButtonCode(MouseButton button);
+
+ private:
+  // 组内容为连续存放的struct input_event，可直接交给write()
+  static void Append(std::vector<uint8_t>& group, uint16_t type, uint16_t code, int32_t value);
+  static void Flush(int fd, std::vector<uint8_t>& group);
+
+  int keyboardFd = -1;
+  int pointerFd = -1;
+  std::vector<uint8_t> keyboardGroup;
+  std::vector<uint8_t> pointerGroup;
+};
+
+}  // namespace Robot
@@ -6,4 +6,15 @@ void delay(unsigned int ms) {
   std::this_thread::sleep_for(std::chrono::milliseconds(ms));
 }
 
+void delayUntil(std::chrono::steady_clock::time_point deadline) {
+  constexpr auto kSpinWindow = std::chrono::milliseconds(1);
+  auto now = std::chrono::steady_clock::now();
+  if (deadline - now > kSpinWindow) {
+    std::this_thread::sleep_until(deadline - kSpinWindow);
+  }
+  while (std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::yield();
+  }
+}
+
 }  // namespace Robot
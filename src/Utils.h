@@ -9,6 +9,9 @@ namespace Robot {
 
 void delay(unsigned int ms);
 
+// 精确等待到指定时刻：先粗睡眠到截止前约1ms，再让出CPU自旋到截止时刻
+void delayUntil(std::chrono::steady_clock::time_point deadline);
+
 namespace KeyUtils {
 // 检查字符是否需要Shift键
 inline bool NeedsShift(char c) {
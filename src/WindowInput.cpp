@@ -0,0 +1,255 @@
+#include "./WindowInput.h"
+#include "./XErrorTrap.h"
+
+#include <cctype>
+#include <cstdlib>
+#include <stdexcept>
+
+#ifdef __linux__
+#include <X11/XKBlib.h>
+#include <X11/keysym.h>
+#endif
+
+namespace Robot {
+
+#ifdef __linux__
+
+namespace {
+
+// 目标窗口可能随时被关闭，XSendEvent随后产生的BadWindow会让Xlib默认的错误处理直接退出进程。
+// 每次发送后XSync代价太高，因此通过XErrorTrap::IgnoreDisplay忽略WindowInput连接上的全部错误，其他连接不受影响。
+void RegisterDisplay(Display* display) {
+  XErrorTrap::IgnoreDisplay(display);
+}
+
+void UnregisterDisplay(Display* display) {
+  XErrorTrap::UnignoreDisplay(display);
+}
+
+unsigned int ModifierMaskForKeysym(KeySym keysym) {
+  switch (keysym) {
+    case XK_Shift_L:
+    case XK_Shift_R:
+      return ShiftMask;
+    case XK_Control_L:
+    case XK_Control_R:
+      return ControlMask;
+    case XK_Alt_L:
+    case XK_Alt_R:
+      return Mod1Mask;
+    case XK_Super_L:
+    case XK_Super_R:
+      return Mod4Mask;
+    default:
+      return 0;
+  }
+}
+
+unsigned int ButtonCode(MouseButton button) {
+  switch (button) {
+    case MouseButton::RIGHT_BUTTON:
+      return 3;
+    case MouseButton::CENTER_BUTTON:
+      return 2;
+    default:
+      return 1;
+  }
+}
+
+}  // namespace
+
+WindowInput::WindowInput(unsigned long window) : target(window) {
+  display = XOpenDisplay(nullptr);
+  if (display == nullptr) {
+    throw std::runtime_error("Cannot open X11 display");
+  }
+  rootWindow = DefaultRootWindow(display);
+  RegisterDisplay(display);
+}
+
+WindowInput::~WindowInput() {
+  if (display != nullptr) {
+    XSync(display, False);
+    UnregisterDisplay(display);
+    XCloseDisplay(display);
+  }
+}
+
+void WindowInput::SendKey(bool press, KeyCode keysym, unsigned int extraState) {
+  const ::KeyCode keycode = XKeysymToKeycode(display, keysym);
+  if (keycode == 0) {
+    return;
+  }
+  XKeyEvent event{};
+  event.type = press ? KeyPress : KeyRelease;
+  event.display = display;
+  event.window = target;
+  event.root = rootWindow;
+  event.subwindow = None;
+  event.time = CurrentTime;
+  event.x = event.y = event.x_root = event.y_root = 1;
+  event.same_screen = True;
+  event.keycode = keycode;
+  // 与真实事件一致：state为事件发生前的修饰键状态
+  event.state = modifierState | buttonState | extraState;
+  XSendEvent(display, target, True, press ? KeyPressMask : KeyReleaseMask, reinterpret_cast<XEvent*>(&event));
+
+  const unsigned int mask = ModifierMaskForKeysym(keysym);
+  if (press) {
+    modifierState |= mask;
+  } else {
+    modifierState &= ~mask;
+  }
+}
+
+void WindowInput::KeyDown(KeyCode keysym) {
+  SendKey(true, keysym, 0);
+  XFlush(display);
+}
+
+void WindowInput::KeyUp(KeyCode keysym) {
+  SendKey(false, keysym, 0);
+  XFlush(display);
+}
+
+void WindowInput::KeyClick(KeyCode keysym) {
+  SendKey(true, keysym, 0);
+  SendKey(false, keysym, 0);
+  XFlush(display);
+}
+
+void WindowInput::KeyClick(Keyboard::SpecialKey specialKey) {
+  KeyClick(Keyboard::SpecialKeyToVirtualKey(specialKey));
+}
+
+void WindowInput::Type(const std::string& text) {
+  for (char c : text) {
+    const KeyCode keysym = Keyboard::AsciiToVirtualKey(c);
+    // AsciiToVirtualKey对字母返回小写keysym；其余字符按键位的第二级（Shift级）判断
+    bool shift = std::isupper(static_cast<unsigned char>(c)) != 0;
+    const ::KeyCode keycode = XKeysymToKeycode(display, keysym);
+    if (!shift && keycode != 0) {
+      shift = XkbKeycodeToKeysym(display, keycode, 0, 0) != keysym &&
+              XkbKeycodeToKeysym(display, keycode, 0, 1) == keysym;
+    }
+    const unsigned int extra = shift ? ShiftMask : 0;
+    SendKey(true, keysym, extra);
+    SendKey(false, keysym, extra);
+  }
+  XFlush(display);
+}
+
+::Window WindowInput::ResolveTarget(int x, int y, int& localX, int& localY, int& rootX, int& rootY) {
+  ::Window child = None;
+  XTranslateCoordinates(display, target, rootWindow, x, y, &rootX, &rootY, &child);
+
+  // 逐级下降到包含该点的最深子窗口
+  ::Window current = target;
+  localX = x;
+  localY = y;
+  while (true) {
+    int childX = 0;
+    int childY = 0;
+    if (!XTranslateCoordinates(display, target, current, x, y, &childX, &childY, &child)) {
+      break;
+    }
+    localX = childX;
+    localY = childY;
+    if (child == None) {
+      break;
+    }
+    current = child;
+  }
+  return current;
+}
+
+void WindowInput::SendButton(bool press, unsigned int buttonCode, int x, int y) {
+  XButtonEvent event{};
+  event.type = press ? ButtonPress : ButtonRelease;
+  event.display = display;
+  event.root = rootWindow;
+  event.window = ResolveTarget(x, y, event.x, event.y, event.x_root, event.y_root);
+  event.subwindow = None;
+  event.time = CurrentTime;
+  event.same_screen = True;
+  event.button = buttonCode;
+  event.state = modifierState | buttonState;
+  XSendEvent(display, event.window, True, press ? ButtonPressMask : ButtonReleaseMask,
+             reinterpret_cast<XEvent*>(&event));
+
+  // 滚轮按钮（4-7）不保持按下状态
+  if (buttonCode <= 3) {
+    const unsigned int mask = Button1Mask << (buttonCode - 1);
+    if (press) {
+      buttonState |= mask;
+    } else {
+      buttonState &= ~mask;
+    }
+  }
+}
+
+void WindowInput::MoveTo(int x, int y) {
+  XMotionEvent event{};
+  event.type = MotionNotify;
+  event.display = display;
+  event.root = rootWindow;
+  event.window = ResolveTarget(x, y, event.x, event.y, event.x_root, event.y_root);
+  event.subwindow = None;
+  event.time = CurrentTime;
+  event.same_screen = True;
+  event.is_hint = NotifyNormal;
+  event.state = modifierState | buttonState;
+  XSendEvent(display, event.window, True, PointerMotionMask | ButtonMotionMask, reinterpret_cast<XEvent*>(&event));
+  XFlush(display);
+}
+
+void WindowInput::ButtonDown(MouseButton button, int x, int y) {
+  SendButton(true, ButtonCode(button), x, y);
+  XFlush(display);
+}
+
+void WindowInput::ButtonUp(MouseButton button, int x, int y) {
+  SendButton(false, ButtonCode(button), x, y);
+  XFlush(display);
+}
+
+void WindowInput::Click(MouseButton button, int x, int y, int clicks) {
+  const unsigned int code = ButtonCode(button);
+  for (int i = 0; i < clicks; i++) {
+    SendButton(true, code, x, y);
+    SendButton(false, code, x, y);
+  }
+  XFlush(display);
+}
+
+void WindowInput::Scroll(int clicks, int x, int y) {
+  const unsigned int code = clicks > 0 ? 4 : 5;
+  for (int i = 0; i < std::abs(clicks); i++) {
+    SendButton(true, code, x, y);
+    SendButton(false, code, x, y);
+  }
+  XFlush(display);
+}
+
+#else
+
+WindowInput::WindowInput(unsigned long window) : target(window) {
+  throw std::runtime_error("WindowInput is only supported on Linux X11");
+}
+
+WindowInput::~WindowInput() = default;
+
+void WindowInput::KeyDown(KeyCode) {}
+void WindowInput::KeyUp(KeyCode) {}
+void WindowInput::KeyClick(KeyCode) {}
+void WindowInput::KeyClick(Keyboard::SpecialKey) {}
+void WindowInput::Type(const std::string&) {}
+void WindowInput::MoveTo(int, int) {}
+void WindowInput::ButtonDown(MouseButton, int, int) {}
+void WindowInput::ButtonUp(MouseButton, int, int) {}
+void WindowInput::Click(MouseButton, int, int, int) {}
+void WindowInput::Scroll(int, int, int) {}
+
+#endif
+
+}  // namespace Robot
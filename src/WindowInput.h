@@ -0,0 +1,68 @@
+#pragma once
+
+#include "./Keyboard.h"
+#include "./Mouse.h"
+#include "./types.h"
+
+#include <string>
+
+#ifdef __linux__
+#include <X11/Xlib.h>
+#endif
+
+namespace Robot {
+
+// 直接向指定窗口投递合成输入事件（XSendEvent），不经过XTest
+// 不移动共享光标，也不改变输入焦点，因此同一显示器上的多个窗口可以由多个线程（各自一个实例）并行驱动。
+//
+// 注意：XSendEvent产生的事件带有send_event标志，以下程序会忽略它们，此时应继续使用XTest（AutoGUI的普通函数）：
+//   - xterm（默认allowSendEvents: false）等出于安全考虑拒绝合成事件的程序；
+//   - 通过XInput2读取输入的toolkit（GTK3+、Qt5+在XI2可用时只处理XI2设备事件，不处理核心事件）；
+//   - 大多数游戏与基于原始输入的程序。
+// 适用于处理核心X事件的程序：Xt/Motif、Tk、Wine、Java AWT/Swing、SDL1等，以及无窗口管理器的测试环境。
+//
+// 坐标均相对于目标窗口客户区左上角；指针事件投递给该位置最深的子窗口。
+// 每个实例持有独立的X连接，实例本身不是线程安全的。
+class WindowInput {
+ public:
+  explicit WindowInput(unsigned long window);
+  ~WindowInput();
+
+  WindowInput(const WindowInput&) = delete;
+  WindowInput& operator=(const WindowInput&) = delete;
+
+  unsigned long Target() const { return target; }
+
+  void KeyDown(KeyCode keysym);
+  void KeyUp(KeyCode keysym);
+  void KeyClick(KeyCode keysym);
+  void KeyClick(Keyboard::SpecialKey specialKey);
+
+  // 逐字符发送按下/释放，大写字母与需要Shift的符号自动附加ShiftMask
+  void Type(const std::string& text);
+
+  void MoveTo(int x, int y);
+  void ButtonDown(MouseButton button, int x, int y);
+  void ButtonUp(MouseButton button, int x, int y);
+  void Click(MouseButton button, int x, int y, int clicks = 1);
+
+  // 正值向上滚动
+  void Scroll(int clicks, int x, int y);
+
+ private:
+#ifdef __linux__
+  void SendKey(bool press, KeyCode keysym, unsigned int extraState);
+  void SendButton(bool press, unsigned int buttonCode, int x, int y);
+
+  // 将窗口相对坐标解析为最深子窗口及其中的坐标，同时给出根窗口坐标
+  ::Window ResolveTarget(int x, int y, int& localX, int& localY, int& rootX, int& rootY);
+
+  Display* display = nullptr;
+  ::Window rootWindow = 0;
+  unsigned int modifierState = 0;  // 通过本实例按下的修饰键
+  unsigned int buttonState = 0;    // 通过本实例按下的鼠标按钮
+#endif
+  unsigned long target = 0;
+};
+
+}  // namespace Robot
@@ -0,0 +1,552 @@
+#include "./WindowRegistry.h"
+#include "./XErrorTrap.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#ifdef __linux__
+#include <X11/Xatom.h>
+#include <X11/Xutil.h>
+#endif
+
+namespace Robot {
+
+#ifdef __linux__
+
+namespace {
+
+// 读取整个属性，失败或不存在时返回false
+bool ReadProperty(Display* display, Window window, Atom property, Atom type, std::vector<unsigned char>& data,
+                  int& format, unsigned long& count) {
+  Atom actualType = None;
+  unsigned long remaining = 0;
+  unsigned char* value = nullptr;
+  if (XGetWindowProperty(display, window, property, 0, 1 << 20, False, type, &actualType, &format, &count,
+                         &remaining, &value) != Success) {
+    return false;
+  }
+  if (value == nullptr || actualType == None) {
+    if (value != nullptr) {
+      XFree(value);
+    }
+    return false;
+  }
+  // format为32时Xlib按long返回每一项
+  const size_t itemBytes = format == 32 ? sizeof(long) : static_cast<size_t>(format / 8);
+  data.assign(value, value + count * itemBytes);
+  XFree(value);
+  return true;
+}
+
+std::vector<Window> ReadWindowList(Display* display, Window window, Atom property, bool& present) {
+  std::vector<unsigned char> data;
+  int format = 0;
+  unsigned long count = 0;
+  std::vector<Window> windows;
+  present = ReadProperty(display, window, property, XA_WINDOW, data, format, count) && format == 32;
+  if (present) {
+    const long* items = reinterpret_cast<const long*>(data.data());
+    for (unsigned long i = 0; i < count; i++) {
+      windows.push_back(static_cast<Window>(items[i]));
+    }
+  }
+  return windows;
+}
+
+std::string ReadString(Display* display, Window window, Atom property, Atom type) {
+  std::vector<unsigned char> data;
+  int format = 0;
+  unsigned long count = 0;
+  if (!ReadProperty(display, window, property, type, data, format, count) || format != 8) {
+    return {};
+  }
+  return std::string(data.begin(), data.end());
+}
+
+}  // namespace
+
+WindowRegistry::WindowRegistry() {
+  display = XOpenDisplay(nullptr);
+  if (display == nullptr) {
+    throw std::runtime_error("Cannot open X11 display");
+  }
+  rootWindow = DefaultRootWindow(display);
+
+  const char* names[] = {"_NET_CLIENT_LIST", "_NET_CLIENT_LIST_STACKING", "_NET_ACTIVE_WINDOW",
+                         "_NET_WM_NAME",     "_NET_WM_PID",               "_NET_WM_STATE",
+                         "_NET_WM_STATE_HIDDEN", "UTF8_STRING"};
+  Atom values[8];
+  XInternAtoms(display, const_cast<char**>(names), 8, False, values);
+  netClientList = values[0];
+  netClientListStacking = values[1];
+  netActiveWindow = values[2];
+  netWmName = values[3];
+  netWmPid = values[4];
+  netWmState = values[5];
+  netWmStateHidden = values[6];
+  utf8String = values[7];
+
+  // 根窗口属性变化（客户列表、活动窗口）与顶层窗口（边框）的移动、创建、销毁
+  XSelectInput(display, rootWindow, PropertyChangeMask | SubstructureNotifyMask);
+  XSync(display, False);
+}
+
+WindowRegistry::~WindowRegistry() {
+  if (display != nullptr) {
+    XCloseDisplay(display);
+  }
+}
+
+void WindowRegistry::Rebuild() {
+  std::lock_guard<std::mutex> lock(mutex);
+  built = false;
+  SyncLocked();
+}
+
+void WindowRegistry::SyncLocked() {
+  if (!built) {
+    // 窗口随时可能被销毁，对已销毁窗口的请求会产生BadWindow，期间只在本连接上捕获错误
+    XErrorTrap trap(display);
+    for (const auto& item : entries) {
+      XSelectInput(display, item.first, NoEventMask);
+    }
+    entries.clear();
+    frames.clear();
+    // 丢弃重建前的事件
+    while (XPending(display) > 0) {
+      XEvent event;
+      XNextEvent(display, &event);
+    }
+    ResyncClients();
+    ReadStacking();
+    bool present = false;
+    const std::vector<Window> active = ReadWindowList(display, rootWindow, netActiveWindow, present);
+    activeWindow = active.empty() ? 0 : active.front();
+    built = true;
+    clientsDirty = stackingDirty = activeDirty = false;
+    return;
+  }
+
+  // 热路径：没有新事件也没有过期数据时不产生任何请求
+  bool stale = false;
+  for (const auto& item : entries) {
+    if (item.second.geometryStale) {
+      stale = true;
+      break;
+    }
+  }
+  if (XPending(display) == 0 && !stale) {
+    return;
+  }
+
+  XErrorTrap trap(display);
+  while (XPending(display) > 0) {
+    XEvent event;
+    XNextEvent(display, &event);
+    HandleEvent(event);
+  }
+  if (clientsDirty) {
+    ResyncClients();
+    clientsDirty = false;
+  }
+  if (stackingDirty) {
+    ReadStacking();
+    stackingDirty = false;
+  }
+  if (activeDirty) {
+    bool present = false;
+    const std::vector<Window> active = ReadWindowList(display, rootWindow, netActiveWindow, present);
+    activeWindow = active.empty() ? 0 : active.front();
+    activeDirty = false;
+  }
+  for (auto& item : entries) {
+    if (item.second.geometryStale) {
+      LoadGeometry(item.second);
+    }
+  }
+}
+
+void WindowRegistry::HandleEvent(const XEvent& event) {
+  switch (event.type) {
+    case PropertyNotify: {
+      const XPropertyEvent& property = event.xproperty;
+      if (property.window == rootWindow) {
+        if (property.atom == netClientList) {
+          clientsDirty = true;
+        } else if (property.atom == netClientListStacking) {
+          stackingDirty = true;
+        } else if (property.atom == netActiveWindow) {
+          activeDirty = true;
+        }
+        return;
+      }
+      auto it = entries.find(property.window);
+      if (it == entries.end()) {
+        return;
+      }
+      if (property.atom == netWmName || property.atom == XA_WM_NAME) {
+        LoadTitle(it->second);
+      } else if (property.atom == XA_WM_CLASS) {
+        LoadClass(it->second);
+      } else if (property.atom == netWmPid) {
+        LoadPid(it->second);
+      } else if (property.atom == netWmState) {
+        LoadState(it->second);
+      }
+      return;
+    }
+    case ConfigureNotify: {
+      const XConfigureEvent& configure = event.xconfigure;
+      // 根窗口子结构事件：边框窗口移动，客户区随之平移
+      auto frame = frames.find(configure.window);
+      if (configure.event == rootWindow && frame != frames.end()) {
+        auto it = entries.find(frame->second);
+        if (it != entries.end() && !it->second.geometryStale) {
+          Entry& entry = it->second;
+          entry.frameX = configure.x;
+          entry.frameY = configure.y;
+          Rect geometry = entry.info.geometry;
+          geometry.x = configure.x + entry.offsetX;
+          geometry.y = configure.y + entry.offsetY;
+          if (frame->second == configure.window) {
+            geometry.width = configure.width;
+            geometry.height = configure.height;
+          }
+          SetGeometry(entry, geometry);
+        }
+        return;
+      }
+      auto it = entries.find(configure.window);
+      if (configure.event != configure.window || it == entries.end()) {
+        return;
+      }
+      Entry& entry = it->second;
+      Rect geometry = entry.info.geometry;
+      geometry.width = configure.width;
+      geometry.height = configure.height;
+      if (configure.send_event) {
+        // ICCCM：窗口管理器发出的合成ConfigureNotify携带根窗口坐标
+        geometry.x = configure.x + configure.border_width;
+        geometry.y = configure.y + configure.border_width;
+        entry.offsetX = geometry.x - entry.frameX;
+        entry.offsetY = geometry.y - entry.frameY;
+      }
+      SetGeometry(entry, geometry);
+      if (!configure.send_event && entry.frame != configure.window) {
+        // 坐标相对于父窗口（边框内部），偏移量可能改变
+        entry.geometryStale = true;
+      }
+      return;
+    }
+    case MapNotify:
+    case UnmapNotify: {
+      const Window window = event.type == MapNotify ? event.xmap.window : event.xunmap.window;
+      auto it = entries.find(window);
+      if (it != entries.end()) {
+        it->second.mapped = event.type == MapNotify;
+        it->second.info.visible = it->second.mapped && !it->second.hidden;
+      }
+      if (!ewmh && event.xany.window == rootWindow) {
+        clientsDirty = true;
+      }
+      return;
+    }
+    case ReparentNotify: {
+      auto it = entries.find(event.xreparent.window);
+      if (it != entries.end()) {
+        it->second.geometryStale = true;
+      }
+      if (!ewmh) {
+        clientsDirty = true;
+      }
+      return;
+    }
+    case CreateNotify:
+      if (!ewmh) {
+        clientsDirty = true;
+      }
+      return;
+    case DestroyNotify:
+      if (entries.count(event.xdestroywindow.window) != 0) {
+        Untrack(event.xdestroywindow.window);
+        stackingDirty = true;
+      } else if (!ewmh) {
+        clientsDirty = true;
+      }
+      return;
+    default:
+      return;
+  }
+}
+
+void WindowRegistry::ResyncClients() {
+  std::vector<Window> clients = ReadWindowList(display, rootWindow, netClientList, ewmh);
+  if (!ewmh) {
+    // 没有EWMH窗口管理器（如裸Xvfb）：根窗口的直接子窗口即顶层窗口
+    Window rootReturn = 0;
+    Window parentReturn = 0;
+    Window* children = nullptr;
+    unsigned int count = 0;
+    if (XQueryTree(display, rootWindow, &rootReturn, &parentReturn, &children, &count) && children != nullptr) {
+      for (unsigned int i = 0; i < count; i++) {
+        XWindowAttributes attributes;
+        if (XGetWindowAttributes(display, children[i], &attributes) && !attributes.override_redirect &&
+            attributes.c_class == InputOutput) {
+          clients.push_back(children[i]);
+        }
+      }
+      XFree(children);
+    }
+  }
+
+  for (auto it = entries.begin(); it != entries.end();) {
+    if (std::find(clients.begin(), clients.end(), it->first) == clients.end()) {
+      const Window window = it->first;
+      ++it;
+      Untrack(window);
+    } else {
+      ++it;
+    }
+  }
+  for (Window window : clients) {
+    if (entries.count(window) == 0) {
+      Track(window);
+    }
+  }
+  if (!ewmh) {
+    // XQueryTree的子窗口顺序即堆叠顺序
+    stacking = clients;
+  }
+}
+
+void WindowRegistry::ReadStacking() {
+  if (!ewmh) {
+    if (built) {
+      ResyncClients();
+    }
+    return;
+  }
+  bool present = false;
+  stacking = ReadWindowList(display, rootWindow, netClientListStacking, present);
+  if (!present) {
+    stacking.clear();
+    for (const auto& item : entries) {
+      stacking.push_back(item.first);
+    }
+  }
+}
+
+void WindowRegistry::Track(Window window) {
+  XSelectInput(display, window, PropertyChangeMask | StructureNotifyMask);
+  Entry entry;
+  entry.info.id = window;
+  LoadTitle(entry);
+  LoadClass(entry);
+  LoadPid(entry);
+  LoadState(entry);
+  LoadGeometry(entry);
+  entries[window] = std::move(entry);
+}
+
+void WindowRegistry::Untrack(Window window) {
+  auto it = entries.find(window);
+  if (it == entries.end()) {
+    return;
+  }
+  auto frame = frames.find(it->second.frame);
+  if (frame != frames.end() && frame->second == window) {
+    frames.erase(frame);
+  }
+  entries.erase(it);
+  XSelectInput(display, window, NoEventMask);
+}
+
+void WindowRegistry::LoadTitle(Entry& entry) {
+  entry.info.title = ReadString(display, entry.info.id, netWmName, utf8String);
+  if (entry.info.title.empty()) {
+    entry.info.title = ReadString(display, entry.info.id, XA_WM_NAME, AnyPropertyType);
+  }
+}
+
+void WindowRegistry::LoadClass(Entry& entry) {
+  // WM_CLASS为两个以NUL结尾的字符串：instance、class
+  const std::string value = ReadString(display, entry.info.id, XA_WM_CLASS, XA_STRING);
+  const size_t split = value.find('\0');
+  entry.info.instance = value.substr(0, split);
+  entry.info.className.clear();
+  if (split != std::string::npos) {
+    const size_t end = value.find('\0', split + 1);
+    entry.info.className = value.substr(split + 1, end == std::string::npos ? end : end - split - 1);
+  }
+}
+
+void WindowRegistry::LoadPid(Entry& entry) {
+  std::vector<unsigned char> data;
+  int format = 0;
+  unsigned long count = 0;
+  entry.info.pid = 0;
+  if (ReadProperty(display, entry.info.id, netWmPid, XA_CARDINAL, data, format, count) && format == 32 &&
+      count > 0) {
+    entry.info.pid = static_cast<int>(*reinterpret_cast<const long*>(data.data()));
+  }
+}
+
+void WindowRegistry::LoadState(Entry& entry) {
+  std::vector<unsigned char> data;
+  int format = 0;
+  unsigned long count = 0;
+  entry.hidden = false;
+  const bool present = ReadProperty(display, entry.info.id, netWmState, XA_ATOM, data, format, count) && format == 32;
+  if (present) {
+    const long* atoms = reinterpret_cast<const long*>(data.data());
+    entry.hidden = std::find(atoms, atoms + count, static_cast<long>(netWmStateHidden)) != atoms + count;
+  }
+  entry.info.visible = entry.mapped && !entry.hidden;
+}
+
+void WindowRegistry::LoadGeometry(Entry& entry) {
+  const Window window = entry.info.id;
+  entry.geometryStale = false;
+
+  XWindowAttributes attributes;
+  if (!XGetWindowAttributes(display, window, &attributes)) {
+    return;
+  }
+  entry.mapped = attributes.map_state == IsViewable;
+  entry.info.visible = entry.mapped && !entry.hidden;
+
+  int rootX = 0;
+  int rootY = 0;
+  Window child = 0;
+  XTranslateCoordinates(display, window, rootWindow, 0, 0, &rootX, &rootY, &child);
+  SetGeometry(entry, {rootX, rootY, attributes.width, attributes.height});
+
+  // 向上找到根窗口的直接子窗口，其ConfigureNotify经根窗口的子结构事件到达
+  Window current = window;
+  while (true) {
+    Window rootReturn = 0;
+    Window parent = 0;
+    Window* children = nullptr;
+    unsigned int count = 0;
+    if (!XQueryTree(display, current, &rootReturn, &parent, &children, &count)) {
+      break;
+    }
+    if (children != nullptr) {
+      XFree(children);
+    }
+    if (parent == rootWindow || parent == 0) {
+      break;
+    }
+    current = parent;
+  }
+  if (entry.frame != 0 && entry.frame != current) {
+    frames.erase(entry.frame);
+  }
+  entry.frame = current;
+  frames[current] = window;
+
+  XWindowAttributes frameAttributes;
+  if (current != window && XGetWindowAttributes(display, current, &frameAttributes)) {
+    entry.frameX = frameAttributes.x;
+    entry.frameY = frameAttributes.y;
+  } else {
+    entry.frameX = attributes.x;
+    entry.frameY = attributes.y;
+  }
+  entry.offsetX = rootX - entry.frameX;
+  entry.offsetY = rootY - entry.frameY;
+}
+
+void WindowRegistry::SetGeometry(Entry& entry, const Rect& geometry) {
+  Rect& current = entry.info.geometry;
+  if (current.x != geometry.x || current.y != geometry.y || current.width != geometry.width ||
+      current.height != geometry.height) {
+    current = geometry;
+    entry.info.geometryVersion++;
+  }
+}
+
+const WindowRegistry::Entry* WindowRegistry::Find(Window window) {
+  auto it = entries.find(window);
+  return it == entries.end() ? nullptr : &it->second;
+}
+
+std::vector<WindowInfo> WindowRegistry::Windows() {
+  std::lock_guard<std::mutex> lock(mutex);
+  SyncLocked();
+  std::vector<WindowInfo> result;
+  result.reserve(entries.size());
+  for (Window window : stacking) {
+    if (const Entry* entry = Find(window)) {
+      result.push_back(entry->info);
+    }
+  }
+  return result;
+}
+
+std::vector<WindowInfo> WindowRegistry::FindByTitle(const std::string& title) {
+  std::lock_guard<std::mutex> lock(mutex);
+  SyncLocked();
+  std::vector<WindowInfo> result;
+  for (auto it = stacking.rbegin(); it != stacking.rend(); ++it) {
+    const Entry* entry = Find(*it);
+    if (entry != nullptr && entry->info.title.find(title) != std::string::npos) {
+      result.push_back(entry->info);
+    }
+  }
+  return result;
+}
+
+std::optional<WindowInfo> WindowRegistry::Get(unsigned long id) {
+  std::lock_guard<std::mutex> lock(mutex);
+  SyncLocked();
+  if (const Entry* entry = Find(static_cast<Window>(id))) {
+    return entry->info;
+  }
+  return std::nullopt;
+}
+
+std::optional<WindowInfo> WindowRegistry::Active() {
+  std::lock_guard<std::mutex> lock(mutex);
+  SyncLocked();
+  if (const Entry* entry = Find(activeWindow)) {
+    return entry->info;
+  }
+  return std::nullopt;
+}
+
+std::optional<WindowInfo> WindowRegistry::At(int x, int y) {
+  std::lock_guard<std::mutex> lock(mutex);
+  SyncLocked();
+  for (auto it = stacking.rbegin(); it != stacking.rend(); ++it) {
+    const Entry* entry = Find(*it);
+    if (entry != nullptr && entry->info.visible && entry->info.geometry.Contains({x, y})) {
+      return entry->info;
+    }
+  }
+  return std::nullopt;
+}
+
+#else
+
+WindowRegistry::WindowRegistry() {
+  throw std::runtime_error("WindowRegistry is only supported on Linux X11");
+}
+
+WindowRegistry::~WindowRegistry() = default;
+
+std::vector<WindowInfo> WindowRegistry::Windows() { return {}; }
+
+std::vector<WindowInfo> WindowRegistry::FindByTitle(const std::string&) { return {}; }
+
+std::optional<WindowInfo> WindowRegistry::Get(unsigned long) { return std::nullopt; }
+
+std::optional<WindowInfo> WindowRegistry::Active() { return std::nullopt; }
+
+std::optional<WindowInfo> WindowRegistry::At(int, int) { return std::nullopt; }
+
+void WindowRegistry::Rebuild() {}
+
+#endif
+
+}  // namespace Robot
@@ -0,0 +1,115 @@
+#pragma once
+
+#include "./types.h"
+
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#ifdef __linux__
+#include <X11/Xlib.h>
+#endif
+
+namespace Robot {
+
+// 顶层应用窗口的快照
+struct WindowInfo {
+  unsigned long id = 0;    // X11窗口ID（客户窗口，不是窗口管理器的边框窗口）
+  std::string title;       // _NET_WM_NAME（UTF-8），未设置时为WM_NAME
+  std::string className;   // WM_CLASS的class部分，如"Firefox"
+  std::string instance;    // WM_CLASS的instance部分，如"Navigator"
+  int pid = 0;             // _NET_WM_PID，未设置时为0
+  Rect geometry{0, 0, 0, 0};  // 客户区在根窗口中的位置与大小，不含窗口管理器边框
+  bool visible = false;    // 已映射且未最小化
+  uint64_t geometryVersion = 0;  // geometry每次变化时递增，用于检测窗口在一组操作期间是否被移动
+};
+
+// 窗口索引
+// 首次查询时读取一次_NET_CLIENT_LIST中所有窗口的标题、PID、类名与几何信息，之后订阅根窗口与各客户窗口的
+// PropertyNotify/ConfigureNotify/DestroyNotify等事件增量维护。每次查询只处理已到达的事件，
+// 没有变化时不产生任何X请求。窗口管理器不支持EWMH时退化为根窗口的直接子窗口。
+// 持有独立的X连接，所有方法都是线程安全的。
+class WindowRegistry {
+ public:
+  WindowRegistry();
+  ~WindowRegistry();
+
+  WindowRegistry(const WindowRegistry&) = delete;
+  WindowRegistry& operator=(const WindowRegistry&) = delete;
+
+  // 所有窗口，按堆叠顺序从下到上
+  std::vector<WindowInfo> Windows();
+
+  // 标题包含title（区分大小写）的窗口，按堆叠顺序从上到下
+  std::vector<WindowInfo> FindByTitle(const std::string& title);
+
+  std::optional<WindowInfo> Get(unsigned long id);
+
+  // _NET_ACTIVE_WINDOW指向的窗口
+  std::optional<WindowInfo> Active();
+
+  // 包含屏幕坐标(x, y)的最上层可见窗口
+  std::optional<WindowInfo> At(int x, int y);
+
+  // 丢弃索引并完整重建
+  void Rebuild();
+
+ private:
+#ifdef __linux__
+  struct Entry {
+    WindowInfo info;
+    Window frame = 0;  // 根窗口的直接子窗口（窗口管理器的边框窗口，未重新父化时为窗口本身）
+    int frameX = 0;    // frame左上角（含边框宽度）的根窗口坐标
+    int frameY = 0;
+    int offsetX = 0;   // 客户区左上角相对frame左上角的偏移
+    int offsetY = 0;
+    bool mapped = false;
+    bool hidden = false;  // _NET_WM_STATE_HIDDEN
+    bool geometryStale = true;
+  };
+
+  // 处理已到达的事件并补全过期数据，调用方需持有mutex
+  void SyncLocked();
+  void HandleEvent(const XEvent& event);
+  void ResyncClients();
+  void ReadStacking();
+  void Track(Window window);
+  void Untrack(Window window);
+  void LoadTitle(Entry& entry);
+  void LoadClass(Entry& entry);
+  void LoadPid(Entry& entry);
+  void LoadState(Entry& entry);
+  void LoadGeometry(Entry& entry);
+  static void SetGeometry(Entry& entry, const Rect& geometry);
+  const Entry* Find(Window window);
+
+  Display* display = nullptr;
+  Window rootWindow = 0;
+  bool built = false;
+  bool clientsDirty = false;
+  bool stackingDirty = false;
+  bool activeDirty = false;
+  bool ewmh = false;  // 窗口管理器提供_NET_CLIENT_LIST
+  Window activeWindow = 0;
+
+  std::unordered_map<Window, Entry> entries;
+  std::unordered_map<Window, Window> frames;  // frame -> 客户窗口
+  std::vector<Window> stacking;               // 从下到上
+
+  Atom netClientList = 0;
+  Atom netClientListStacking = 0;
+  Atom netActiveWindow = 0;
+  Atom netWmName = 0;
+  Atom netWmPid = 0;
+  Atom netWmState = 0;
+  Atom netWmStateHidden = 0;
+  Atom utf8String = 0;
+#endif
+
+  std::mutex mutex;
+};
+
+}  // namespace Robot
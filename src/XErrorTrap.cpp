@@ -0,0 +1,97 @@
+#include "./XErrorTrap.h"
+
+#ifdef __linux__
+
+#include <map>
+#include <mutex>
+
+namespace Robot {
+
+namespace {
+
+struct TrapState {
+  int depth = 0;          // 活动的XErrorTrap数
+  int ignored = 0;        // IgnoreDisplay次数
+  int errorCode = Success;
+};
+
+std::mutex trapMutex;
+std::map<Display*, TrapState> displays;
+std::once_flag installOnce;
+XErrorHandler previousHandler = nullptr;
+
+// 在发出请求的线程上、持有该连接的Xlib锁时调用；这里不发出任何X请求，不会与trapMutex形成死锁
+int DispatchError(Display* display, XErrorEvent* error) {
+  {
+    std::lock_guard<std::mutex> lock(trapMutex);
+    auto it = displays.find(display);
+    if (it != displays.end()) {
+      TrapState& state = it->second;
+      if (state.depth > 0) {
+        if (state.errorCode == Success) {
+          state.errorCode = error->error_code;
+        }
+        return 0;
+      }
+      if (state.ignored > 0) {
+        return 0;
+      }
+    }
+  }
+  return previousHandler != nullptr ? previousHandler(display, error) : 0;
+}
+
+void Install() {
+  std::call_once(installOnce, [] { previousHandler = XSetErrorHandler(DispatchError); });
+}
+
+// 计数归零的连接从表中移除，避免已关闭连接的地址被复用时沿用旧状态
+void Release(Display* display) {
+  auto it = displays.find(display);
+  if (it != displays.end() && it->second.depth == 0 && it->second.ignored == 0) {
+    displays.erase(it);
+  }
+}
+
+}  // namespace
+
+XErrorTrap::XErrorTrap(Display* display) : display(display) {
+  Install();
+  std::lock_guard<std::mutex> lock(trapMutex);
+  TrapState& state = displays[display];
+  if (state.depth++ == 0) {
+    state.errorCode = Success;
+  }
+}
+
+XErrorTrap::~XErrorTrap() {
+  XSync(display, False);
+  std::lock_guard<std::mutex> lock(trapMutex);
+  displays[display].depth--;
+  Release(display);
+}
+
+int XErrorTrap::Sync() {
+  XSync(display, False);
+  std::lock_guard<std::mutex> lock(trapMutex);
+  return displays[display].errorCode;
+}
+
+void XErrorTrap::IgnoreDisplay(Display* display) {
+  Install();
+  std::lock_guard<std::mutex> lock(trapMutex);
+  displays[display].ignored++;
+}
+
+void XErrorTrap::UnignoreDisplay(Display* display) {
+  std::lock_guard<std::mutex> lock(trapMutex);
+  auto it = displays.find(display);
+  if (it != displays.end() && it->second.ignored > 0) {
+    it->second.ignored--;
+    Release(display);
+  }
+}
+
+}  // namespace Robot
+
+#endif
@@ -0,0 +1,38 @@
+#pragma once
+
+#ifdef __linux__
+
+#include <X11/Xlib.h>
+
+namespace Robot {
+
+// 进程内共用的Xlib错误处理
+// Xlib的错误处理函数是进程全局的，各模块各自用XSetErrorHandler临时替换会相互覆盖：
+// 一个模块恢复的旧处理函数可能正是另一个模块刚刚替换掉的，其他线程连接上的错误也会在替换期间被吞掉。
+// 因此只在第一次使用时安装一个处理函数（链接到原处理函数）且不再替换，错误按所属连接分发：
+// 有活动XErrorTrap的连接记录错误并忽略，通过IgnoreDisplay登记的连接直接忽略，其余连接交给原处理函数。
+//
+// 用法：构造XErrorTrap后发出可能失败的请求，Sync()同步并取得第一个错误码；析构时同步以收取剩余的异步错误。
+// 同一连接上的XErrorTrap可以嵌套，错误记录在连接上，对所有活动的XErrorTrap可见。
+class XErrorTrap {
+ public:
+  explicit XErrorTrap(Display* display);
+  ~XErrorTrap();
+
+  XErrorTrap(const XErrorTrap&) = delete;
+  XErrorTrap& operator=(const XErrorTrap&) = delete;
+
+  // XSync后返回该连接上收到的第一个错误码（如BadAccess），没有错误时返回Success
+  int Sync();
+
+  // 永久忽略某连接上的全部错误（计数，Unignore次数与Ignore相同后恢复）
+  static void IgnoreDisplay(Display* display);
+  static void UnignoreDisplay(Display* display);
+
+ private:
+  Display* display;
+};
+
+}  // namespace Robot
+
+#endif
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cmath>
+#include <cstdint>
 
 namespace Robot {
 
@@ -13,4 +14,41 @@ struct Point {
   }
 };
 
+// RGB颜色
+struct Color {
+  uint8_t r;
+  uint8_t g;
+  uint8_t b;
+
+  bool operator==(const Color& other) const {
+    return r == other.r && g == other.g && b == other.b;
+  }
+  bool operator!=(const Color& other) const { return !(*this == other); }
+};
+
+// 虚拟桌面上的矩形区域
+struct Rect {
+  int x;
+  int y;
+  int width;
+  int height;
+
+  [[nodiscard]] bool Contains(Point point) const {
+    return point.x >= x && point.x < x + width && point.y >= y && point.y < y + height;
+  }
+
+  [[nodiscard]] bool Empty() const { return width <= 0 || height <= 0; }
+
+  // 两个矩形的交集，不相交时宽或高为0
+  [[nodiscard]] Rect Intersect(const Rect& other) const {
+    const int x1 = x > other.x ? x : other.x;
+    const int y1 = y > other.y ? y : other.y;
+    const int x2 = (x + width) < (other.x + other.width) ? (x + width) : (other.x + other.width);
+    const int y2 = (y + height) < (other.y + other.height) ? (y + height) : (other.y + other.height);
+    return {x1, y1, x2 > x1 ? x2 - x1 : 0, y2 > y1 ? y2 - y1 : 0};
+  }
+
+  [[nodiscard]] bool Intersects(const Rect& other) const { return !Intersect(other).Empty(); }
+};
+
 }  // namespace Robot